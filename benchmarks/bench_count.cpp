@@ -0,0 +1,63 @@
+#include "inputs.h"
+#include "text_counter.h"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Núcleos de contagem por tamanho de entrada e mistura de caracteres. O
+// bytes_per_second de cada caso deve ser comparado ao BM_ReadBandwidth do
+// mesmo tamanho: é o teto de leitura da memória (ou do cache) da máquina.
+
+static const std::vector<int64_t> SIZES = {
+    1 << 10, 16 << 10, 256 << 10, 1 << 20, 16 << 20, 64 << 20
+};
+
+static void count_args(benchmark::internal::Benchmark* bench) {
+    for (int mix = 0; mix <= static_cast<int>(TextMix::RANDOM); mix++) {
+        for (int64_t size : SIZES) {
+            bench->Args({size, mix});
+        }
+    }
+    bench->ArgNames({"bytes", "mix"});
+}
+
+template <long long (*Kernel)(const char*, size_t)>
+static void BM_Count(benchmark::State& state) {
+    size_t size = static_cast<size_t>(state.range(0));
+    TextMix mix = static_cast<TextMix>(state.range(1));
+    std::string text = make_text(size, mix);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Kernel(text.data(), text.size()));
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(size));
+    state.SetLabel(std::string(mix_name(mix)) + "/" + size_label(size));
+}
+
+BENCHMARK_TEMPLATE(BM_Count, count_letters_in)->Name("BM_CountLetters")->Apply(count_args);
+BENCHMARK_TEMPLATE(BM_Count, count_digits_in)->Name("BM_CountDigits")->Apply(count_args);
+
+// Referência: soma de palavras de 64 bits, limitada pela leitura
+static void BM_ReadBandwidth(benchmark::State& state) {
+    size_t size = static_cast<size_t>(state.range(0));
+    std::string text = make_text(size, TextMix::RANDOM);
+    size_t words = size / sizeof(uint64_t);
+
+    for (auto _ : state) {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < words; i++) {
+            uint64_t word;
+            std::memcpy(&word, text.data() + i * sizeof(uint64_t), sizeof(word));
+            sum += word;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(size));
+    state.SetLabel(size_label(size));
+}
+
+BENCHMARK(BM_ReadBandwidth)->ArgName("bytes")->Arg(1 << 10)->Arg(16 << 10)->Arg(256 << 10)
+    ->Arg(1 << 20)->Arg(16 << 20)->Arg(64 << 20);
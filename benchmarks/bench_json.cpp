@@ -0,0 +1,49 @@
+#include "inputs.h"
+#include <benchmark/benchmark.h>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+// Codificação e decodificação do corpo {"text": "..."} como o mestre e os
+// escravos fazem a cada requisição. Os maiores casos alocam várias vezes o
+// tamanho do texto; filtre com --benchmark_filter em máquinas pequenas.
+
+static void json_sizes(benchmark::internal::Benchmark* bench) {
+    bench->ArgName("bytes");
+    for (int64_t size : {int64_t(1) << 10, int64_t(64) << 10, int64_t(1) << 20, int64_t(16) << 20,
+                         int64_t(128) << 20, int64_t(500) << 20}) {
+        bench->Arg(size);
+    }
+    bench->Unit(benchmark::kMillisecond);
+}
+
+static void BM_JsonEncode(benchmark::State& state) {
+    size_t size = static_cast<size_t>(state.range(0));
+    std::string text = make_text(size, TextMix::UTF8);
+
+    for (auto _ : state) {
+        json body;
+        body["text"] = text;
+        std::string encoded = body.dump();
+        benchmark::DoNotOptimize(encoded.data());
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(size));
+    state.SetLabel(size_label(size));
+}
+BENCHMARK(BM_JsonEncode)->Apply(json_sizes);
+
+static void BM_JsonDecode(benchmark::State& state) {
+    size_t size = static_cast<size_t>(state.range(0));
+    std::string body = make_request_body(size);
+
+    for (auto _ : state) {
+        json request_json = json::parse(body);
+        std::string text = request_json["text"];
+        benchmark::DoNotOptimize(text.data());
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(body.size()));
+    state.SetLabel(size_label(size));
+}
+BENCHMARK(BM_JsonDecode)->Apply(json_sizes);
@@ -0,0 +1,42 @@
+#include "logger.h"
+#include <benchmark/benchmark.h>
+
+// Vazão do Logger do lado de quem registra, com 1 a 8 threads disputando.
+// O escritor assíncrono grava em /dev/null (ver bench_main.cpp).
+
+static void BM_LoggerInfo(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        Logger::set_log_level(LogLevel::INFO);
+        Logger::set_overflow_policy(LogOverflowPolicy::BLOCK);
+    }
+
+    long long request = 0;
+    for (auto _ : state) {
+        Logger::info_f("Requisição %lld processada: %d letras, %d números", request++, 1234, 56);
+    }
+
+    if (state.thread_index() == 0) {
+        Logger::flush();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LoggerInfo)->ThreadRange(1, 8)->UseRealTime();
+
+// Mensagem abaixo do nível atual: deve custar só a verificação do nível
+static void BM_LoggerFiltered(benchmark::State& state) {
+    Logger::set_log_level(LogLevel::WARNING);
+    for (auto _ : state) {
+        Logger::info_f("Requisição %d descartada pelo nível", 42);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LoggerFiltered)->ThreadRange(1, 8)->UseRealTime();
+
+static void BM_LoggerRateLimited(benchmark::State& state) {
+    Logger::set_log_level(LogLevel::INFO);
+    for (auto _ : state) {
+        LOG_RATE_LIMITED(LogLevel::WARNING, 1, "Escravo %s indisponível", "letters");
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LoggerRateLimited)->ThreadRange(1, 8)->UseRealTime();
@@ -0,0 +1,26 @@
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <iostream>
+
+// O Logger escreve em stdout; o relatório de console vai para stderr e o
+// stdout do processo é descartado, para as linhas de log não se misturarem
+// aos resultados. Para comparar execuções, use o relatório JSON:
+//   ./benchmarks --benchmark_out=resultados.json --benchmark_out_format=json
+int main(int argc, char** argv) {
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+
+    std::cout.flush();
+    if (!std::freopen("/dev/null", "w", stdout)) {
+        std::fprintf(stderr, "Não foi possível redirecionar stdout\n");
+    }
+
+    benchmark::ConsoleReporter console;
+    console.SetOutputStream(&std::cerr);
+    console.SetErrorStream(&std::cerr);
+    benchmark::RunSpecifiedBenchmarks(&console);
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,30 @@
+#include "result_merge.h"
+#include <benchmark/benchmark.h>
+
+// Combinação das respostas dos escravos no resultado de /process
+
+static void BM_MergeResults(benchmark::State& state) {
+    const std::string letters =
+        R"({"count":1843211,"processed_characters":4194304,"processing_time_ms":3,"service":"letters","success":true})";
+    const std::string numbers =
+        R"({"count":52117,"processed_characters":4194304,"processing_time_ms":2,"service":"numbers","success":true})";
+
+    for (auto _ : state) {
+        std::string result = merge_results(letters, numbers, 4194304).dump();
+        benchmark::DoNotOptimize(result.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MergeResults);
+
+static void BM_MergeResultsError(benchmark::State& state) {
+    const std::string letters = R"({"success":true,"count":10})";
+    const std::string numbers = R"({"success":false,"error":"Nenhum escravo disponível","count":0})";
+
+    for (auto _ : state) {
+        std::string result = merge_results(letters, numbers, 100).dump();
+        benchmark::DoNotOptimize(result.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MergeResultsError);
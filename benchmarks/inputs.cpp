@@ -0,0 +1,98 @@
+#include "inputs.h"
+#include <nlohmann/json.hpp>
+#include <random>
+
+const char* mix_name(TextMix mix) {
+    switch (mix) {
+        case TextMix::LETTERS: return "letters";
+        case TextMix::DIGITS: return "digits";
+        case TextMix::PROSE: return "prose";
+        case TextMix::UTF8: return "utf8";
+        case TextMix::RANDOM: return "random";
+    }
+    return "?";
+}
+
+std::string make_text(size_t size, TextMix mix) {
+    static const char* words[] = {
+        "o", "sistema", "mestre", "escravo", "distribui", "texto", "entre", "servidores",
+        "contagem", "de", "letras", "e", "números", "em", "paralelo", "ação", "2024", "42",
+        "requisição", "resposta", "\"citação\"", "linha\n"
+    };
+    constexpr size_t WORD_COUNT = sizeof(words) / sizeof(words[0]);
+
+    std::mt19937_64 engine(static_cast<uint64_t>(size) * 31 + static_cast<uint64_t>(mix));
+    std::string text;
+    text.reserve(size + 32);
+
+    switch (mix) {
+        case TextMix::LETTERS: {
+            std::uniform_int_distribution<int> letter(0, 51);
+            while (text.size() < size) {
+                int c = letter(engine);
+                text += static_cast<char>(c < 26 ? 'a' + c : 'A' + c - 26);
+            }
+            break;
+        }
+        case TextMix::DIGITS: {
+            std::uniform_int_distribution<int> digit(0, 9);
+            while (text.size() < size) {
+                text += static_cast<char>('0' + digit(engine));
+            }
+            break;
+        }
+        case TextMix::PROSE:
+        case TextMix::UTF8: {
+            std::uniform_int_distribution<size_t> word(0, WORD_COUNT - 1);
+            while (text.size() < size) {
+                const char* w = words[word(engine)];
+                // Sem acentos, as palavras com bytes >= 0x80 são trocadas
+                if (mix == TextMix::PROSE) {
+                    std::string ascii;
+                    for (const char* p = w; *p; p++) {
+                        if (static_cast<unsigned char>(*p) < 0x80) {
+                            ascii += *p;
+                        }
+                    }
+                    text += ascii;
+                } else {
+                    text += w;
+                }
+                text += ' ';
+            }
+            break;
+        }
+        case TextMix::RANDOM: {
+            std::uniform_int_distribution<int> byte(0, 255);
+            while (text.size() < size) {
+                text += static_cast<char>(byte(engine));
+            }
+            break;
+        }
+    }
+
+    text.resize(size);
+
+    // O corte não pode deixar um caractere de 2 bytes pela metade (o JSON
+    // exige UTF-8 válido)
+    if (mix == TextMix::UTF8 && !text.empty() && static_cast<unsigned char>(text.back()) >= 0xC0) {
+        text.back() = ' ';
+    }
+    return text;
+}
+
+std::string make_request_body(size_t text_size) {
+    nlohmann::json body;
+    body["text"] = make_text(text_size, TextMix::UTF8);
+    return body.dump();
+}
+
+std::string size_label(size_t size) {
+    if (size >= (1u << 20) && size % (1u << 20) == 0) {
+        return std::to_string(size >> 20) + "MB";
+    }
+    if (size >= 1024 && size % 1024 == 0) {
+        return std::to_string(size >> 10) + "KB";
+    }
+    return std::to_string(size) + "B";
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Geradores determinísticos de texto para os benchmarks
+enum class TextMix {
+    LETTERS,   // só a-z/A-Z
+    DIGITS,    // só 0-9
+    PROSE,     // texto em português: letras, espaços, pontuação, alguns dígitos
+    UTF8,      // prosa com acentos (bytes >= 0x80, que não contam)
+    RANDOM     // bytes uniformes
+};
+
+const char* mix_name(TextMix mix);
+
+std::string make_text(size_t size, TextMix mix);
+
+// Corpo de /process e das chamadas aos escravos: {"text": "..."}
+std::string make_request_body(size_t text_size);
+
+// Rótulo legível para tamanhos (1KB, 16MB...)
+std::string size_label(size_t size);
@@ -1,4 +1,4 @@
-QT += core widgets network
+QT += core widgets network concurrent
 
 TARGET = client
 TEMPLATE = app
@@ -27,18 +27,26 @@ exists(/usr/include/nlohmann/json.hpp) {
     DEFINES += HAVE_NLOHMANN_JSON
 }
 
+# zlib (opcional): blocos de /upload comprimidos com gzip
+exists(/usr/include/zlib.h) {
+    DEFINES += HAVE_ZLIB
+    LIBS += -lz
+}
+
 # Arquivos fonte
 SOURCES += \
     src/main.cpp \
     src/mainwindow.cpp \
     src/httpclient.cpp \
-    src/fileprocessor.cpp
+    src/fileprocessor.cpp \
+    src/chunkedupload.cpp
 
 # Arquivos cabeçalho
 HEADERS += \
     src/mainwindow.h \
     src/httpclient.h \
-    src/fileprocessor.h
+    src/fileprocessor.h \
+    src/chunkedupload.h
 
 # Arquivos de interface (se houver)
 FORMS += \
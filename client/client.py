@@ -41,7 +41,7 @@ class ProcessingWorker(QThread):
             response = requests.post(
                 self.url,
                 json=self.data,
-                headers={'Content-Type': 'application/json'},
+                headers={'Content-Type': 'application/json', 'X-Priority': 'interactive'},
                 timeout=30
             )
 
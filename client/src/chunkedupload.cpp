@@ -0,0 +1,426 @@
+#include "chunkedupload.h"
+#include "fileprocessor.h"
+#include <QBuffer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QTimer>
+#include <QDebug>
+#include <QtConcurrent/QtConcurrentRun>
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+// Tentativas por bloco antes de desistir do upload inteiro, com espera
+// crescente entre elas para atravessar quedas curtas de conexão
+static const int MAX_CHUNK_ATTEMPTS = 5;
+static const int RETRY_DELAY_MS = 1000;
+
+// Bloco que não encolhe pelo menos 10% vai sem compressão
+static const qint64 MIN_GAIN_PERCENT = 10;
+
+ChunkedUpload::ChunkedUpload(QNetworkAccessManager* manager, RequestFactory makeRequest,
+                             const QString& filepath, int connections, qint64 chunkSize,
+                             QObject *parent)
+    : QObject(parent)
+    , manager(manager)
+    , makeRequest(std::move(makeRequest))
+    , file(filepath)
+    , data(nullptr)
+    , size(0)
+    , chunkSize(chunkSize)
+    , chunkCount(0)
+    , connections(qMax(1, connections))
+    , compress(false)
+    , controlReply(nullptr)
+    , chunksDone(0)
+    , bytesDone(0)
+    , lastProgress(-1)
+    , stopped(false)
+{
+}
+
+ChunkedUpload::~ChunkedUpload()
+{
+    // Os blocos em voo e os em preparo leem do mapeamento: cancelar e
+    // esperar antes de desmapear
+    abort();
+    for (QFutureWatcher<PreparedChunk>* watcher : preparing) {
+        watcher->waitForFinished();
+    }
+}
+
+QByteArray ChunkedUpload::chunkHash(const char* data, qint64 length)
+{
+    quint64 hash = 0xcbf29ce484222325ull;
+    for (qint64 i = 0; i < length; i++) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 0x100000001b3ull;
+    }
+    return QByteArray::number(hash, 16);
+}
+
+void ChunkedUpload::setCompression(bool enabled)
+{
+#ifdef HAVE_ZLIB
+    compress = enabled;
+#else
+    Q_UNUSED(enabled);
+#endif
+}
+
+QByteArray ChunkedUpload::gzipChunk(const char* data, qint64 length)
+{
+#ifdef HAVE_ZLIB
+    // Nível 1: o bloco precisa sair mais rápido do que a rede o levaria
+    z_stream stream{};
+    if (deflateInit2(&stream, 1, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return QByteArray();
+    }
+
+    QByteArray output(static_cast<int>(deflateBound(&stream, static_cast<uLong>(length))), Qt::Uninitialized);
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    stream.avail_in = static_cast<uInt>(length);
+    stream.next_out = reinterpret_cast<Bytef*>(output.data());
+    stream.avail_out = static_cast<uInt>(output.size());
+    int result = deflate(&stream, Z_FINISH);
+    output.resize(static_cast<int>(stream.total_out));
+    deflateEnd(&stream);
+
+    return result == Z_STREAM_END ? output : QByteArray();
+#else
+    Q_UNUSED(data);
+    Q_UNUSED(length);
+    return QByteArray();
+#endif
+}
+
+void ChunkedUpload::start(const QString& resumeId)
+{
+    if (!file.open(QIODevice::ReadOnly)) {
+        throw FileProcessingException(QString("Não foi possível abrir o arquivo: %1").arg(file.fileName()));
+    }
+
+    size = file.size();
+    data = size > 0 ? file.map(0, size) : nullptr;
+    if (!data) {
+        throw FileProcessingException(QString("Não foi possível mapear o arquivo: %1").arg(file.fileName()));
+    }
+
+    if (resumeId.isEmpty()) {
+        createSession();
+        return;
+    }
+
+    QNetworkRequest request = makeRequest(QString("/upload/%1").arg(resumeId));
+    controlReply = manager->get(request);
+    connect(controlReply, &QNetworkReply::finished, this, &ChunkedUpload::onResumeStatus);
+}
+
+void ChunkedUpload::createSession()
+{
+    QJsonObject session;
+    session["size"] = size;
+    session["chunk_size"] = chunkSize;
+
+    QNetworkRequest request = makeRequest("/upload");
+    controlReply = manager->post(request, QJsonDocument(session).toJson(QJsonDocument::Compact));
+    connect(controlReply, &QNetworkReply::finished, this, &ChunkedUpload::onSessionCreated);
+}
+
+void ChunkedUpload::onResumeStatus()
+{
+    QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
+    reply->deleteLater();
+    if (stopped || reply != controlReply) {
+        return;
+    }
+    controlReply = nullptr;
+
+    // Sessão expirada, de outro arquivo ou mestre sem o estado: começar de novo
+    QJsonObject obj = QJsonDocument::fromJson(reply->readAll()).object();
+    if (reply->error() != QNetworkReply::NoError || !obj.value("success").toBool(false) ||
+        static_cast<qint64>(obj.value("size").toDouble()) != size) {
+        qDebug() << "Upload anterior não pode ser retomado, criando outro";
+        createSession();
+        return;
+    }
+
+    uploadId = obj.value("upload_id").toString();
+    chunkSize = static_cast<qint64>(obj.value("chunk_size").toDouble());
+    chunkCount = obj.value("chunks").toInt();
+
+    bytesDone = size;
+    const QJsonArray missing = obj.value("missing").toArray();
+    for (const QJsonValue& value : missing) {
+        int index = value.toInt();
+        pendingChunks.append(index);
+        bytesDone -= qMin(chunkSize, size - index * chunkSize);
+    }
+    chunksDone = chunkCount - pendingChunks.size();
+
+    qDebug() << "Retomando upload" << uploadId << ":" << pendingChunks.size() << "de" << chunkCount << "blocos";
+    emit sessionStarted(uploadId);
+    emitProgress();
+
+    if (pendingChunks.isEmpty()) {
+        finishUpload();
+    } else {
+        sendPendingChunks();
+    }
+}
+
+void ChunkedUpload::abort()
+{
+    if (stopped) {
+        return;
+    }
+    stopped = true;
+
+    // abort() emite finished() na hora; os slots veem `stopped` e só liberam a resposta
+    if (controlReply) {
+        controlReply->abort();
+        controlReply = nullptr;
+    }
+    const QList<QNetworkReply*> replies = inFlight.keys();
+    inFlight.clear();
+    for (QNetworkReply* reply : replies) {
+        reply->abort();
+    }
+}
+
+void ChunkedUpload::onSessionCreated()
+{
+    QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
+    reply->deleteLater();
+    if (stopped || reply != controlReply) {
+        return;
+    }
+    controlReply = nullptr;
+
+    QJsonObject obj = QJsonDocument::fromJson(reply->readAll()).object();
+    if (reply->error() != QNetworkReply::NoError || !obj.value("success").toBool(false)) {
+        fail(obj.value("error_message").toString(reply->errorString()));
+        return;
+    }
+
+    // O mestre pode ajustar o tamanho do bloco aos limites dele
+    uploadId = obj.value("upload_id").toString();
+    chunkSize = static_cast<qint64>(obj.value("chunk_size").toDouble());
+    chunkCount = obj.value("chunks").toInt();
+    if (uploadId.isEmpty() || chunkSize <= 0 || chunkCount <= 0) {
+        fail("Resposta inválida ao criar o upload");
+        return;
+    }
+
+    for (int i = 0; i < chunkCount; i++) {
+        pendingChunks.append(i);
+    }
+
+    qDebug() << "Upload" << uploadId << ":" << chunkCount << "blocos de" << chunkSize << "bytes";
+    emit sessionStarted(uploadId);
+    emitProgress();
+    sendPendingChunks();
+}
+
+void ChunkedUpload::sendPendingChunks()
+{
+    while (!stopped && inFlight.size() + preparing.size() < connections && !pendingChunks.isEmpty()) {
+        sendChunk(pendingChunks.takeFirst());
+    }
+}
+
+ChunkedUpload::PreparedChunk ChunkedUpload::prepareChunk(const char* chunk, qint64 length, int index,
+                                                         bool compress)
+{
+    // Comprimido, o bloco vai em gzip se encolher o bastante; o hash é
+    // sempre o do bloco original, conferido pelo mestre após descomprimir
+    PreparedChunk prepared{index, chunkHash(chunk, length), QByteArray()};
+    if (compress) {
+        prepared.compressed = gzipChunk(chunk, length);
+        if (prepared.compressed.size() * 100 > length * (100 - MIN_GAIN_PERCENT)) {
+            prepared.compressed.clear();
+        }
+    }
+    return prepared;
+}
+
+void ChunkedUpload::sendChunk(int index)
+{
+    qint64 offset = index * chunkSize;
+    qint64 length = qMin(chunkSize, size - offset);
+    const char* chunk = reinterpret_cast<const char*>(data) + offset;
+
+    // Hash e gzip percorrem o bloco inteiro (até dezenas de MB): no pool,
+    // para a interface não travar enquanto os blocos saem
+    auto* watcher = new QFutureWatcher<PreparedChunk>(this);
+    connect(watcher, &QFutureWatcher<PreparedChunk>::finished, this, &ChunkedUpload::onChunkPrepared);
+    preparing.append(watcher);
+    watcher->setFuture(QtConcurrent::run(&ChunkedUpload::prepareChunk, chunk, length, index, compress));
+}
+
+void ChunkedUpload::onChunkPrepared()
+{
+    auto* watcher = static_cast<QFutureWatcher<PreparedChunk>*>(sender());
+    preparing.removeOne(watcher);
+    watcher->deleteLater();
+    if (stopped) {
+        return;
+    }
+    putChunk(watcher->result());
+}
+
+void ChunkedUpload::putChunk(const PreparedChunk& prepared)
+{
+    qint64 offset = prepared.index * chunkSize;
+    qint64 length = qMin(chunkSize, size - offset);
+    const char* chunk = reinterpret_cast<const char*>(data) + offset;
+
+    // Sem compressão o bloco é lido do mapeamento, sem cópia (ver FileProcessor::mapFile)
+    QBuffer* body = new QBuffer();
+    body->setData(prepared.compressed.isEmpty() ? QByteArray::fromRawData(chunk, static_cast<int>(length))
+                                                : prepared.compressed);
+    body->open(QIODevice::ReadOnly);
+
+    QNetworkRequest request = makeRequest(QString("/upload/%1/chunks/%2").arg(uploadId).arg(prepared.index));
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/octet-stream");
+    request.setHeader(QNetworkRequest::ContentLengthHeader, body->size());
+    if (!prepared.compressed.isEmpty()) {
+        request.setRawHeader("Content-Encoding", "gzip");
+    }
+    request.setRawHeader("X-Chunk-Hash", prepared.hash);
+    request.setAttribute(QNetworkRequest::DoNotBufferUploadDataAttribute, true);
+
+    QNetworkReply* reply = manager->put(request, body);
+    body->setParent(reply);
+    inFlight.insert(reply, ChunkInFlight{prepared.index, 0, body->size()});
+
+    connect(reply, &QNetworkReply::uploadProgress, this, &ChunkedUpload::onChunkUploadProgress);
+    connect(reply, &QNetworkReply::finished, this, &ChunkedUpload::onChunkFinished);
+}
+
+void ChunkedUpload::onChunkUploadProgress(qint64 bytesSent, qint64 bytesTotal)
+{
+    Q_UNUSED(bytesTotal);
+    QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
+    auto it = inFlight.find(reply);
+    if (it != inFlight.end() && it->wireLength > 0) {
+        // Progresso em bytes do arquivo, mesmo com o bloco comprimido
+        qint64 length = qMin(chunkSize, size - it->index * chunkSize);
+        it->sent = bytesSent * length / it->wireLength;
+        emitProgress();
+    }
+}
+
+void ChunkedUpload::onChunkFinished()
+{
+    QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
+    reply->deleteLater();
+    if (stopped || !inFlight.contains(reply)) {
+        return;
+    }
+    ChunkInFlight chunk = inFlight.take(reply);
+
+    int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    QByteArray response = reply->readAll();
+
+    if (reply->error() == QNetworkReply::NoError) {
+        chunksDone++;
+        bytesDone += qMin(chunkSize, size - chunk.index * chunkSize);
+        emitProgress();
+
+        if (chunksDone == chunkCount) {
+            finishUpload();
+        } else {
+            sendPendingChunks();
+        }
+        return;
+    }
+
+    // Mestre sem suporte a gzip: o resto do upload vai sem compressão
+    qint64 length = qMin(chunkSize, size - chunk.index * chunkSize);
+    if (status == 415 && compress && chunk.wireLength != length) {
+        qWarning() << "Mestre não aceita blocos comprimidos, enviando sem compressão";
+        compress = false;
+        pendingChunks.prepend(chunk.index);
+        sendPendingChunks();
+        return;
+    }
+
+    // Falha de rede, hash divergente (422) ou mestre sobrecarregado: reenviar.
+    // Sessão inexistente ou bloco inválido não melhoram com nova tentativa
+    bool retryable = status == 0 || status == 422 || status >= 500;
+    int attempt = ++attempts[chunk.index];
+    if (retryable && attempt < MAX_CHUNK_ATTEMPTS) {
+        // Fora de pendingChunks durante a espera: senão a próxima conexão
+        // livre o reenviaria na hora. A vaga dele vai para outro bloco
+        qWarning() << "Bloco" << chunk.index << "falhou (" << reply->errorString() << "), reenviando";
+        int index = chunk.index;
+        retryChunks.append(index);
+        emitProgress();
+        QTimer::singleShot(RETRY_DELAY_MS * attempt, this, [this, index]() {
+            if (stopped || !retryChunks.removeOne(index)) {
+                return;
+            }
+            pendingChunks.prepend(index);
+            sendPendingChunks();
+        });
+        sendPendingChunks();
+        return;
+    }
+
+    QString error = QJsonDocument::fromJson(response).object().value("error_message").toString();
+    fail(QString("Falha no bloco %1: %2").arg(chunk.index).arg(error.isEmpty() ? reply->errorString() : error));
+}
+
+void ChunkedUpload::finishUpload()
+{
+    QNetworkRequest request = makeRequest(QString("/upload/%1/finish").arg(uploadId));
+    controlReply = manager->post(request, QByteArray());
+    connect(controlReply, &QNetworkReply::finished, this, &ChunkedUpload::onFinishReplied);
+}
+
+void ChunkedUpload::onFinishReplied()
+{
+    QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
+    reply->deleteLater();
+    if (stopped || reply != controlReply) {
+        return;
+    }
+    controlReply = nullptr;
+
+    QByteArray response = reply->readAll();
+    if (reply->error() != QNetworkReply::NoError) {
+        QString error = QJsonDocument::fromJson(response).object().value("error_message").toString();
+        fail(error.isEmpty() ? reply->errorString() : error);
+        return;
+    }
+
+    stopped = true;
+    emit progress(100);
+    emit finished(response);
+}
+
+void ChunkedUpload::fail(const QString& error)
+{
+    abort();
+    emit failed(error);
+}
+
+void ChunkedUpload::emitProgress()
+{
+    if (size <= 0) {
+        return;
+    }
+
+    qint64 bytes = bytesDone;
+    for (const ChunkInFlight& chunk : inFlight) {
+        bytes += chunk.sent;
+    }
+
+    int percentage = static_cast<int>(bytes * 100 / size);
+    if (percentage != lastProgress) {
+        lastProgress = percentage;
+        emit progress(percentage);
+    }
+}
@@ -0,0 +1,117 @@
+#ifndef CHUNKEDUPLOAD_H
+#define CHUNKEDUPLOAD_H
+
+#include <QObject>
+#include <QFile>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QList>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <functional>
+
+// Upload de um arquivo grande em blocos paralelos (/upload do mestre).
+// O arquivo é mapeado em memória e cada bloco vai num PUT próprio, lido
+// direto do mapeamento, com o hash FNV-1a do bloco em X-Chunk-Hash. Até
+// `connections` blocos ficam em voo ao mesmo tempo; um bloco que falha por
+// rede, hash ou sobrecarga é reenviado algumas vezes, com espera, antes de
+// desistir. Hash e compressão de cada bloco rodam no pool de threads do Qt,
+// fora da thread da interface.
+// A sessão sobrevive a uma queda: start() com o ID de uma sessão anterior
+// consulta o mestre e envia só os blocos que faltam. Com compressão (e o
+// cliente compilado com zlib), cada bloco vai com Content-Encoding gzip.
+class ChunkedUpload : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Monta a requisição para um endpoint do mestre (URL e cabeçalhos comuns)
+    using RequestFactory = std::function<QNetworkRequest(const QString& endpoint)>;
+
+    ChunkedUpload(QNetworkAccessManager* manager, RequestFactory makeRequest,
+                  const QString& filepath, int connections, qint64 chunkSize,
+                  QObject *parent = nullptr);
+    ~ChunkedUpload();
+
+    // Abre e mapeia o arquivo e retoma a sessão resumeId, se ela ainda
+    // existir no mestre, ou cria outra; lança FileProcessingException
+    void start(const QString& resumeId = QString());
+    void abort();
+
+    // Comprime os blocos com gzip (antes de start()); sem zlib, ignorado
+    void setCompression(bool enabled);
+
+    // FNV-1a de 64 bits em hexadecimal, o formato de X-Chunk-Hash
+    static QByteArray chunkHash(const char* data, qint64 length);
+
+    // Bloco em gzip; vazio sem zlib ou em caso de falha
+    static QByteArray gzipChunk(const char* data, qint64 length);
+
+signals:
+    void progress(int percentage);
+    // Sessão criada ou retomada; o ID permite retomar depois de uma falha
+    void sessionStarted(const QString& uploadId);
+    // Corpo da resposta de /upload/{id}/finish (mesmo formato de /process)
+    void finished(const QByteArray& response);
+    void failed(const QString& error);
+
+private slots:
+    void onSessionCreated();
+    void onResumeStatus();
+    void onChunkPrepared();
+    void onChunkFinished();
+    void onChunkUploadProgress(qint64 bytesSent, qint64 bytesTotal);
+    void onFinishReplied();
+
+private:
+    // Bloco pronto para envio, montado fora da thread da interface
+    struct PreparedChunk {
+        int index;
+        QByteArray hash;
+        // gzip do bloco; vazio se for sem compressão
+        QByteArray compressed;
+    };
+
+    struct ChunkInFlight {
+        int index;
+        qint64 sent;
+        // Bytes no corpo da requisição (menos que o bloco, se comprimido)
+        qint64 wireLength;
+    };
+
+    void createSession();
+    void sendPendingChunks();
+    void sendChunk(int index);
+    void putChunk(const PreparedChunk& prepared);
+    static PreparedChunk prepareChunk(const char* chunk, qint64 length, int index, bool compress);
+    void finishUpload();
+    void fail(const QString& error);
+    void emitProgress();
+
+    QNetworkAccessManager* manager;
+    RequestFactory makeRequest;
+    QFile file;
+    const uchar* data;
+    qint64 size;
+    qint64 chunkSize;
+    int chunkCount;
+    int connections;
+    bool compress;
+
+    QString uploadId;
+    QNetworkReply* controlReply;
+    QList<int> pendingChunks;
+    // Reenvios aguardando a espera entre tentativas
+    QList<int> retryChunks;
+    // Blocos sendo preparados; contam como conexões ocupadas
+    QList<QFutureWatcher<PreparedChunk>*> preparing;
+    QHash<QNetworkReply*, ChunkInFlight> inFlight;
+    QHash<int, int> attempts;
+    int chunksDone;
+    qint64 bytesDone;
+    int lastProgress;
+    bool stopped;
+};
+
+#endif // CHUNKEDUPLOAD_H
@@ -2,8 +2,10 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QTextStream>
+#include <QBuffer>
 #include <QDir>
 #include <QDebug>
+#include <limits>
 
 FileProcessor::FileProcessor(QObject *parent)
     : QObject(parent)
@@ -36,6 +38,45 @@ QString FileProcessor::readFile(const QString& filepath)
     return content;
 }
 
+// Abre o arquivo para envio como corpo de requisição, sem lê-lo para a
+// memória nem decodificá-lo: o conteúdo é mapeado (QFile::map) e exposto por
+// um QBuffer sobre o mapeamento, que o QNetworkAccessManager lê direto, em
+// blocos. O QBuffer é dono do QFile, então o mapeamento vale enquanto ele
+// existir. Se o mapeamento não for possível, devolve o próprio QFile, que
+// também é lido em blocos.
+QIODevice* FileProcessor::mapFile(const QString& filepath, QObject* parent)
+{
+    QFile* file = new QFile(filepath);
+
+    if (!file->exists()) {
+        delete file;
+        throw FileProcessingException(QString("Arquivo não encontrado: %1").arg(filepath));
+    }
+
+    if (!file->open(QIODevice::ReadOnly)) {
+        delete file;
+        throw FileProcessingException(QString("Não foi possível abrir o arquivo: %1").arg(filepath));
+    }
+
+    qint64 size = file->size();
+    bool mappable = size > 0;
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+    // QByteArray do Qt 5 é limitado a int
+    mappable = mappable && size <= std::numeric_limits<int>::max();
+#endif
+    uchar* data = mappable ? file->map(0, size) : nullptr;
+    if (!data) {
+        file->setParent(parent);
+        return file;
+    }
+
+    QBuffer* buffer = new QBuffer(parent);
+    buffer->setData(QByteArray::fromRawData(reinterpret_cast<const char*>(data), size));
+    buffer->open(QIODevice::ReadOnly);
+    file->setParent(buffer);
+    return buffer;
+}
+
 bool FileProcessor::writeFile(const QString& filepath, const QString& content)
 {
     try {
@@ -29,6 +29,7 @@ public:
     explicit FileProcessor(QObject *parent = nullptr);
 
     static QString readFile(const QString& filepath);
+    static QIODevice* mapFile(const QString& filepath, QObject* parent = nullptr);
     static bool writeFile(const QString& filepath, const QString& content);
     static bool fileExists(const QString& filepath);
     static QString getFileExtension(const QString& filepath);
@@ -1,10 +1,56 @@
 #include "httpclient.h"
+#include "fileprocessor.h"
+#include "chunkedupload.h"
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QNetworkReply>
 #include <QDebug>
 #include <QEventLoop>
 #include <QApplication>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QSettings>
+#include <QCryptographicHash>
+#include <QHostAddress>
+#include <QNetworkInterface>
+
+// Arquivos a partir deste tamanho sobem em blocos paralelos (/upload); os
+// menores vão numa requisição só. O QNetworkAccessManager abre até 6
+// conexões por servidor
+static const qint64 PARALLEL_UPLOAD_THRESHOLD = 32 * 1024 * 1024;
+static const qint64 UPLOAD_CHUNK_SIZE = 8 * 1024 * 1024;
+static const int UPLOAD_CONNECTIONS = 4;
+
+// Contagens chegam como inteiros de 64 bits; o Qt 5 só os lê como double,
+// exato até 2^53
+static qint64 jsonInt64(const QJsonValue& value)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    return value.toInteger(0);
+#else
+    return static_cast<qint64>(value.toDouble(0));
+#endif
+}
+
+// Mestre na própria máquina (localhost ou um endereço local): a rede não é
+// o gargalo e comprimir os blocos só gastaria CPU. Nomes de host não são
+// resolvidos aqui, na thread da interface, e contam como remotos
+static bool isLocalHost(const QString& host)
+{
+    if (host.compare("localhost", Qt::CaseInsensitive) == 0) {
+        return true;
+    }
+    QHostAddress address(host);
+    return !address.isNull() && (address.isLoopback() || QNetworkInterface::allAddresses().contains(address));
+}
+
+// Chave em QSettings da sessão de upload de um arquivo, para retomá-la
+// depois de uma falha ou de reabrir o cliente
+static QString uploadSettingsKey(const QFileInfo& info)
+{
+    QByteArray path = info.absoluteFilePath().toUtf8();
+    return "uploads/" + QCryptographicHash::hash(path, QCryptographicHash::Sha1).toHex();
+}
 
 HttpClient::HttpClient(QObject *parent)
     : QObject(parent)
@@ -14,6 +60,7 @@ HttpClient::HttpClient(QObject *parent)
     , timeoutSeconds(30)
     , timeoutTimer(new QTimer(this))
     , currentReply(nullptr)
+    , currentUpload(nullptr)
 {
     timeoutTimer->setSingleShot(true);
     connect(timeoutTimer, &QTimer::timeout, this, &HttpClient::onRequestTimeout);
@@ -41,15 +88,27 @@ QNetworkRequest HttpClient::createRequest(const QString& endpoint)
     QNetworkRequest request(url);
     request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
     request.setRawHeader("User-Agent", "QtClient/1.0");
+    // Requisições da interface gráfica são interativas
+    request.setRawHeader("X-Priority", "interactive");
     return request;
 }
 
-void HttpClient::checkServerHealth()
+void HttpClient::cancelCurrentRequest()
 {
     if (currentReply) {
         currentReply->abort();
         currentReply = nullptr;
     }
+    if (currentUpload) {
+        currentUpload->abort();
+        currentUpload->deleteLater();
+        currentUpload = nullptr;
+    }
+}
+
+void HttpClient::checkServerHealth()
+{
+    cancelCurrentRequest();
 
     QNetworkRequest request = createRequest("/health");
     currentReply = networkManager->get(request);
@@ -62,10 +121,7 @@ void HttpClient::checkServerHealth()
 
 void HttpClient::processText(const QString& text)
 {
-    if (currentReply) {
-        currentReply->abort();
-        currentReply = nullptr;
-    }
+    cancelCurrentRequest();
 
     QNetworkRequest request = createRequest("/process");
 
@@ -81,6 +137,114 @@ void HttpClient::processText(const QString& text)
     timeoutTimer->start(timeoutSeconds * 1000);
 }
 
+void HttpClient::processFile(const QString& filepath)
+{
+    if (QFileInfo(filepath).size() >= PARALLEL_UPLOAD_THRESHOLD) {
+        processFileChunked(filepath);
+        return;
+    }
+
+    // Lança FileProcessingException antes de cancelar a requisição atual
+    QIODevice* body = FileProcessor::mapFile(filepath);
+
+    cancelCurrentRequest();
+
+    // O arquivo vai como corpo text/plain, lido do mapeamento em blocos: sem
+    // QString, sem JSON e sem cópia do arquivo inteiro na memória do cliente
+    QNetworkRequest request = createRequest("/process");
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "text/plain; charset=utf-8");
+    request.setHeader(QNetworkRequest::ContentLengthHeader, body->size());
+    request.setAttribute(QNetworkRequest::DoNotBufferUploadDataAttribute, true);
+
+    currentReply = networkManager->post(request, body);
+    body->setParent(currentReply);
+
+    connect(currentReply, &QNetworkReply::finished, this, &HttpClient::onProcessTextFinished);
+    connect(currentReply, &QNetworkReply::uploadProgress, this, &HttpClient::onUploadProgress);
+
+    requestTimer.start();
+    timeoutTimer->start(timeoutSeconds * 1000);
+}
+
+void HttpClient::processFileChunked(const QString& filepath)
+{
+    // Cada bloco tem o próprio timeout de transferência; o timer geral não
+    // se aplica a um upload que pode levar minutos
+    int timeoutMs = timeoutSeconds * 1000;
+    auto makeRequest = [this, timeoutMs](const QString& endpoint) {
+        QNetworkRequest request = createRequest(endpoint);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
+        request.setTransferTimeout(timeoutMs);
+#else
+        Q_UNUSED(timeoutMs);
+#endif
+        return request;
+    };
+
+    // Sessão anterior do mesmo arquivo, inalterado desde então: retomar
+    QFileInfo info(filepath);
+    QString settingsKey = uploadSettingsKey(info);
+    QString fileVersion = QString("%1:%2").arg(info.size()).arg(info.lastModified().toMSecsSinceEpoch());
+    QSettings settings;
+    QStringList saved = settings.value(settingsKey).toStringList();
+    QString resumeId = saved.size() == 2 && saved[1] == fileVersion ? saved[0] : QString();
+
+    ChunkedUpload* upload = new ChunkedUpload(networkManager, makeRequest, filepath,
+                                              UPLOAD_CONNECTIONS, UPLOAD_CHUNK_SIZE, this);
+    upload->setCompression(!isLocalHost(QUrl(getServerUrl()).host()));
+    try {
+        upload->start(resumeId);
+    } catch (...) {
+        delete upload;
+        throw;
+    }
+
+    cancelCurrentRequest();
+    currentUpload = upload;
+    requestTimer.start();
+
+    connect(upload, &ChunkedUpload::progress, this, &HttpClient::processingProgress);
+    connect(upload, &ChunkedUpload::sessionStarted, this, [settingsKey, fileVersion](const QString& uploadId) {
+        QSettings().setValue(settingsKey, QStringList{uploadId, fileVersion});
+    });
+    connect(upload, &ChunkedUpload::finished, this, [this, upload, settingsKey](const QByteArray& response) {
+        QSettings().remove(settingsKey);
+        if (upload != currentUpload) {
+            return;
+        }
+        currentUpload->deleteLater();
+        currentUpload = nullptr;
+        emit textProcessingCompleted(parseProcessResponse(response));
+    });
+    connect(upload, &ChunkedUpload::failed, this, [this, upload](const QString& error) {
+        if (upload != currentUpload) {
+            return;
+        }
+        currentUpload->deleteLater();
+        currentUpload = nullptr;
+
+        ProcessingResult result;
+        result.success = false;
+        result.letters_count = 0;
+        result.numbers_count = 0;
+        result.total_characters = 0;
+        result.processing_time_ms = requestTimer.elapsed();
+        result.error_message = error + " (processe o arquivo de novo para retomar o envio)";
+        emit textProcessingCompleted(result);
+    });
+}
+
+void HttpClient::onUploadProgress(qint64 bytesSent, qint64 bytesTotal)
+{
+    if (bytesTotal <= 0) {
+        return;
+    }
+
+    // Enquanto o corpo sobe, o timeout conta a partir do último progresso
+    timeoutTimer->start(timeoutSeconds * 1000);
+    emit processingProgress(static_cast<int>(bytesSent * 100 / bytesTotal));
+}
+
 void HttpClient::onHealthCheckFinished()
 {
     timeoutTimer->stop();
@@ -135,10 +299,7 @@ void HttpClient::onProcessTextFinished()
 
 void HttpClient::onRequestTimeout()
 {
-    if (currentReply) {
-        currentReply->abort();
-        currentReply = nullptr;
-    }
+    cancelCurrentRequest();
 
     emit networkError("Timeout: Servidor não respondeu em tempo hábil");
 }
@@ -189,9 +350,9 @@ ProcessingResult HttpClient::parseProcessResponse(const QByteArray& data)
 
         QJsonObject obj = doc.object();
         result.success = obj.value("success").toBool(false);
-        result.letters_count = obj.value("letters_count").toInt(0);
-        result.numbers_count = obj.value("numbers_count").toInt(0);
-        result.total_characters = obj.value("total_characters").toInt(0);
+        result.letters_count = jsonInt64(obj.value("letters_count"));
+        result.numbers_count = jsonInt64(obj.value("numbers_count"));
+        result.total_characters = jsonInt64(obj.value("total_characters"));
 
         // Usar tempo do servidor se disponível
         if (obj.contains("processing_time_ms")) {
@@ -13,13 +13,15 @@
 
 struct ProcessingResult {
     bool success;
-    int letters_count;
-    int numbers_count;
-    int total_characters;
+    qint64 letters_count;
+    qint64 numbers_count;
+    qint64 total_characters;
     double processing_time_ms;
     QString error_message;
 };
 
+class ChunkedUpload;
+
 struct ServerStatus {
     bool online;
     QString status;
@@ -41,6 +43,7 @@ public:
     // Métodos assíncronos
     void checkServerHealth();
     void processText(const QString& text);
+    void processFile(const QString& filepath);
 
     // Métodos síncronos (para compatibilidade)
     ServerStatus checkServerHealthSync();
@@ -50,10 +53,12 @@ private slots:
     void onHealthCheckFinished();
     void onProcessTextFinished();
     void onRequestTimeout();
+    void onUploadProgress(qint64 bytesSent, qint64 bytesTotal);
 
 signals:
     void healthCheckCompleted(const ServerStatus& status);
     void textProcessingCompleted(const ProcessingResult& result);
+    void processingProgress(int percentage);
     void networkError(const QString& error);
 
 private:
@@ -64,8 +69,11 @@ private:
     QTimer* timeoutTimer;
     QElapsedTimer requestTimer;
     QNetworkReply* currentReply;
+    ChunkedUpload* currentUpload;
 
     QNetworkRequest createRequest(const QString& endpoint);
+    void cancelCurrentRequest();
+    void processFileChunked(const QString& filepath);
     ServerStatus parseHealthResponse(const QByteArray& data);
     ProcessingResult parseProcessResponse(const QByteArray& data);
     void handleNetworkError(QNetworkReply::NetworkError error);
@@ -183,9 +183,6 @@ void MainWindow::createStatusBar()
 
     statusLabel = new QLabel("Pronto");
     status->addWidget(statusLabel);
-
-    progressTimer = new QTimer(this);
-    connect(progressTimer, &QTimer::timeout, this, &MainWindow::updateProcessingProgress);
 }
 
 void MainWindow::connectSignals()
@@ -203,6 +200,8 @@ void MainWindow::connectSignals()
             this, &MainWindow::onTextProcessingCompleted);
     connect(httpClient, &HttpClient::networkError,
             this, &MainWindow::onNetworkError);
+    connect(httpClient, &HttpClient::processingProgress,
+            this, &MainWindow::updateProcessingProgress);
 }
 
 void MainWindow::configureServer()
@@ -257,15 +256,20 @@ void MainWindow::processFile()
     }
 
     try {
-        QString content = FileProcessor::readFile(filepath);
-        if (content.isEmpty()) {
+        if (FileProcessor::fileExists(filepath) && FileProcessor::getFileSize(filepath) == 0) {
             showError("Arquivo está vazio!");
             return;
         }
 
+        // O arquivo é enviado direto do disco, sem ser carregado como texto
+        httpClient->processFile(filepath);
+
         QString filename = FileProcessor::getFileName(filepath);
         QString source = QString("Arquivo: %1").arg(filename);
-        processTextContent(content, source);
+        updateStatus("Processando " + source.toLower() + "...");
+        setButtonsEnabled(false);
+        showProcessingProgress(true);
+        isProcessing = true;
 
         // Atualizar último diretório usado
         lastUsedDirectory = QFileInfo(filepath).absolutePath();
@@ -327,11 +331,11 @@ void MainWindow::onNetworkError(const QString& error)
     updateResults("❌ Erro no processamento:\n" + error);
 }
 
-void MainWindow::updateProcessingProgress()
+void MainWindow::updateProcessingProgress(int percentage)
 {
-    static int value = 0;
-    value = (value + 1) % 100;
-    progressBar->setValue(value);
+    // Progresso real do envio; até o primeiro aviso a barra fica indeterminada
+    progressBar->setRange(0, 100);
+    progressBar->setValue(percentage);
 }
 
 QString MainWindow::formatResult(const ProcessingResult& result, const QString& source)
@@ -351,7 +355,7 @@ QString MainWindow::formatResult(const ProcessingResult& result, const QString&
         output += QString("   Total de caracteres:    %1\n").arg(result.total_characters, 8);
         output += QString("   Tempo de processamento: %1 ms\n").arg(result.processing_time_ms, 8, 'f', 2);
 
-        int total = result.letters_count + result.numbers_count;
+        qint64 total = result.letters_count + result.numbers_count;
         if (total > 0) {
             double letterPct = (static_cast<double>(result.letters_count) / total) * 100.0;
             double numberPct = (static_cast<double>(result.numbers_count) / total) * 100.0;
@@ -422,9 +426,7 @@ void MainWindow::showProcessingProgress(bool show)
     progressBar->setVisible(show);
     if (show) {
         progressBar->setRange(0, 0); // Modo indeterminado
-        progressTimer->start(50);
     } else {
-        progressTimer->stop();
         progressBar->setRange(0, 100);
         progressBar->setValue(0);
     }
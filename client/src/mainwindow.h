@@ -47,7 +47,7 @@ private slots:
     void onHealthCheckCompleted(const ServerStatus& status);
     void onTextProcessingCompleted(const ProcessingResult& result);
     void onNetworkError(const QString& error);
-    void updateProcessingProgress();
+    void updateProcessingProgress(int percentage);
 
 private:
     // UI Components
@@ -97,7 +97,6 @@ private:
     // UI Widgets - Status
     QProgressBar* progressBar;
     QLabel* statusLabel;
-    QTimer* progressTimer;
 
     // Backend
     HttpClient* httpClient;
@@ -0,0 +1,73 @@
+#include "in_process_transport.h"
+#include <future>
+#include <stdexcept>
+
+InProcessTransport::InProcessTransport(size_t threads) {
+    if (threads == 0) {
+        threads = 1;
+    }
+    for (size_t i = 0; i < threads; i++) {
+        workers.emplace_back(&InProcessTransport::worker_loop, this);
+    }
+}
+
+InProcessTransport::~InProcessTransport() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+void InProcessTransport::add_handler(const std::string& type, Handler handler) {
+    handlers[type] = std::move(handler);
+}
+
+std::string InProcessTransport::call(const SlaveInfo& slave, const std::string& text,
+                                     const tracing::Context&) {
+    auto it = handlers.find(slave.type);
+    if (it == handlers.end()) {
+        throw std::runtime_error("Tipo de escravo sem função no processo: " + slave.type);
+    }
+
+    // A thread chamadora bloqueia até o fim, então texto e função podem ir
+    // por referência
+    const Handler& handler = it->second;
+    std::packaged_task<std::string()> task([&handler, &text]() { return handler(text); });
+    std::future<std::string> result = task.get_future();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping) {
+            throw std::runtime_error("Transporte em processo encerrado");
+        }
+        tasks.emplace_back([&task]() { task(); });
+    }
+    wake.notify_one();
+
+    // Exceções da função chegam aqui pelo future
+    return result.get();
+}
+
+bool InProcessTransport::check_health(const SlaveInfo& slave) {
+    return handlers.count(slave.type) > 0;
+}
+
+void InProcessTransport::worker_loop() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (tasks.empty()) {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "slave_transport.h"
+
+// Transporte do binário embutido: o mestre chama as funções dos escravos
+// no mesmo processo, sem HTTP nem JSON do texto. As contagens rodam num
+// pool de threads compartilhado pelos dois tipos de escravo, como as
+// threads HTTP de um escravo separado; a thread do mestre espera o
+// resultado. O texto é passado por referência, sem cópia.
+class InProcessTransport : public SlaveTransport {
+public:
+    // Processa o texto e devolve o JSON de resposta do escravo
+    using Handler = std::function<std::string(const std::string&)>;
+
+    explicit InProcessTransport(size_t threads);
+    ~InProcessTransport() override;
+
+    InProcessTransport(const InProcessTransport&) = delete;
+    InProcessTransport& operator=(const InProcessTransport&) = delete;
+
+    // Associa um tipo de escravo ("letters", "numbers") à sua função
+    // (antes de o mestre começar a despachar)
+    void add_handler(const std::string& type, Handler handler);
+
+    std::string call(const SlaveInfo& slave, const std::string& text,
+                     const tracing::Context& trace) override;
+    bool check_health(const SlaveInfo& slave) override;
+
+private:
+    void worker_loop();
+
+    std::map<std::string, Handler> handlers;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<std::function<void()>> tasks;
+    bool stopping = false;
+    std::vector<std::thread> workers;
+};
@@ -0,0 +1,135 @@
+#include <iostream>
+#include <csignal>
+#include <atomic>
+#include <thread>
+#include <cstdlib>
+#include <memory>
+#include <algorithm>
+#include "master_server.h"
+#include "letters_server.h"
+#include "numbers_server.h"
+#include "in_process_transport.h"
+#include "logger.h"
+#include "tracing.h"
+#include "traffic_capture.h"
+
+// Mestre e escravos num único processo: a API HTTP para os clientes é a
+// mesma do mestre, mas as contagens são chamadas diretas (InProcessTransport)
+
+std::atomic<bool> keep_running(true);
+std::atomic<int> received_signal(0);
+
+// Só atômicos aqui: o logger (anel por thread) e o stop() do servidor não
+// são seguros dentro de um handler de sinal. O loop principal loga e para
+void signal_handler(int signal) {
+    received_signal = signal;
+    keep_running = false;
+}
+
+int main(int argc, char* argv[]) {
+    // Configurar logs
+    Logger::set_component_name("EMBEDDED");
+    Logger::set_log_level(LogLevel::DEBUG);
+    tracing::configure("EMBEDDED");
+    capture::Recorder::instance().configure();
+
+    Logger::info("=== INICIANDO MODO EMBUTIDO (MESTRE + ESCRAVOS) ===");
+
+    // Configurar handler de sinais para graceful shutdown
+    std::signal(SIGINT, signal_handler);
+    std::signal(SIGTERM, signal_handler);
+
+    // Porta do servidor (pode ser passada como argumento)
+    int port = 8080;
+    if (argc > 1) {
+        try {
+            port = std::stoi(argv[1]);
+            Logger::info_f("Porta definida via argumento: %d", port);
+        } catch (const std::exception& e) {
+            Logger::warning_f("Argumento de porta inválido '%s', usando porta padrão %d",
+                             argv[1], port);
+        }
+    }
+
+    // Threads do pool de contagem (padrão: uma por núcleo)
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    if (const char* value = std::getenv("EMBEDDED_THREADS")) {
+        try {
+            threads = std::stoul(value);
+        } catch (const std::exception& e) {
+            Logger::warning_f("EMBEDDED_THREADS inválido '%s', usando %zu", value, threads);
+        }
+    }
+
+    try {
+        // Escravos sem servidor HTTP: só as funções de processamento são usadas
+        LettersServer letters(0);
+        NumbersServer numbers(0);
+
+        auto transport = std::make_shared<InProcessTransport>(threads);
+        transport->add_handler("letters", [&letters](const std::string& text) {
+            return letters.process_letters_request(text, false);
+        });
+        transport->add_handler("numbers", [&numbers](const std::string& text) {
+            return numbers.process_numbers_request(text, false);
+        });
+
+        // Criar servidor mestre
+        MasterServer server(port);
+        server.set_transport(transport);
+
+        if (const char* slots = std::getenv("MASTER_DISPATCH_SLOTS")) {
+            try {
+                server.set_dispatch_slots(std::stoul(slots));
+            } catch (const std::exception& e) {
+                Logger::warning_f("MASTER_DISPATCH_SLOTS inválido '%s', mantendo padrão", slots);
+            }
+        }
+
+        // Escravos estáticos atendidos pelo transporte em processo
+        server.add_slave("embedded-letters", "in-process", 0, "/letras", "letters");
+        server.add_slave("embedded-numbers", "in-process", 0, "/numeros", "numbers");
+        server.update_slaves_health();
+
+        Logger::info_f("Tentando iniciar servidor na porta %d (%zu threads de contagem)", port, threads);
+
+        // Iniciar servidor em thread separada para permitir graceful shutdown
+        std::thread server_thread([&server]() {
+            if (!server.start()) {
+                Logger::error("Falha ao iniciar servidor");
+                keep_running = false;
+            }
+        });
+
+        // Aguardar um pouco para verificar se o servidor iniciou
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        if (keep_running) {
+            Logger::info("=== MODO EMBUTIDO INICIADO COM SUCESSO ===");
+            Logger::info_f("Servidor escutando na porta %d", port);
+
+            // Loop principal
+            while (keep_running) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+        }
+
+        if (received_signal) {
+            Logger::info_f("Sinal recebido: %d", received_signal.load());
+        }
+        Logger::info("Iniciando shutdown graceful...");
+        server.stop();
+
+        if (server_thread.joinable()) {
+            server_thread.join();
+        }
+
+        Logger::info("=== MODO EMBUTIDO FINALIZADO ===");
+
+    } catch (const std::exception& e) {
+        Logger::error_f("Erro fatal: %s", e.what());
+        return 1;
+    }
+
+    return 0;
+}
@@ -1,34 +1,59 @@
 #include "logger.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <thread>
+#include <vector>
 
 // Inicialização de variáveis estáticas
-std::mutex Logger::log_mutex;
-LogLevel Logger::current_level = LogLevel::INFO;
-std::string Logger::component_name = "SYSTEM";
+std::atomic<LogLevel> Logger::current_level{LogLevel::INFO};
 
-void Logger::set_component_name(const std::string& name) {
-    std::lock_guard<std::mutex> lock(log_mutex);
-    component_name = name;
-}
+namespace {
 
-void Logger::set_log_level(LogLevel level) {
-    std::lock_guard<std::mutex> lock(log_mutex);
-    current_level = level;
+// Linhas por thread antes de o overflow entrar em ação (potência de dois)
+constexpr size_t RING_CAPACITY = 256;
+
+// Mensagens até este tamanho não alocam; as maiores usam a string do slot
+constexpr size_t INLINE_TEXT = 232;
+
+// Intervalo máximo entre dois lotes do escritor
+constexpr std::chrono::milliseconds WRITER_INTERVAL(10);
+
+constexpr size_t COMPONENT_MAX = 64;
+
+// Buffer de pilha para as variantes *_f
+constexpr size_t FORMAT_BUFFER = 512;
+
+// Intervalo padrão dos resumos de supressão e de acesso (LOG_SUMMARY_INTERVAL)
+constexpr std::chrono::seconds DEFAULT_SUMMARY_INTERVAL(10);
+
+// Pontos amostrados e rotas de acesso, em listas só de inserção
+std::atomic<LogSite*> log_sites{nullptr};
+std::atomic<AccessLog*> access_logs{nullptr};
+
+// -1 = ainda não lido de LOG_ACCESS; 0 = uma linha por requisição; 1 = resumo
+std::atomic<int> access_mode{-1};
+
+long long steady_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
 }
 
-std::string Logger::get_timestamp() {
-    auto now = std::chrono::system_clock::now();
-    auto time_t = std::chrono::system_clock::to_time_t(now);
-    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        now.time_since_epoch()
-    ) % 1000;
-    
-    std::stringstream ss;
-    ss << std::put_time(std::localtime(&time_t), "%Y-%m-%d %H:%M:%S");
-    ss << '.' << std::setfill('0') << std::setw(3) << ms.count();
-    return ss.str();
+const char* base_name(const char* path) {
+    const char* slash = std::strrchr(path, '/');
+    return slash ? slash + 1 : path;
 }
 
-std::string Logger::level_to_string(LogLevel level) {
+// Nome do componente em armazenamento estático simples para continuar
+// válido mesmo durante a destruição de objetos globais
+std::mutex component_mutex;
+char component_name[COMPONENT_MAX] = "SYSTEM";
+std::atomic<unsigned> component_version{0};
+
+const char* level_to_string(LogLevel level) {
     switch (level) {
         case LogLevel::DEBUG:   return "DEBUG";
         case LogLevel::INFO:    return "INFO ";
@@ -38,7 +63,7 @@ std::string Logger::level_to_string(LogLevel level) {
     }
 }
 
-std::string Logger::get_color_code(LogLevel level) {
+const char* get_color_code(LogLevel level) {
     switch (level) {
         case LogLevel::DEBUG:   return "\033[36m"; // Cyan
         case LogLevel::INFO:    return "\033[32m"; // Green
@@ -48,24 +73,486 @@ std::string Logger::get_color_code(LogLevel level) {
     }
 }
 
-std::string Logger::get_reset_color() {
+const char* get_reset_color() {
     return "\033[0m";
 }
 
+long long now_ms() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()
+    ).count();
+}
+
+// Parte "YYYY-MM-DD HH:MM:SS" recalculada só quando o segundo muda
+class TimestampCache {
+public:
+    void append(std::string& out, long long timestamp_ms) {
+        long long second = timestamp_ms / 1000;
+        if (second != cached_second) {
+            std::time_t t = static_cast<std::time_t>(second);
+            std::tm tm_local{};
+            localtime_r(&t, &tm_local);
+            cached_length = std::strftime(cached, sizeof(cached), "%Y-%m-%d %H:%M:%S", &tm_local);
+            cached_second = second;
+        }
+
+        char millis[5];
+        std::snprintf(millis, sizeof(millis), ".%03d", static_cast<int>(timestamp_ms % 1000));
+        out.append(cached, cached_length);
+        out.append(millis, 4);
+    }
+
+private:
+    long long cached_second = -1;
+    char cached[32] = {};
+    size_t cached_length = 0;
+};
+
+void format_line(std::string& out, TimestampCache& timestamps, const char* component,
+                 LogLevel level, long long timestamp_ms, const char* text, size_t length) {
+    out.append(get_color_code(level));
+    out.push_back('[');
+    timestamps.append(out, timestamp_ms);
+    out.append("][");
+    out.append(level_to_string(level));
+    out.append("][");
+    out.append(component);
+    out.append("] ");
+    out.append(text, length);
+    out.append(get_reset_color());
+    out.push_back('\n');
+}
+
+struct Record {
+    long long timestamp_ms;
+    LogLevel level;
+    size_t length;
+    char text[INLINE_TEXT];
+    std::string long_text;
+};
+
+// Buffer circular de uma única thread produtora; só o escritor consome
+struct Ring {
+    Record slots[RING_CAPACITY];
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) std::atomic<size_t> tail{0};
+
+    // A thread dona terminou: o escritor libera o buffer depois de esvaziá-lo
+    std::atomic<bool> orphaned{false};
+};
+
+struct ThreadRing {
+    Ring* ring = nullptr;
+    ~ThreadRing() {
+        if (ring) {
+            ring->orphaned.store(true, std::memory_order_release);
+            ring = nullptr;
+        }
+    }
+};
+
+thread_local ThreadRing thread_ring;
+
+// Falso antes da construção e depois da destruição do backend; nesses
+// momentos as linhas são escritas diretamente
+std::atomic<bool> backend_alive{false};
+
+class AsyncBackend {
+public:
+    static AsyncBackend& instance() {
+        static AsyncBackend backend;
+        return backend;
+    }
+
+    void push(LogLevel level, const char* text, size_t length) {
+        Ring& ring = local_ring();
+        size_t head = ring.head.load(std::memory_order_relaxed);
+
+        while (head - ring.tail.load(std::memory_order_acquire) >= RING_CAPACITY) {
+            if (policy.load(std::memory_order_relaxed) == LogOverflowPolicy::DROP ||
+                !backend_alive.load(std::memory_order_acquire)) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            request_cycle();
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+
+        Record& record = ring.slots[head & (RING_CAPACITY - 1)];
+        record.timestamp_ms = now_ms();
+        record.level = level;
+        record.length = length;
+        if (length <= INLINE_TEXT) {
+            std::memcpy(record.text, text, length);
+        } else {
+            record.long_text.assign(text, length);
+        }
+
+        ring.head.store(head + 1, std::memory_order_release);
+    }
+
+    void flush() {
+        std::unique_lock<std::mutex> lock(wake_mutex);
+
+        // O ciclo em andamento pode já ter passado pelo nosso buffer;
+        // o seguinte com certeza começa depois desta chamada
+        unsigned long long target = cycles + 2;
+        cycle_requested = true;
+        wake.notify_one();
+        cycle_done.wait(lock, [&] { return cycles >= target || stopping; });
+    }
+
+    void set_policy(LogOverflowPolicy p) {
+        policy.store(p, std::memory_order_relaxed);
+    }
+
+    unsigned long long dropped_count() const {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::mutex rings_mutex;  // só para registrar e liberar buffers
+    std::vector<Ring*> rings;
+
+    std::mutex wake_mutex;
+    std::condition_variable wake;
+    std::condition_variable cycle_done;
+    bool cycle_requested = false;
+    bool stopping = false;
+    unsigned long long cycles = 0;
+
+    std::atomic<LogOverflowPolicy> policy{LogOverflowPolicy::BLOCK};
+    std::atomic<unsigned long long> dropped{0};
+    unsigned long long dropped_reported = 0;
+
+    char component[COMPONENT_MAX] = {};
+    unsigned component_seen = ~0u;
+    TimestampCache timestamps;
+    std::string batch;
+
+    std::chrono::seconds summary_interval{DEFAULT_SUMMARY_INTERVAL};
+    std::chrono::steady_clock::time_point next_summary;
+
+    std::thread writer;
+
+    AsyncBackend() {
+        const char* env = std::getenv("LOG_OVERFLOW");
+        if (env && std::strcmp(env, "drop") == 0) {
+            policy.store(LogOverflowPolicy::DROP);
+        }
+
+        if (const char* interval = std::getenv("LOG_SUMMARY_INTERVAL")) {
+            long seconds = std::strtol(interval, nullptr, 10);
+            if (seconds > 0) {
+                summary_interval = std::chrono::seconds(seconds);
+            }
+        }
+        next_summary = std::chrono::steady_clock::now() + summary_interval;
+
+        batch.reserve(64 * 1024);
+        writer = std::thread(&AsyncBackend::run, this);
+        backend_alive.store(true, std::memory_order_release);
+    }
+
+    ~AsyncBackend() {
+        backend_alive.store(false, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        writer.join();
+
+        // Buffers de threads ainda vivas não são liberados: elas podem
+        // estar no meio de um push. O processo está terminando de qualquer forma
+    }
+
+    Ring& local_ring() {
+        if (!thread_ring.ring) {
+            Ring* ring = new Ring();
+            std::lock_guard<std::mutex> lock(rings_mutex);
+            rings.push_back(ring);
+            thread_ring.ring = ring;
+        }
+        return *thread_ring.ring;
+    }
+
+    void request_cycle() {
+        std::lock_guard<std::mutex> lock(wake_mutex);
+        cycle_requested = true;
+        wake.notify_one();
+    }
+
+    void refresh_component() {
+        unsigned version = component_version.load(std::memory_order_acquire);
+        if (version != component_seen) {
+            std::lock_guard<std::mutex> lock(component_mutex);
+            std::memcpy(component, component_name, COMPONENT_MAX);
+            component_seen = version;
+        }
+    }
+
+    // Esvazia todos os buffers no lote; retorna o número de linhas
+    size_t drain() {
+        size_t lines = 0;
+        refresh_component();
+
+        std::lock_guard<std::mutex> lock(rings_mutex);
+        for (auto it = rings.begin(); it != rings.end();) {
+            Ring* ring = *it;
+
+            // Lido antes de head: após marcar órfão a thread não grava mais
+            bool orphaned = ring->orphaned.load(std::memory_order_acquire);
+            size_t tail = ring->tail.load(std::memory_order_relaxed);
+            size_t head = ring->head.load(std::memory_order_acquire);
+
+            for (; tail != head; tail++) {
+                const Record& record = ring->slots[tail & (RING_CAPACITY - 1)];
+                const char* text = record.length <= INLINE_TEXT ? record.text : record.long_text.data();
+                format_line(batch, timestamps, component, record.level, record.timestamp_ms,
+                            text, record.length);
+                lines++;
+            }
+            ring->tail.store(tail, std::memory_order_release);
+
+            if (orphaned) {
+                delete ring;
+                it = rings.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        unsigned long long total_dropped = dropped.load(std::memory_order_relaxed);
+        if (total_dropped != dropped_reported) {
+            std::string notice = std::to_string(total_dropped - dropped_reported) +
+                                 " linhas de log descartadas (buffer cheio)";
+            format_line(batch, timestamps, component, LogLevel::WARNING, now_ms(),
+                        notice.data(), notice.size());
+            dropped_reported = total_dropped;
+        }
+
+        return lines;
+    }
+
+    // Linhas de resumo: mensagens suprimidas por ponto e acessos por rota
+    void summarize() {
+        char text[FORMAT_BUFFER];
+        long long interval = static_cast<long long>(summary_interval.count());
+
+        for (LogSite* site = log_sites.load(std::memory_order_acquire); site; site = site->next) {
+            unsigned long long suppressed = site->suppressed.exchange(0, std::memory_order_relaxed);
+            if (suppressed == 0 || !Logger::enabled(site->level)) {
+                continue;
+            }
+            int length = std::snprintf(text, sizeof(text),
+                                       "%llu mensagens suprimidas em %s:%d nos últimos %lld s",
+                                       suppressed, base_name(site->file), site->line, interval);
+            format_line(batch, timestamps, component, site->level, now_ms(), text,
+                        std::min(static_cast<size_t>(length), sizeof(text) - 1));
+        }
+
+        if (!Logger::enabled(LogLevel::INFO)) {
+            return;
+        }
+        for (AccessLog* log = access_logs.load(std::memory_order_acquire); log; log = log->next) {
+            unsigned long long requests = log->requests.exchange(0, std::memory_order_relaxed);
+            if (requests == 0) {
+                continue;
+            }
+            unsigned long long errors = log->errors.exchange(0, std::memory_order_relaxed);
+            unsigned long long bytes = log->bytes_total.exchange(0, std::memory_order_relaxed);
+            unsigned long long total_us = log->total_us.exchange(0, std::memory_order_relaxed);
+            unsigned long long max_us = log->max_us.exchange(0, std::memory_order_relaxed);
+
+            int length = std::snprintf(text, sizeof(text),
+                                       "Acesso %s: %llu requisições (%llu erros) em %lld s, "
+                                       "média %.1f ms, máx %.1f ms, %llu bytes",
+                                       log->route, requests, errors, interval,
+                                       total_us / 1000.0 / requests, max_us / 1000.0, bytes);
+            format_line(batch, timestamps, component, LogLevel::INFO, now_ms(), text,
+                        std::min(static_cast<size_t>(length), sizeof(text) - 1));
+        }
+    }
+
+    void write_batch() {
+        if (batch.empty()) {
+            return;
+        }
+        std::fwrite(batch.data(), 1, batch.size(), stdout);
+        std::fflush(stdout);
+        batch.clear();
+    }
+
+    void run() {
+        while (true) {
+            size_t lines = drain();
+
+            auto now = std::chrono::steady_clock::now();
+            if (now >= next_summary) {
+                summarize();
+                next_summary = now + summary_interval;
+            }
+            write_batch();
+
+            std::unique_lock<std::mutex> lock(wake_mutex);
+            cycles++;
+            cycle_done.notify_all();
+
+            if (stopping && lines == 0) {
+                break;
+            }
+            if (lines == 0 && !cycle_requested) {
+                wake.wait_for(lock, WRITER_INTERVAL, [this] { return cycle_requested || stopping; });
+            }
+            cycle_requested = false;
+        }
+    }
+};
+
+// Escrita síncrona para linhas emitidas fora da vida do backend
+void write_direct(LogLevel level, const char* text, size_t length) {
+    std::string line;
+    TimestampCache timestamps;
+    std::lock_guard<std::mutex> lock(component_mutex);
+    format_line(line, timestamps, component_name, level, now_ms(), text, length);
+    std::fwrite(line.data(), 1, line.size(), stdout);
+    std::fflush(stdout);
+}
+
+} // namespace
+
+void Logger::set_component_name(const std::string& name) {
+    std::lock_guard<std::mutex> lock(component_mutex);
+    size_t length = std::min(name.size(), COMPONENT_MAX - 1);
+    std::memcpy(component_name, name.data(), length);
+    component_name[length] = '\0';
+    component_version.fetch_add(1, std::memory_order_release);
+}
+
+void Logger::set_log_level(LogLevel level) {
+    current_level.store(level, std::memory_order_relaxed);
+}
+
+void Logger::set_overflow_policy(LogOverflowPolicy policy) {
+    AsyncBackend::instance().set_policy(policy);
+}
+
+void Logger::flush() {
+    if (backend_alive.load(std::memory_order_acquire)) {
+        AsyncBackend::instance().flush();
+    }
+}
+
+unsigned long long Logger::dropped_count() {
+    return AsyncBackend::instance().dropped_count();
+}
+
+void Logger::log_text(LogLevel level, const char* text, size_t length) {
+    // Primeira chamada constrói o backend; depois da destruição, escrita direta
+    static AsyncBackend& backend = AsyncBackend::instance();
+    if (!backend_alive.load(std::memory_order_acquire)) {
+        write_direct(level, text, length);
+        return;
+    }
+
+    backend.push(level, text, length);
+}
+
+void Logger::log_format(LogLevel level, const char* format, va_list args) {
+    char buffer[FORMAT_BUFFER];
+
+    va_list retry;
+    va_copy(retry, args);
+    int length = std::vsnprintf(buffer, sizeof(buffer), format, args);
+
+    if (length < 0) {
+        log_text(level, format, std::strlen(format));
+    } else if (static_cast<size_t>(length) < sizeof(buffer)) {
+        log_text(level, buffer, static_cast<size_t>(length));
+    } else {
+        // Só mensagens longas (ex.: corpos de requisição) chegam ao heap
+        std::string large(static_cast<size_t>(length), '\0');
+        std::vsnprintf(&large[0], large.size() + 1, format, retry);
+        log_text(level, large.data(), large.size());
+    }
+    va_end(retry);
+}
+
 void Logger::log(LogLevel level, const std::string& message) {
-    if (level < current_level) {
+    if (enabled(level)) {
+        log_text(level, message.data(), message.size());
+    }
+}
+
+#if LOG_MIN_LEVEL <= 0
+void Logger::debug_f(const char* format, ...) {
+    if (!enabled(LogLevel::DEBUG)) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    log_format(LogLevel::DEBUG, format, args);
+    va_end(args);
+}
+#endif
+
+#if LOG_MIN_LEVEL <= 1
+void Logger::info_f(const char* format, ...) {
+    if (!enabled(LogLevel::INFO)) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    log_format(LogLevel::INFO, format, args);
+    va_end(args);
+}
+#endif
+
+#if LOG_MIN_LEVEL <= 2
+void Logger::warning_f(const char* format, ...) {
+    if (!enabled(LogLevel::WARNING)) {
         return;
     }
-    
-    std::lock_guard<std::mutex> lock(log_mutex);
-    
-    std::cout << get_color_code(level) 
-              << "[" << get_timestamp() << "]"
-              << "[" << level_to_string(level) << "]"
-              << "[" << component_name << "] "
-              << message 
-              << get_reset_color() 
-              << std::endl;
+    va_list args;
+    va_start(args, format);
+    log_format(LogLevel::WARNING, format, args);
+    va_end(args);
+}
+#endif
+
+void Logger::log_f(LogLevel level, const char* format, ...) {
+    if (!enabled(level)) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    log_format(level, format, args);
+    va_end(args);
+}
+
+void Logger::set_access_summary(bool enabled) {
+    access_mode.store(enabled ? 1 : 0, std::memory_order_relaxed);
+}
+
+bool Logger::access_summary() {
+    int mode = access_mode.load(std::memory_order_relaxed);
+    if (mode < 0) {
+        const char* env = std::getenv("LOG_ACCESS");
+        mode = (env && std::strcmp(env, "summary") == 0) ? 1 : 0;
+        access_mode.store(mode, std::memory_order_relaxed);
+    }
+    return mode == 1;
+}
+
+void Logger::error_f(const char* format, ...) {
+    if (!enabled(LogLevel::ERROR)) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    log_format(LogLevel::ERROR, format, args);
+    va_end(args);
 }
 
 void Logger::debug(const std::string& message) {
@@ -82,4 +569,74 @@ void Logger::warning(const std::string& message) {
 
 void Logger::error(const std::string& message) {
     log(LogLevel::ERROR, message);
-}
\ No newline at end of file
+}
+
+LogSite::LogSite(const char* source_file, int source_line, LogLevel site_level)
+    : file(source_file), line(source_line), level(site_level) {
+    next = log_sites.load(std::memory_order_relaxed);
+    while (!log_sites.compare_exchange_weak(next, this, std::memory_order_release,
+                                            std::memory_order_relaxed)) {
+    }
+}
+
+bool LogSite::sample(unsigned every_n) {
+    if (every_n <= 1 || calls.fetch_add(1, std::memory_order_relaxed) % every_n == 0) {
+        return true;
+    }
+    suppressed.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+bool LogSite::admit(double per_second) {
+    if (per_second <= 0.0) {
+        suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // Cada mensagem empurra o "horário teórico" em um intervalo; passa
+    // enquanto ele não estiver mais de uma rajada à frente do relógio
+    long long interval = static_cast<long long>(1e9 / per_second);
+    long long burst = interval * std::max(1LL, static_cast<long long>(per_second));
+    long long now = steady_ns();
+
+    long long arrival = theoretical_arrival_ns.load(std::memory_order_relaxed);
+    while (true) {
+        long long base = std::max(arrival, now);
+        if (base - now >= burst) {
+            suppressed.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        if (theoretical_arrival_ns.compare_exchange_weak(arrival, base + interval,
+                                                         std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+}
+
+AccessLog::AccessLog(const char* route_name) : route(route_name) {
+    next = access_logs.load(std::memory_order_relaxed);
+    while (!access_logs.compare_exchange_weak(next, this, std::memory_order_release,
+                                              std::memory_order_relaxed)) {
+    }
+}
+
+void AccessLog::record(int status, std::chrono::steady_clock::duration elapsed, size_t bytes) {
+    auto us = static_cast<unsigned long long>(
+        std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+
+    if (!Logger::access_summary()) {
+        Logger::info_f("%s %d %.1f ms %zu bytes", route, status, us / 1000.0, bytes);
+        return;
+    }
+
+    requests.fetch_add(1, std::memory_order_relaxed);
+    if (status >= 400) {
+        errors.fetch_add(1, std::memory_order_relaxed);
+    }
+    bytes_total.fetch_add(bytes, std::memory_order_relaxed);
+    total_us.fetch_add(us, std::memory_order_relaxed);
+
+    unsigned long long current = max_us.load(std::memory_order_relaxed);
+    while (us > current && !max_us.compare_exchange_weak(current, us, std::memory_order_relaxed)) {
+    }
+}
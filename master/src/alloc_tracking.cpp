@@ -0,0 +1,164 @@
+#include "alloc_tracking.h"
+#include <cstdlib>
+#include <new>
+
+// Só entra no build com ENABLE_ALLOC_TRACKING (ver CMakeLists.txt)
+#ifdef ALLOC_TRACKING
+
+namespace {
+
+// POD com inicialização estática: acessível dentro de operator new sem
+// disparar a inicialização dinâmica de thread_local (que poderia alocar)
+struct ThreadCounts {
+    uint64_t allocations;
+    uint64_t bytes;
+    uint64_t frees;
+};
+
+thread_local ThreadCounts thread_totals = {0, 0, 0};
+
+inline void* tracked_alloc(std::size_t size) {
+    void* pointer = std::malloc(size ? size : 1);
+    if (pointer) {
+        thread_totals.allocations++;
+        thread_totals.bytes += size;
+    }
+    return pointer;
+}
+
+inline void* tracked_aligned_alloc(std::size_t size, std::align_val_t alignment) {
+    std::size_t align = static_cast<std::size_t>(alignment);
+    if (align < sizeof(void*)) {
+        align = sizeof(void*);
+    }
+    void* pointer = nullptr;
+    if (posix_memalign(&pointer, align, size ? size : 1) != 0) {
+        return nullptr;
+    }
+    thread_totals.allocations++;
+    thread_totals.bytes += size;
+    return pointer;
+}
+
+inline void tracked_free(void* pointer) {
+    if (pointer) {
+        thread_totals.frees++;
+        std::free(pointer);
+    }
+}
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    void* pointer = tracked_alloc(size);
+    if (!pointer) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return tracked_alloc(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return tracked_alloc(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    void* pointer = tracked_aligned_alloc(size, alignment);
+    if (!pointer) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return tracked_aligned_alloc(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return tracked_aligned_alloc(size, alignment);
+}
+
+void operator delete(void* pointer) noexcept { tracked_free(pointer); }
+void operator delete[](void* pointer) noexcept { tracked_free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { tracked_free(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { tracked_free(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { tracked_free(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { tracked_free(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { tracked_free(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { tracked_free(pointer); }
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept { tracked_free(pointer); }
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept { tracked_free(pointer); }
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { tracked_free(pointer); }
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { tracked_free(pointer); }
+
+namespace alloc_tracking {
+
+static Counts operator-(const Counts& a, const Counts& b) {
+    Counts delta;
+    delta.allocations = a.allocations - b.allocations;
+    delta.bytes = a.bytes - b.bytes;
+    delta.frees = a.frees - b.frees;
+    return delta;
+}
+
+Counts thread_counts() {
+    Counts counts;
+    counts.allocations = thread_totals.allocations;
+    counts.bytes = thread_totals.bytes;
+    counts.frees = thread_totals.frees;
+    return counts;
+}
+
+Endpoint::Endpoint(const std::string& route)
+    : allocations(metrics::registry().counter("allocations_total",
+                                              "Alocações com operator new durante as requisições",
+                                              "route=\"" + route + "\"")),
+      bytes(metrics::registry().counter("allocated_bytes_total",
+                                        "Bytes pedidos ao operator new durante as requisições",
+                                        "route=\"" + route + "\"")),
+      frees(metrics::registry().counter("deallocations_total",
+                                        "Liberações com operator delete durante as requisições",
+                                        "route=\"" + route + "\"")) {}
+
+void Endpoint::add(const Counts& counts) {
+    allocations.add(counts.allocations);
+    bytes.add(counts.bytes);
+    frees.add(counts.frees);
+}
+
+Scope::Scope(Endpoint& target) : endpoint(target), start(thread_counts()) {}
+
+Scope::~Scope() {
+    Counts total = thread_counts() - start;
+    total.allocations += adopted_allocations.load(std::memory_order_relaxed);
+    total.bytes += adopted_bytes.load(std::memory_order_relaxed);
+    total.frees += adopted_frees.load(std::memory_order_relaxed);
+    endpoint.add(total);
+}
+
+void Scope::add(const Counts& counts) {
+    adopted_allocations.fetch_add(counts.allocations, std::memory_order_relaxed);
+    adopted_bytes.fetch_add(counts.bytes, std::memory_order_relaxed);
+    adopted_frees.fetch_add(counts.frees, std::memory_order_relaxed);
+}
+
+Adopt::Adopt(Scope& target) : scope(target), start(thread_counts()) {}
+
+Adopt::~Adopt() {
+    scope.add(thread_counts() - start);
+}
+
+} // namespace alloc_tracking
+
+#endif
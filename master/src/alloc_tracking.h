@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "metrics.h"
+
+// Contabilidade de alocações (build com -DENABLE_ALLOC_TRACKING=ON).
+//
+// Nesse modo, operator new/delete globais são substituídos por versões que
+// contam alocações, bytes pedidos e liberações em contadores thread_local,
+// sem lock e sem alocar. Um Scope atribui o que a thread alocou durante o
+// escopo a um endpoint, exportado em /metrics; threads auxiliares da mesma
+// requisição (ex.: std::async) entram no escopo com Adopt.
+//
+// No build normal as classes abaixo são vazias e as chamadas somem.
+namespace alloc_tracking {
+
+struct Counts {
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+    uint64_t frees = 0;
+};
+
+#ifdef ALLOC_TRACKING
+
+constexpr bool enabled() { return true; }
+
+// Totais da thread atual desde que ela começou
+Counts thread_counts();
+
+// Contadores de um endpoint (criar uma vez, normalmente estático)
+class Endpoint {
+public:
+    explicit Endpoint(const std::string& route);
+
+    void add(const Counts& counts);
+
+private:
+    metrics::Counter& allocations;
+    metrics::Counter& bytes;
+    metrics::Counter& frees;
+};
+
+class Scope {
+public:
+    explicit Scope(Endpoint& endpoint);
+    ~Scope();
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+    // Soma alocações feitas em outra thread em nome deste escopo
+    void add(const Counts& counts);
+
+private:
+    Endpoint& endpoint;
+    Counts start;
+    std::atomic<uint64_t> adopted_allocations{0};
+    std::atomic<uint64_t> adopted_bytes{0};
+    std::atomic<uint64_t> adopted_frees{0};
+};
+
+// Atribui as alocações da thread atual, até o fim do escopo, a um Scope
+// de outra thread (que precisa durar mais que este objeto)
+class Adopt {
+public:
+    explicit Adopt(Scope& scope);
+    ~Adopt();
+
+    Adopt(const Adopt&) = delete;
+    Adopt& operator=(const Adopt&) = delete;
+
+private:
+    Scope& scope;
+    Counts start;
+};
+
+#else
+
+constexpr bool enabled() { return false; }
+
+inline Counts thread_counts() { return {}; }
+
+class Endpoint {
+public:
+    explicit Endpoint(const std::string&) {}
+    void add(const Counts&) {}
+};
+
+class Scope {
+public:
+    explicit Scope(Endpoint&) {}
+    void add(const Counts&) {}
+};
+
+class Adopt {
+public:
+    explicit Adopt(Scope&) {}
+};
+
+#endif
+
+} // namespace alloc_tracking
@@ -0,0 +1,120 @@
+#include "concurrency_limiter.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Peso das médias móveis de RTT
+    constexpr double LONG_RTT_ALPHA = 0.01;
+    constexpr double SHORT_RTT_ALPHA = 0.2;
+
+    // Quanto acima da base o RTT pode ficar antes de reduzir o limite
+    constexpr double RTT_TOLERANCE = 1.5;
+
+    // Suavização das mudanças do limite
+    constexpr double LIMIT_SMOOTHING = 0.2;
+
+    // Decréscimo multiplicativo em falhas
+    constexpr double FAILURE_BACKOFF = 0.9;
+}
+
+ConcurrencyLimiter::ConcurrencyLimiter(int initial_limit, int min_limit, int max_limit)
+    : current_limit(initial_limit), min_limit(min_limit), max_limit(max_limit),
+      published_limit(initial_limit) {}
+
+bool ConcurrencyLimiter::try_acquire() {
+    int current = inflight.load();
+    while (current < published_limit.load()) {
+        if (inflight.compare_exchange_weak(current, current + 1)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ConcurrencyLimiter::acquire(std::chrono::milliseconds max_wait) {
+    if (try_acquire()) {
+        return true;
+    }
+
+    // Caminho lento: sem vaga, aguardar uma liberação
+    std::unique_lock<std::mutex> lock(mutex);
+    return available.wait_for(lock, max_wait, [this]() { return try_acquire(); });
+}
+
+void ConcurrencyLimiter::release(std::chrono::microseconds rtt, bool success) {
+    // Ocupação contando esta chamada: com `limit` chamadas em voo o limite
+    // estava todo em uso, mesmo que esta já tenha terminado
+    int used = inflight.fetch_sub(1);
+    bool grew;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        int previous = published_limit.load();
+        if (success) {
+            update_limit(static_cast<double>(rtt.count()), used);
+        } else {
+            current_limit = std::max<double>(min_limit, current_limit * FAILURE_BACKOFF);
+        }
+        published_limit.store(static_cast<int>(current_limit));
+        grew = published_limit.load() > previous;
+    }
+    // Limite maior abre mais de uma vaga: acordar todos para disputá-las
+    if (grew) {
+        available.notify_all();
+    } else {
+        available.notify_one();
+    }
+}
+
+void ConcurrencyLimiter::update_limit(double rtt_us, int used) {
+    rtt_us = std::max(rtt_us, 1.0);
+
+    if (long_rtt_us == 0.0) {
+        long_rtt_us = rtt_us;
+        short_rtt_us = rtt_us;
+        return;
+    }
+
+    short_rtt_us += (rtt_us - short_rtt_us) * SHORT_RTT_ALPHA;
+    long_rtt_us += (rtt_us - long_rtt_us) * LONG_RTT_ALPHA;
+
+    // Se a base ficou muito acima da latência atual (ex.: após uma fase de
+    // sobrecarga), aproxima-a rapidamente para não inflar o limite
+    if (long_rtt_us > short_rtt_us * 2.0) {
+        long_rtt_us = short_rtt_us * 2.0;
+    }
+
+    // Só cresce quando o limite está sendo realmente usado
+    if (used < current_limit / 2.0) {
+        return;
+    }
+
+    double gradient = std::clamp(RTT_TOLERANCE * long_rtt_us / short_rtt_us, 0.5, 1.0);
+    double queue_size = std::sqrt(current_limit);
+    double new_limit = current_limit * gradient + queue_size;
+
+    current_limit = current_limit * (1.0 - LIMIT_SMOOTHING) + new_limit * LIMIT_SMOOTHING;
+    current_limit = std::clamp<double>(current_limit, min_limit, max_limit);
+}
+
+int ConcurrencyLimiter::limit() const {
+    return published_limit.load();
+}
+
+int ConcurrencyLimiter::in_flight() const {
+    return inflight.load();
+}
+
+int ConcurrencyLimiter::headroom() const {
+    return published_limit.load() - inflight.load();
+}
+
+double ConcurrencyLimiter::baseline_rtt_ms() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return long_rtt_us / 1000.0;
+}
+
+double ConcurrencyLimiter::recent_rtt_ms() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return short_rtt_us / 1000.0;
+}
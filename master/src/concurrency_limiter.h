@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+// Limite adaptativo de concorrência para chamadas a um escravo.
+//
+// O limite é ajustado por gradiente de RTT: enquanto a latência observada
+// fica próxima da linha de base o limite cresce; quando o escravo começa a
+// enfileirar (RTT acima da base) o limite é reduzido proporcionalmente.
+// Falhas e timeouts aplicam um decréscimo multiplicativo.
+//
+// Reserva e leitura do limite e da ocupação usam apenas atômicos. A
+// liberação toma o mutex para ajustar o limite com o RTT da chamada; ele
+// também protege as médias de RTT e a espera quando não há vaga.
+class ConcurrencyLimiter {
+public:
+    ConcurrencyLimiter(int initial_limit = 20, int min_limit = 2, int max_limit = 200);
+
+    // Tenta reservar uma vaga sem bloquear (sem lock)
+    bool try_acquire();
+
+    // Aguarda no máximo max_wait por uma vaga
+    bool acquire(std::chrono::milliseconds max_wait);
+
+    // Libera a vaga e alimenta o algoritmo com o RTT da chamada
+    void release(std::chrono::microseconds rtt, bool success);
+
+    // Estado atual (para roteamento e /health)
+    int limit() const;
+    int in_flight() const;
+    int headroom() const;
+    double baseline_rtt_ms() const;
+    double recent_rtt_ms() const;
+
+private:
+    mutable std::mutex mutex;
+    std::condition_variable available;
+
+    // Protegido pelo mutex; published_limit é a cópia lida sem lock
+    double current_limit;
+    const int min_limit;
+    const int max_limit;
+
+    std::atomic<int> published_limit;
+    std::atomic<int> inflight{0};
+
+    // RTT de longo prazo (linha de base) e de curto prazo, em microssegundos
+    double long_rtt_us = 0.0;
+    double short_rtt_us = 0.0;
+
+    // used: chamadas em voo no término desta, incluindo ela
+    void update_limit(double rtt_us, int used);
+};
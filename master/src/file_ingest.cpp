@@ -0,0 +1,352 @@
+#include "file_ingest.h"
+#include "logger.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef HAVE_LIBURING
+#include <liburing.h>
+#include <sys/uio.h>
+#endif
+
+namespace file_ingest {
+
+// Tamanho de cada leitura e quantas ficam em voo por arquivo
+static constexpr size_t READ_BLOCK_SIZE = 1024 * 1024;
+static constexpr unsigned QUEUE_DEPTH = 8;
+
+// Alinhamento dos buffers (página)
+static constexpr size_t BUFFER_ALIGNMENT = 4096;
+
+// Buffers alinhados de READ_BLOCK_SIZE, liberados com free()
+struct AlignedBuffers {
+    std::vector<char*> blocks;
+
+    explicit AlignedBuffers(size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            void* memory = nullptr;
+            if (posix_memalign(&memory, BUFFER_ALIGNMENT, READ_BLOCK_SIZE) != 0) {
+                throw std::bad_alloc();
+            }
+            blocks.push_back(static_cast<char*>(memory));
+        }
+    }
+
+    ~AlignedBuffers() {
+        for (char* block : blocks) {
+            std::free(block);
+        }
+    }
+
+    AlignedBuffers(const AlignedBuffers&) = delete;
+    AlignedBuffers& operator=(const AlignedBuffers&) = delete;
+};
+
+// Fecha o descritor em qualquer saída
+struct FileDescriptor {
+    int fd;
+    explicit FileDescriptor(int descriptor) : fd(descriptor) {}
+    ~FileDescriptor() {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+    int release() {
+        int descriptor = fd;
+        fd = -1;
+        return descriptor;
+    }
+};
+
+File::File(const std::string& root, const std::string& relative) : fd(-1), length(0) {
+    if (relative.empty() || relative[0] == '/') {
+        throw std::invalid_argument("Caminho deve ser relativo à raiz de ingestão");
+    }
+
+    FileDescriptor current(open(root.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC));
+    if (current.fd < 0) {
+        throw std::runtime_error("Não foi possível abrir a raiz de ingestão: " + std::string(std::strerror(errno)));
+    }
+
+    // Cada componente é aberto relativo ao diretório anterior, sem seguir
+    // links: não há caminho resolvido que possa mudar até a abertura
+    size_t start = 0;
+    for (;;) {
+        size_t end = relative.find('/', start);
+        bool last = end == std::string::npos;
+        std::string name = relative.substr(start, last ? std::string::npos : end - start);
+        start = end + 1;
+
+        if (name == "..") {
+            throw std::invalid_argument("Caminho fora da raiz de ingestão: " + relative);
+        }
+        if ((name.empty() || name == ".") && !last) {
+            continue;
+        }
+
+        // O_NONBLOCK só evita travar na abertura de um FIFO; não muda a
+        // leitura de arquivos regulares
+        int flags = O_RDONLY | O_CLOEXEC | O_NOFOLLOW | (last ? O_NONBLOCK : O_DIRECTORY);
+        FileDescriptor next(openat(current.fd, name.empty() ? "." : name.c_str(), flags));
+        if (next.fd < 0) {
+            // O lstat aqui só escolhe a mensagem; a recusa já veio do openat
+            struct stat link;
+            if ((errno == ELOOP || errno == ENOTDIR) &&
+                fstatat(current.fd, name.c_str(), &link, AT_SYMLINK_NOFOLLOW) == 0 && S_ISLNK(link.st_mode)) {
+                throw std::invalid_argument("Links simbólicos não são aceitos: " + relative);
+            }
+            throw std::invalid_argument("Arquivo não encontrado: " + relative);
+        }
+        std::swap(current.fd, next.fd);
+        if (last) {
+            break;
+        }
+    }
+
+    struct stat info;
+    if (fstat(current.fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        throw std::invalid_argument("Não é um arquivo regular: " + relative);
+    }
+    length = static_cast<uint64_t>(info.st_size);
+    fd = current.release();
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+}
+
+File::~File() {
+    close(fd);
+}
+
+static ReadStats read_with_pread(int fd, uint64_t start, uint64_t end, const ChunkHandler& on_chunk) {
+    ReadStats stats;
+    stats.method = "pread";
+    stats.max_in_flight = 1;
+
+    AlignedBuffers buffer(1);
+    uint64_t offset = start;
+    while (offset < end) {
+        size_t length = static_cast<size_t>(std::min<uint64_t>(READ_BLOCK_SIZE, end - offset));
+        ssize_t n = pread(fd, buffer.blocks[0], length, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            throw std::runtime_error(std::string("Erro de leitura: ") + std::strerror(errno));
+        }
+        if (n == 0) {
+            throw std::runtime_error("Arquivo encolheu durante a leitura");
+        }
+        stats.reads++;
+        on_chunk(offset, buffer.blocks[0], static_cast<size_t>(n));
+        offset += static_cast<uint64_t>(n);
+    }
+    return stats;
+}
+
+#ifdef HAVE_LIBURING
+
+// Anel com seus buffers; registrar os buffers fixa as páginas uma vez só,
+// e o kernel não precisa mapeá-las a cada leitura
+class UringReader {
+public:
+    UringReader() : buffers(QUEUE_DEPTH) {
+        int error = io_uring_queue_init(QUEUE_DEPTH, &ring, 0);
+        if (error < 0) {
+            throw std::runtime_error(std::string("io_uring indisponível: ") + std::strerror(-error));
+        }
+
+        std::vector<iovec> iovecs(QUEUE_DEPTH);
+        for (unsigned i = 0; i < QUEUE_DEPTH; i++) {
+            iovecs[i].iov_base = buffers.blocks[i];
+            iovecs[i].iov_len = READ_BLOCK_SIZE;
+        }
+        // Pode falhar por RLIMIT_MEMLOCK em kernels antigos: segue sem registro
+        registered = io_uring_register_buffers(&ring, iovecs.data(), QUEUE_DEPTH) == 0;
+    }
+
+    ~UringReader() {
+        io_uring_queue_exit(&ring);
+    }
+
+    UringReader(const UringReader&) = delete;
+    UringReader& operator=(const UringReader&) = delete;
+
+    // Lê o intervalo [start, end) do arquivo
+    ReadStats read(int fd, uint64_t start, uint64_t end, const ChunkHandler& on_chunk);
+
+private:
+    // Leitura em voo no buffer `index`
+    struct Pending {
+        uint64_t offset = 0;
+        size_t length = 0;
+        size_t done = 0;
+    };
+
+    void submit(int fd, unsigned index, const Pending& pending);
+
+    io_uring ring;
+    AlignedBuffers buffers;
+    bool registered = false;
+};
+
+void UringReader::submit(int fd, unsigned index, const Pending& pending) {
+    io_uring_sqe* sqe = io_uring_get_sqe(&ring);
+    char* target = buffers.blocks[index] + pending.done;
+    unsigned length = static_cast<unsigned>(pending.length - pending.done);
+    uint64_t offset = pending.offset + pending.done;
+
+    if (registered) {
+        io_uring_prep_read_fixed(sqe, fd, target, length, offset, static_cast<int>(index));
+    } else {
+        io_uring_prep_read(sqe, fd, target, length, offset);
+    }
+    io_uring_sqe_set_data(sqe, reinterpret_cast<void*>(static_cast<uintptr_t>(index)));
+}
+
+ReadStats UringReader::read(int fd, uint64_t start, uint64_t end, const ChunkHandler& on_chunk) {
+    ReadStats stats;
+    stats.method = registered ? "io_uring_fixed" : "io_uring";
+
+    std::vector<Pending> pending(QUEUE_DEPTH);
+    std::vector<unsigned> free_buffers;
+    for (unsigned i = QUEUE_DEPTH; i > 0; i--) {
+        free_buffers.push_back(i - 1);
+    }
+
+    uint64_t next_offset = start;
+    size_t in_flight = 0;
+    std::string error;
+
+    while ((error.empty() && next_offset < end) || in_flight > 0) {
+        // Completa a fila com os próximos blocos
+        while (error.empty() && next_offset < end && !free_buffers.empty()) {
+            unsigned index = free_buffers.back();
+            free_buffers.pop_back();
+
+            Pending& block = pending[index];
+            block.offset = next_offset;
+            block.length = static_cast<size_t>(std::min<uint64_t>(READ_BLOCK_SIZE, end - next_offset));
+            block.done = 0;
+            submit(fd, index, block);
+
+            next_offset += block.length;
+            in_flight++;
+            stats.reads++;
+        }
+        stats.max_in_flight = std::max(stats.max_in_flight, in_flight);
+
+        int submitted = io_uring_submit_and_wait(&ring, 1);
+        if (submitted < 0 && submitted != -EINTR) {
+            // Sem submissão não há como esperar as leituras já em voo
+            throw std::runtime_error(std::string("io_uring_submit: ") + std::strerror(-submitted));
+        }
+
+        io_uring_cqe* cqe = nullptr;
+        while (io_uring_peek_cqe(&ring, &cqe) == 0) {
+            unsigned index = static_cast<unsigned>(reinterpret_cast<uintptr_t>(io_uring_cqe_get_data(cqe)));
+            int result = cqe->res;
+            io_uring_cqe_seen(&ring, cqe);
+            Pending& block = pending[index];
+
+            if (result == -EINTR || result == -EAGAIN) {
+                submit(fd, index, block);
+                stats.reads++;
+                continue;
+            }
+
+            in_flight--;
+            if (result <= 0) {
+                // Depois de um erro só esperamos as leituras em voo: os
+                // buffers não podem ser liberados com o kernel escrevendo
+                if (error.empty()) {
+                    error = result < 0 ? std::string("Erro de leitura: ") + std::strerror(-result)
+                                       : "Arquivo encolheu durante a leitura";
+                }
+                free_buffers.push_back(index);
+                continue;
+            }
+
+            block.done += static_cast<size_t>(result);
+            if (block.done < block.length && error.empty()) {
+                // Leitura curta: pede o restante no mesmo buffer
+                submit(fd, index, block);
+                in_flight++;
+                stats.reads++;
+                continue;
+            }
+
+            if (error.empty()) {
+                on_chunk(block.offset, buffers.blocks[index], block.done);
+            }
+            free_buffers.push_back(index);
+        }
+    }
+
+    if (!error.empty()) {
+        throw std::runtime_error(error);
+    }
+    return stats;
+}
+
+// Anéis livres, reaproveitados entre requisições (no máximo MAX_IDLE_READERS)
+static constexpr size_t MAX_IDLE_READERS = 4;
+static std::mutex readers_mutex;
+static std::vector<std::unique_ptr<UringReader>> idle_readers;
+static bool uring_unavailable = false;
+
+static std::unique_ptr<UringReader> acquire_reader() {
+    {
+        std::lock_guard<std::mutex> lock(readers_mutex);
+        if (uring_unavailable) {
+            return nullptr;
+        }
+        if (!idle_readers.empty()) {
+            std::unique_ptr<UringReader> reader = std::move(idle_readers.back());
+            idle_readers.pop_back();
+            return reader;
+        }
+    }
+
+    try {
+        return std::unique_ptr<UringReader>(new UringReader());
+    } catch (const std::exception& e) {
+        // Ex.: kernel antigo ou io_uring bloqueado pelo seccomp do container
+        std::lock_guard<std::mutex> lock(readers_mutex);
+        if (!uring_unavailable) {
+            Logger::warning_f("%s; usando pread em /process/path", e.what());
+            uring_unavailable = true;
+        }
+        return nullptr;
+    }
+}
+
+static void release_reader(std::unique_ptr<UringReader> reader) {
+    std::lock_guard<std::mutex> lock(readers_mutex);
+    if (idle_readers.size() < MAX_IDLE_READERS) {
+        idle_readers.push_back(std::move(reader));
+    }
+}
+
+#endif
+
+ReadStats File::read(uint64_t offset, size_t count, const ChunkHandler& on_chunk) const {
+    uint64_t end = offset + count;
+#ifdef HAVE_LIBURING
+    if (std::unique_ptr<UringReader> reader = acquire_reader()) {
+        // Em erro o anel é descartado (pode ter ficado com estado pendente)
+        ReadStats stats = reader->read(fd, offset, end, on_chunk);
+        release_reader(std::move(reader));
+        return stats;
+    }
+#endif
+
+    return read_with_pread(fd, offset, end, on_chunk);
+}
+
+} // namespace file_ingest
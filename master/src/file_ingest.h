@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <string>
+
+// Leitura de arquivos do volume compartilhado para /process/path.
+//
+// Com liburing (HAVE_LIBURING), o arquivo é lido por io_uring com vários
+// blocos em voo ao mesmo tempo, em buffers registrados no anel
+// (IORING_OP_READ_FIXED; sem registro, leituras comuns nos mesmos
+// buffers). Os anéis são reaproveitados entre requisições. Sem liburing, ou
+// se o kernel/seccomp recusar o io_uring, a leitura é por pread.
+namespace file_ingest {
+
+struct ReadStats {
+    const char* method = "pread";   // "io_uring_fixed", "io_uring" ou "pread"
+    size_t reads = 0;               // leituras submetidas
+    size_t max_in_flight = 0;
+};
+
+// Recebe cada bloco assim que a leitura dele termina (fora de ordem). Não
+// deve lançar exceções: pode haver leituras em voo nos buffers
+using ChunkHandler = std::function<void(uint64_t offset, const char* data, size_t length)>;
+
+// Arquivo regular aberto dentro da raiz de ingestão. O caminho é aberto
+// componente a componente com openat e O_NOFOLLOW a partir de `root` (já
+// resolvida), e tipo e tamanho vêm do próprio descritor: trocar um
+// componente por um link simbólico depois da checagem não leva a leitura
+// para fora da raiz. Lança std::invalid_argument se o caminho for absoluto,
+// tiver "..", passar por um link simbólico ou não for um arquivo regular
+class File {
+public:
+    File(const std::string& root, const std::string& relative);
+    ~File();
+
+    File(const File&) = delete;
+    File& operator=(const File&) = delete;
+
+    uint64_t size() const { return length; }
+
+    // Lê `count` bytes a partir de `offset`; o handler recebe o offset no
+    // arquivo. Lança std::runtime_error em erro de leitura ou se o arquivo
+    // encolher
+    ReadStats read(uint64_t offset, size_t count, const ChunkHandler& on_chunk) const;
+
+private:
+    int fd;
+    uint64_t length;
+};
+
+} // namespace file_ingest
@@ -2,24 +2,77 @@
 #include <csignal>
 #include <atomic>
 #include <thread>
+#include <cstdlib>
+#include <sstream>
 #include "master_server.h"
 #include "logger.h"
+#include "tracing.h"
+#include "traffic_capture.h"
 
 std::atomic<bool> keep_running(true);
-MasterServer* server_instance = nullptr;
+std::atomic<int> received_signal(0);
 
+// Só atômicos aqui: o logger (anel por thread) e o stop() do servidor não
+// são seguros dentro de um handler de sinal. O loop principal loga e para
 void signal_handler(int signal) {
-    Logger::info_f("Sinal recebido: %d", signal);
+    received_signal = signal;
     keep_running = false;
-    if (server_instance) {
-        server_instance->stop();
+}
+
+// Associa cada cliente de uma lista separada por vírgulas a uma classe
+void configure_client_priorities(MasterServer& server, const char* env_name, PriorityClass cls) {
+    const char* value = std::getenv(env_name);
+    if (!value) {
+        return;
+    }
+
+    std::stringstream ss(value);
+    std::string client_id;
+    while (std::getline(ss, client_id, ',')) {
+        if (!client_id.empty()) {
+            server.set_client_priority(client_id, cls);
+        }
+    }
+}
+
+// Adiciona um escravo estático a partir de uma URL "http://host:porta"
+bool add_static_slave(MasterServer& server, const char* env_name, const std::string& name,
+                      const std::string& endpoint, const std::string& type) {
+    const char* value = std::getenv(env_name);
+    if (!value || !*value) {
+        return false;
+    }
+
+    std::string url = value;
+    auto scheme_end = url.find("://");
+    if (scheme_end != std::string::npos) {
+        url = url.substr(scheme_end + 3);
+    }
+    if (!url.empty() && url.back() == '/') {
+        url.pop_back();
     }
+
+    auto colon = url.rfind(':');
+    if (colon == std::string::npos) {
+        Logger::warning_f("%s sem porta: '%s'", env_name, value);
+        return false;
+    }
+
+    try {
+        server.add_slave(name, url.substr(0, colon), std::stoi(url.substr(colon + 1)), endpoint, type);
+    } catch (const std::exception& e) {
+        Logger::warning_f("%s inválido '%s': %s", env_name, value, e.what());
+        return false;
+    }
+    return true;
 }
 
 int main(int argc, char* argv[]) {
     // Configurar logs
     Logger::set_component_name("MASTER");
     Logger::set_log_level(LogLevel::DEBUG);
+    tracing::configure("MASTER");
+    capture::Recorder::instance().configure();
     
     Logger::info("=== INICIANDO SERVIDOR MESTRE ===");
     
@@ -42,11 +95,60 @@ int main(int argc, char* argv[]) {
     try {
         // Criar servidor mestre
         MasterServer server(port);
-        server_instance = &server;
         
-        // Configurar escravos (URLs dos containers Docker)
-        server.add_slave("slave-letters", "slave-letters", 8081, "/letras", "letters");
-        server.add_slave("slave-numbers", "slave-numbers", 8082, "/numeros", "numbers");
+        // Configurar escalonador de prioridades
+        if (const char* slots = std::getenv("MASTER_DISPATCH_SLOTS")) {
+            try {
+                server.set_dispatch_slots(std::stoul(slots));
+            } catch (const std::exception& e) {
+                Logger::warning_f("MASTER_DISPATCH_SLOTS inválido '%s', mantendo padrão", slots);
+            }
+        }
+        // Modo de despacho (push padrão; pull usa workers genéricos)
+        if (const char* mode = std::getenv("MASTER_DISPATCH_MODE")) {
+            server.set_pull_mode(std::string(mode) == "pull");
+        }
+        if (const char* shard = std::getenv("MASTER_SHARD_SIZE")) {
+            try {
+                server.set_shard_size(std::stoul(shard));
+            } catch (const std::exception& e) {
+                Logger::warning_f("MASTER_SHARD_SIZE inválido '%s', mantendo padrão", shard);
+            }
+        }
+
+        // Arquivos do volume compartilhado processados via /process/path
+        if (const char* root = std::getenv("MASTER_INGEST_ROOT")) {
+            if (*root) {
+                server.set_ingest_root(root);
+            }
+        }
+
+        // Estado dos uploads em partes, para retomá-los após um reinício
+        if (const char* dir = std::getenv("MASTER_UPLOAD_DIR")) {
+            if (*dir) {
+                server.set_upload_state_dir(dir);
+            }
+        }
+
+        // Compressão do texto enviado aos escravos (auto, off, gzip ou zstd)
+        if (const char* compression = std::getenv("TRANSPORT_COMPRESSION")) {
+            try {
+                server.set_transport(std::make_shared<HttpSlaveTransport>(
+                    HttpSlaveTransport::parse_compression(compression)));
+            } catch (const std::exception& e) {
+                Logger::warning_f("TRANSPORT_COMPRESSION inválido '%s', mantendo padrão", compression);
+            }
+        }
+
+        configure_client_priorities(server, "MASTER_INTERACTIVE_CLIENTS", PriorityClass::INTERACTIVE);
+        configure_client_priorities(server, "MASTER_BATCH_CLIENTS", PriorityClass::BATCH);
+
+        // Escravos estáticos (opcionais); os demais se registram via /register
+        bool has_static = add_static_slave(server, "SLAVE_LETTERS_URL", "slave-letters", "/letras", "letters");
+        has_static |= add_static_slave(server, "SLAVE_NUMBERS_URL", "slave-numbers", "/numeros", "numbers");
+        if (!has_static) {
+            Logger::info("Nenhum escravo estático configurado, aguardando registros dinâmicos");
+        }
         
         Logger::info_f("Tentando iniciar servidor na porta %d", port);
         
@@ -73,6 +175,9 @@ int main(int argc, char* argv[]) {
             }
         }
         
+        if (received_signal) {
+            Logger::info_f("Sinal recebido: %d", received_signal.load());
+        }
         Logger::info("Iniciando shutdown graceful...");
         server.stop();
         
@@ -1,5 +1,12 @@
 #include "master_server.h"
 #include "logger.h"
+#include "metrics.h"
+#include "tracing.h"
+#include "request_tracker.h"
+#include "profiler.h"
+#include "result_merge.h"
+#include "traffic_capture.h"
+#include "file_ingest.h"
 #include <httplib.h>
 #include <nlohmann/json.hpp>
 #include <thread>
@@ -7,25 +14,313 @@
 #include <algorithm>
 #include <future>
 #include <functional>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <sys/stat.h>
 
 using json = nlohmann::json;
 
-MasterServer::MasterServer(int server_port) : port(server_port), running(false) {
+// Tempo máximo que uma chamada aguarda por vaga no limite do escravo
+static constexpr std::chrono::milliseconds SLAVE_QUEUE_TIMEOUT(250);
+
+// Tempo máximo que uma requisição aguarda na fila do escalonador
+static constexpr std::chrono::milliseconds SCHEDULER_QUEUE_TIMEOUT(30000);
+
+// Duração do lease de escravos registrados e intervalo sugerido de heartbeat
+static constexpr std::chrono::seconds SLAVE_LEASE_TTL(15);
+static constexpr std::chrono::seconds SLAVE_HEARTBEAT_INTERVAL(5);
+
+// Intervalo entre health checks dos escravos estáticos
+static constexpr std::chrono::seconds HEALTH_CHECK_INTERVAL(10);
+
+// Modo pull: tamanho padrão das fatias, espera máxima do long poll, prazo
+// total para as fatias de uma requisição e janela para considerar um worker ativo
+static constexpr size_t DEFAULT_SHARD_SIZE = 1024 * 1024;
+static constexpr std::chrono::milliseconds MAX_POLL_WAIT(10000);
+static constexpr std::chrono::seconds WORK_DEADLINE(60);
+static constexpr std::chrono::seconds WORKER_ACTIVE_WINDOW(15);
+
+// Uploads em partes: tamanho de bloco quando o cliente não pede um e tempo
+// sem blocos novos até a sessão ser descartada (com MASTER_UPLOAD_DIR, até
+// sair da memória; o estado em disco dura UPLOAD_STATE_TTL)
+static constexpr uint64_t DEFAULT_UPLOAD_CHUNK_SIZE = 8 * 1024 * 1024;
+static constexpr std::chrono::minutes UPLOAD_IDLE_TTL(10);
+static constexpr std::chrono::hours UPLOAD_STATE_TTL(7 * 24);
+
+// /process/path: o arquivo é contado em janelas deste tamanho, a memória
+// por requisição não cresce com o arquivo
+static constexpr uint64_t PATH_WINDOW_SIZE = 64 * 1024 * 1024;
+
+// Threads HTTP: precisam exceder as vagas de despacho para que requisições
+// interativas consigam entrar na fila enquanto o lote ocupa as vagas, e
+// comportar os long polls dos workers no modo pull
+static constexpr size_t HTTP_THREAD_COUNT = 128;
+
+// Métricas do mestre exportadas em /metrics; criadas uma vez e
+// registradas por referência no caminho quente
+namespace {
+
+struct MasterMetrics {
+    metrics::Counter& requests = metrics::registry().counter(
+        "requests_total", "Requisições recebidas", "route=\"/process\"");
+    metrics::Counter& errors = metrics::registry().counter(
+        "request_errors_total", "Requisições que terminaram com erro", "route=\"/process\"");
+    metrics::Counter& bytes = metrics::registry().counter(
+        "request_bytes_total", "Bytes recebidos no corpo das requisições", "route=\"/process\"");
+    metrics::Gauge& in_flight = metrics::registry().gauge(
+        "requests_in_flight", "Requisições em andamento", "route=\"/process\"");
+    metrics::Histogram& duration = metrics::registry().histogram(
+        "request_duration_seconds", "Duração total da requisição", "route=\"/process\"");
+
+    metrics::Histogram& scheduler_wait = metrics::registry().histogram(
+        "stage_duration_seconds", "Duração de cada etapa da requisição", "stage=\"scheduler_queue\"");
+    metrics::Histogram& parse = metrics::registry().histogram(
+        "stage_duration_seconds", "Duração de cada etapa da requisição", "stage=\"parse\"");
+    metrics::Histogram& work_queue = metrics::registry().histogram(
+        "stage_duration_seconds", "Duração de cada etapa da requisição", "stage=\"work_queue\"");
+    metrics::Histogram& merge = metrics::registry().histogram(
+        "stage_duration_seconds", "Duração de cada etapa da requisição", "stage=\"merge\"");
+    metrics::Histogram& read_file = metrics::registry().histogram(
+        "stage_duration_seconds", "Duração de cada etapa da requisição", "stage=\"read_file\"");
+    metrics::Counter& path_requests = metrics::registry().counter(
+        "requests_total", "Requisições recebidas", "route=\"/process/path\"");
+    metrics::Counter& path_errors = metrics::registry().counter(
+        "request_errors_total", "Requisições que terminaram com erro", "route=\"/process/path\"");
+    metrics::Histogram& path_duration = metrics::registry().histogram(
+        "request_duration_seconds", "Duração total da requisição", "route=\"/process/path\"");
+    metrics::Counter& path_bytes = metrics::registry().counter(
+        "file_bytes_read_total", "Bytes lidos do volume compartilhado", "route=\"/process/path\"");
+
+    metrics::Counter& upload_sessions = metrics::registry().counter(
+        "upload_sessions_total", "Sessões de upload em partes criadas");
+    metrics::Counter& upload_chunks = metrics::registry().counter(
+        "requests_total", "Requisições recebidas", "route=\"/upload/chunks\"");
+    metrics::Counter& upload_chunk_errors = metrics::registry().counter(
+        "request_errors_total", "Requisições que terminaram com erro", "route=\"/upload/chunks\"");
+    metrics::Histogram& upload_chunk_duration = metrics::registry().histogram(
+        "request_duration_seconds", "Duração total da requisição", "route=\"/upload/chunks\"");
+    metrics::Counter& upload_bytes = metrics::registry().counter(
+        "request_bytes_total", "Bytes recebidos no corpo das requisições", "route=\"/upload/chunks\"");
+
+    metrics::Histogram& letters_call = metrics::registry().histogram(
+        "slave_call_duration_seconds", "Duração das chamadas aos escravos", "type=\"letters\"");
+    metrics::Histogram& numbers_call = metrics::registry().histogram(
+        "slave_call_duration_seconds", "Duração das chamadas aos escravos", "type=\"numbers\"");
+    metrics::Counter& letters_call_errors = metrics::registry().counter(
+        "slave_call_errors_total", "Chamadas aos escravos que falharam", "type=\"letters\"");
+    metrics::Counter& numbers_call_errors = metrics::registry().counter(
+        "slave_call_errors_total", "Chamadas aos escravos que falharam", "type=\"numbers\"");
+};
+
+MasterMetrics& master_metrics() {
+    static MasterMetrics instance;
+    return instance;
+}
+
+// Momento em que os cabeçalhos da requisição atual chegaram (ver o
+// pre-routing handler); a mesma thread executa o handler da rota
+thread_local uint64_t request_headers_us = 0;
+
+} // namespace
+
+MasterServer::MasterServer(int server_port)
+    : port(server_port), running(false), shard_size(DEFAULT_SHARD_SIZE),
+      scheduler(std::max(2u, std::thread::hardware_concurrency()) * 2),
+      transport(std::make_shared<HttpSlaveTransport>()) {
     Logger::info_f("Servidor mestre criado na porta %d", port);
 }
 
 MasterServer::~MasterServer() {
     stop();
+    if (maintenance_thread.joinable()) {
+        maintenance_thread.join();
+    }
 }
 
 void MasterServer::add_slave(const std::string& name, const std::string& host, int port,
                             const std::string& endpoint, const std::string& type) {
-    auto slave = std::make_unique<SlaveInfo>(name, host, port, endpoint, type);
-    slaves.push_back(std::move(slave));
+    auto slave = std::make_shared<SlaveInfo>(name, host, port, endpoint, type);
+    registry.update([&slave](SlaveRegistry::Snapshot& slaves) {
+        slaves.push_back(std::move(slave));
+        return true;
+    });
     Logger::info_f("Escravo adicionado: %s (%s:%d) - Tipo: %s",
                   name.c_str(), host.c_str(), port, type.c_str());
 }
 
+void MasterServer::register_slave(const std::string& name, const std::string& host, int port,
+                                  const std::string& endpoint, const std::string& type) {
+    auto slave = std::make_shared<SlaveInfo>(name, host, port, endpoint, type, true);
+    slave->is_healthy = true;
+    slave->renew_lease(SLAVE_LEASE_TTL);
+
+    std::shared_ptr<SlaveInfo> replaced;
+    registry.update([&](SlaveRegistry::Snapshot& slaves) {
+        auto it = std::find_if(slaves.begin(), slaves.end(),
+                               [&name](const std::shared_ptr<SlaveInfo>& s) { return s->name == name; });
+
+        // Mesmo nome registrando de novo (ex.: container reiniciado): substitui a entrada
+        if (it != slaves.end()) {
+            replaced = *it;
+            *it = slave;
+        } else {
+            slaves.push_back(slave);
+        }
+        return true;
+    });
+
+    // O container pode ter voltado em outro endereço ou porta
+    if (replaced) {
+        transport->forget(*replaced);
+    }
+
+    Logger::info_f("Escravo %s: %s (%s:%d) - Tipo: %s",
+                  replaced ? "re-registrado" : "registrado",
+                  name.c_str(), host.c_str(), port, type.c_str());
+}
+
+bool MasterServer::renew_lease(const std::string& name, int in_flight,
+                               unsigned long long requests_total, double load_average) {
+    // Heartbeats só tocam campos atômicos: não geram nova snapshot
+    auto snapshot = registry.read();
+
+    for (const auto& slave : snapshot.slaves()) {
+        if (slave->name == name && slave->dynamic) {
+            slave->renew_lease(SLAVE_LEASE_TTL);
+            slave->is_healthy = true;
+            slave->reported_in_flight = in_flight;
+            slave->reported_requests = requests_total;
+            slave->reported_load_average = load_average;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool MasterServer::remove_slave(const std::string& name) {
+    SlaveRegistry::Snapshot removed_slaves;
+    bool removed = registry.update([&name, &removed_slaves](SlaveRegistry::Snapshot& slaves) {
+        auto it = std::stable_partition(slaves.begin(), slaves.end(),
+                                        [&name](const std::shared_ptr<SlaveInfo>& s) { return s->name != name; });
+        if (it == slaves.end()) {
+            return false;
+        }
+        removed_slaves.assign(it, slaves.end());
+        slaves.erase(it, slaves.end());
+        return true;
+    });
+
+    for (const auto& slave : removed_slaves) {
+        transport->forget(*slave);
+    }
+    if (removed) {
+        Logger::info_f("Escravo removido: %s", name.c_str());
+    }
+    return removed;
+}
+
+void MasterServer::expire_leases() {
+    auto now = std::chrono::steady_clock::now();
+
+    // Verificação barata sem lock; só publica nova snapshot se algo expirou
+    {
+        auto snapshot = registry.read();
+        bool any_expired = std::any_of(snapshot->begin(), snapshot->end(),
+                                       [now](const std::shared_ptr<SlaveInfo>& s) {
+                                           return s->lease_expired(now);
+                                       });
+        if (!any_expired) {
+            return;
+        }
+    }
+
+    SlaveRegistry::Snapshot expired;
+    registry.update([now, &expired](SlaveRegistry::Snapshot& slaves) {
+        auto it = std::stable_partition(slaves.begin(), slaves.end(),
+                                        [now](const std::shared_ptr<SlaveInfo>& s) {
+                                            if (s->lease_expired(now)) {
+                                                Logger::warning_f("Lease do escravo %s expirou, removendo",
+                                                                 s->name.c_str());
+                                                return false;
+                                            }
+                                            return true;
+                                        });
+        if (it == slaves.end()) {
+            return false;
+        }
+        expired.assign(it, slaves.end());
+        slaves.erase(it, slaves.end());
+        return true;
+    });
+
+    for (const auto& slave : expired) {
+        transport->forget(*slave);
+    }
+}
+
+void MasterServer::maintenance_loop() {
+    auto next_health_check = std::chrono::steady_clock::now() + HEALTH_CHECK_INTERVAL;
+
+    while (running.load()) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+
+        expire_leases();
+        registry.reclaim();
+        work_queue.requeue_expired();
+        if (size_t expired = uploads.expire(UPLOAD_IDLE_TTL, UPLOAD_STATE_TTL)) {
+            Logger::warning_f("%zu sessões de upload expiraram sem terminar", expired);
+        }
+
+        if (std::chrono::steady_clock::now() >= next_health_check) {
+            update_slaves_health();
+            next_health_check = std::chrono::steady_clock::now() + HEALTH_CHECK_INTERVAL;
+        }
+    }
+}
+
+void MasterServer::set_pull_mode(bool enabled) {
+    pull_mode = enabled;
+    Logger::info_f("Modo de despacho: %s", enabled ? "pull (workers)" : "push (escravos)");
+}
+
+void MasterServer::set_shard_size(size_t bytes) {
+    shard_size = std::max<size_t>(4096, bytes);
+    Logger::info_f("Tamanho das fatias do modo pull: %zu bytes", shard_size);
+}
+
+void MasterServer::set_dispatch_slots(size_t slots) {
+    scheduler.set_capacity(slots);
+    Logger::info_f("Vagas de despacho do escalonador: %zu", scheduler.capacity());
+}
+
+void MasterServer::set_client_priority(const std::string& client_id, PriorityClass cls) {
+    client_priorities[client_id] = cls;
+    Logger::info_f("Cliente %s associado à classe %s",
+                  client_id.c_str(), RequestScheduler::class_name(cls));
+}
+
+bool MasterServer::set_upload_state_dir(const std::string& dir) {
+    return uploads.set_state_dir(dir);
+}
+
+bool MasterServer::set_ingest_root(const std::string& root) {
+    char resolved[PATH_MAX];
+    struct stat info;
+    if (!realpath(root.c_str(), resolved) || stat(resolved, &info) != 0 || !S_ISDIR(info.st_mode)) {
+        Logger::warning_f("Raiz de ingestão inválida '%s', /process/path desabilitado", root.c_str());
+        return false;
+    }
+    ingest_root = resolved;
+    Logger::info_f("/process/path habilitado na raiz %s", ingest_root.c_str());
+    return true;
+}
+
+void MasterServer::set_transport(std::shared_ptr<SlaveTransport> slave_transport) {
+    transport = std::move(slave_transport);
+}
+
 bool MasterServer::start() {
     if (running.load()) {
         Logger::warning("Servidor já está rodando");
@@ -38,43 +333,209 @@ bool MasterServer::start() {
         // Configurar timeout
         server.set_read_timeout(30, 0);
         server.set_write_timeout(30, 0);
+        server.new_task_queue = [] { return new httplib::ThreadPool(HTTP_THREAD_COUNT); };
 
         // Health check
         server.Get("/health", [this](const httplib::Request&, httplib::Response& res) {
             json response;
             response["status"] = "healthy";
             response["service"] = "master";
-            response["slaves_count"] = slaves.size();
 
             // Status dos escravos
+            auto snapshot = registry.read();
+            response["slaves_count"] = snapshot->size();
+
             json slaves_status = json::array();
-            for (const auto& slave : slaves) {
+            for (const auto& slave : snapshot.slaves()) {
                 json slave_info;
                 slave_info["name"] = slave->name;
                 slave_info["type"] = slave->type;
-                slave_info["healthy"] = slave->is_healthy;
+                slave_info["host"] = slave->host;
+                slave_info["port"] = slave->port;
+                slave_info["healthy"] = slave->is_healthy.load();
+                slave_info["registration"] = slave->dynamic ? "dynamic" : "static";
+                if (slave->dynamic) {
+                    slave_info["reported_in_flight"] = slave->reported_in_flight.load();
+                    slave_info["reported_requests"] = slave->reported_requests.load();
+                    slave_info["reported_load_average"] = slave->reported_load_average.load();
+                }
+                slave_info["concurrency_limit"] = slave->limiter.limit();
+                slave_info["in_flight"] = slave->limiter.in_flight();
+                slave_info["rtt_baseline_ms"] = slave->limiter.baseline_rtt_ms();
+                slave_info["rtt_recent_ms"] = slave->limiter.recent_rtt_ms();
                 slaves_status.push_back(slave_info);
             }
             response["slaves"] = slaves_status;
 
+            // Estado do escalonador por classe
+            json scheduler_status;
+            scheduler_status["dispatch_slots"] = scheduler.capacity();
+            scheduler_status["in_use"] = scheduler.in_use();
+            for (auto cls : {PriorityClass::INTERACTIVE, PriorityClass::NORMAL, PriorityClass::BATCH}) {
+                json class_info;
+                class_info["weight"] = scheduler.weight(cls);
+                class_info["queued"] = scheduler.queued(cls);
+                class_info["dispatched"] = scheduler.dispatched(cls);
+                scheduler_status["classes"][RequestScheduler::class_name(cls)] = class_info;
+            }
+            response["scheduler"] = scheduler_status;
+
+            // Fila do modo pull
+            WorkQueue::Stats work_stats = work_queue.stats(WORKER_ACTIVE_WINDOW);
+            json work_status;
+            work_status["mode"] = pull_mode ? "pull" : "push";
+            work_status["pending"] = work_stats.pending;
+            work_status["leased"] = work_stats.leased;
+            work_status["active_workers"] = work_stats.active_workers;
+            work_status["completed"] = work_stats.completed;
+            work_status["stolen"] = work_stats.stolen;
+            work_status["requeued"] = work_stats.requeued;
+            response["work_queue"] = work_status;
+
             res.set_content(response.dump(), "application/json");
-            Logger::debug("Health check requisitado");
+            Logger::debug_f("Health check requisitado");
+        });
+
+        // Métricas no formato Prometheus
+        server.Get("/metrics", [](const httplib::Request&, httplib::Response& res) {
+            res.set_content(metrics::registry().render(), metrics::CONTENT_TYPE);
+        });
+
+        // Requisições em andamento e as mais lentas recentes
+        server.Get("/debug/requests", [](const httplib::Request&, httplib::Response& res) {
+            res.set_content(RequestTracker::instance().render(), "application/json");
+        });
+
+        // Profile de CPU por amostragem, em formato folded (flamegraph.pl)
+        server.Get("/debug/profile", [](const httplib::Request& req, httplib::Response& res) {
+            profiler::Options options;
+            try {
+                if (req.has_param("seconds")) {
+                    options.seconds = std::stoi(req.get_param_value("seconds"));
+                }
+                if (req.has_param("hz")) {
+                    options.frequency = std::stoi(req.get_param_value("hz"));
+                }
+            } catch (const std::exception&) {
+                res.status = 400;
+                json error_response;
+                error_response["success"] = false;
+                error_response["error"] = "Parâmetros inválidos";
+                res.set_content(error_response.dump(), "application/json");
+                return;
+            }
+            options.seconds = std::max(1, std::min(options.seconds, 60));
+            options.frequency = std::max(1, std::min(options.frequency, 1000));
+
+            profiler::Profile profile;
+            if (!profiler::collect(options, profile)) {
+                res.status = 409;
+                json error_response;
+                error_response["success"] = false;
+                error_response["error"] = "Profile já em andamento";
+                res.set_content(error_response.dump(), "application/json");
+                return;
+            }
+            res.set_header("X-Profile-Samples", std::to_string(profile.samples));
+            res.set_header("X-Profile-Dropped", std::to_string(profile.dropped));
+            res.set_content(profile.folded, "text/plain");
         });
 
         // Processamento principal
         server.Post("/process", [this](const httplib::Request& req, httplib::Response& res) {
-            Logger::info_f("Cliente conectado ao servidor mestre de %s", req.remote_addr.c_str());
-            Logger::info("Requisição de processamento recebida");
+            static AccessLog access_log("POST /process");
+            AccessLog::Scope access(access_log, res.status, req.body.size());
+            capture::Recorder::Scope capture_scope(req, res.status);
+            static alloc_tracking::Endpoint allocations("/process");
+            alloc_tracking::Scope allocation_scope(allocations);
+
+            // ID da requisição: aceito do cliente ou gerado aqui, e devolvido
+            tracing::Context trace = tracing::accept(req.get_header_value(tracing::REQUEST_ID_HEADER),
+                                                     req.get_header_value(tracing::SAMPLED_HEADER));
+            res.set_header(tracing::REQUEST_ID_HEADER, trace.request_id);
+            RequestTracker::Handle tracker(trace.request_id, "/process", req.body.size(), res.status);
+            RequestContext request{trace, tracker, allocation_scope};
+            if (request_headers_us) {
+                uint64_t received_us = tracing::now_us();
+                tracing::record(trace, "receive", request_headers_us, received_us);
+                tracker.add_timing("receive", std::chrono::microseconds(received_us - request_headers_us));
+            }
+            tracing::Span process_span(trace, "process");
+            tracker.stage("scheduler_queue");
+
+            MasterMetrics& stats = master_metrics();
+            stats.requests.add();
+            stats.bytes.add(req.body.size());
+            metrics::Gauge::Scope in_flight_scope(stats.in_flight);
+            metrics::ScopedTimer request_timer(stats.duration);
+
+            Logger::debug_f("Cliente conectado ao servidor mestre de %s", req.remote_addr.c_str());
+            Logger::debug_f("Requisição de processamento recebida");
+
+            compression::Encoding encoding;
+            if (!request_encoding(req, res, encoding)) {
+                stats.errors.add();
+                return;
+            }
 
             try {
-                json request_json = json::parse(req.body);
-                std::string text = request_json["text"];
+                // Aguardar vaga de despacho conforme a classe de prioridade
+                PriorityClass priority = classify_request(req);
+                auto queue_start = std::chrono::steady_clock::now();
+                RequestScheduler::Slot slot = scheduler.acquire(priority, req.body.size(),
+                                                                SCHEDULER_QUEUE_TIMEOUT);
+                auto queue_end = std::chrono::steady_clock::now();
+                stats.scheduler_wait.observe(queue_end - queue_start);
+                tracing::record(trace, "scheduler_queue", tracing::to_us(queue_start), tracing::to_us(queue_end));
+
+                if (!slot) {
+                    stats.errors.add();
+                    LOG_RATE_LIMITED(LogLevel::WARNING, 1, "Requisição %s expirou na fila do escalonador",
+                                     RequestScheduler::class_name(priority));
+
+                    json error_response;
+                    error_response["success"] = false;
+                    error_response["error_message"] = "Servidor sobrecarregado, tente novamente";
+
+                    res.status = 503;
+                    res.set_content(error_response.dump(), "application/json");
+                    return;
+                }
+
+                tracker.stage("parse");
+                auto parse_start = std::chrono::steady_clock::now();
+                // Texto puro em zstd vai aos escravos como chegou, sem o mestre
+                // montar o texto descomprimido; zstd com JSON é descomprimido
+                // aqui, e gzip o httplib já descomprimiu
+                compression::Encoding forwarded = compression::Encoding::IDENTITY;
+                std::string decoded;
+                const std::string* body = &req.body;
+                if (encoding == compression::Encoding::ZSTD && is_plain_text(req)) {
+                    forwarded = encoding;
+                } else if (encoding == compression::Encoding::ZSTD) {
+                    decoded = compression::decompress(encoding, req.body);
+                    body = &decoded;
+                }
 
-                Logger::info_f("Processando texto de %zu caracteres", text.length());
+                // Corpo text/plain é o próprio texto (upload em streaming do
+                // cliente, sem JSON); senão, {"text": "..."}
+                json request_json;
+                const std::string* text = body;
+                if (!is_plain_text(req)) {
+                    request_json = json::parse(*body);
+                    text = &request_json.at("text").get_ref<const std::string&>();
+                }
+                auto parse_end = std::chrono::steady_clock::now();
+                stats.parse.observe(parse_end - parse_start);
+                tracing::record(trace, "parse", tracing::to_us(parse_start), tracing::to_us(parse_end));
+
+                Logger::debug_f("Processando %s de %zu bytes (classe %s)",
+                               forwarded == compression::Encoding::IDENTITY ? "texto" : "corpo comprimido",
+                               text->length(), RequestScheduler::class_name(priority));
 
                 auto start_time = std::chrono::high_resolution_clock::now();
 
-                std::string result = process_text_request(text);
+                std::string result = process_text_request(*text, request, forwarded);
 
                 auto end_time = std::chrono::high_resolution_clock::now();
                 auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
@@ -82,16 +543,540 @@ bool MasterServer::start() {
                 // Adicionar tempo de processamento à resposta
                 json result_json = json::parse(result);
                 result_json["processing_time_ms"] = duration.count();
+                if (!result_json.value("success", false)) {
+                    stats.errors.add();
+                }
 
+                tracker.stage("respond");
+                tracing::Span respond_span(trace, "respond");
                 res.set_content(result_json.dump(), "application/json");
-                Logger::info_f("Processamento concluído em %ld ms", duration.count());
+                respond_span.end();
+                Logger::debug_f("Processamento concluído em %ld ms", duration.count());
+
+            } catch (const std::exception& e) {
+                LOG_RATE_LIMITED(LogLevel::ERROR, 5, "Erro no processamento: %s", e.what());
+                stats.errors.add();
+
+                json error_response;
+                error_response["success"] = false;
+                error_response["error_message"] = e.what();
+
+                res.status = 400;
+                res.set_content(error_response.dump(), "application/json");
+            }
+        });
+
+        // Processamento de um arquivo do volume compartilhado com o mestre:
+        // o texto é lido aqui, sem passar pelo cliente nem pelo corpo HTTP
+        server.Post("/process/path", [this](const httplib::Request& req, httplib::Response& res) {
+            static AccessLog access_log("POST /process/path");
+            AccessLog::Scope access(access_log, res.status, req.body.size());
+            static alloc_tracking::Endpoint allocations("/process/path");
+            alloc_tracking::Scope allocation_scope(allocations);
+
+            tracing::Context trace = tracing::accept(req.get_header_value(tracing::REQUEST_ID_HEADER),
+                                                     req.get_header_value(tracing::SAMPLED_HEADER));
+            res.set_header(tracing::REQUEST_ID_HEADER, trace.request_id);
+            RequestTracker::Handle tracker(trace.request_id, "/process/path", req.body.size(), res.status);
+            RequestContext request{trace, tracker, allocation_scope};
+            tracing::Span process_span(trace, "process");
+
+            MasterMetrics& stats = master_metrics();
+            stats.path_requests.add();
+            metrics::ScopedTimer request_timer(stats.path_duration);
+
+            if (ingest_root.empty()) {
+                stats.path_errors.add();
+                json error_response;
+                error_response["success"] = false;
+                error_response["error_message"] = "Ingestão por caminho desabilitada (MASTER_INGEST_ROOT)";
+                res.status = 404;
+                res.set_content(error_response.dump(), "application/json");
+                return;
+            }
+
+            std::string path;
+            std::unique_ptr<file_ingest::File> file;
+            try {
+                json request_json = json::parse(req.body);
+                path = request_json.at("path").get<std::string>();
+                file.reset(new file_ingest::File(ingest_root, path));
+            } catch (const std::exception& e) {
+                stats.path_errors.add();
+                json error_response;
+                error_response["success"] = false;
+                error_response["error_message"] = e.what();
+                res.status = 400;
+                res.set_content(error_response.dump(), "application/json");
+                return;
+            }
+
+            try {
+                tracker.stage("scheduler_queue");
+                PriorityClass priority = classify_request(req);
+                auto queue_start = std::chrono::steady_clock::now();
+                RequestScheduler::Slot slot = scheduler.acquire(priority, static_cast<size_t>(file->size()),
+                                                                SCHEDULER_QUEUE_TIMEOUT);
+                auto queue_end = std::chrono::steady_clock::now();
+                stats.scheduler_wait.observe(queue_end - queue_start);
+                tracing::record(trace, "scheduler_queue", tracing::to_us(queue_start), tracing::to_us(queue_end));
+
+                if (!slot) {
+                    stats.path_errors.add();
+                    json error_response;
+                    error_response["success"] = false;
+                    error_response["error_message"] = "Servidor sobrecarregado, tente novamente";
+                    res.status = 503;
+                    res.set_content(error_response.dump(), "application/json");
+                    return;
+                }
+
+                // Cada janela é lida e despachada antes da próxima, como os
+                // blocos de /upload; as contagens são por byte, então o corte
+                // entre janelas não muda o resultado. Os blocos de uma janela
+                // chegam fora de ordem e vão direto para a posição final
+                uint64_t size = file->size();
+                std::string window;
+                file_ingest::ReadStats read_stats;
+                size_t reads = 0;
+                std::chrono::steady_clock::duration read_time{0};
+                std::chrono::steady_clock::duration processing_time{0};
+                int64_t letters = 0;
+                int64_t numbers = 0;
+                json result_json;
+
+                uint64_t offset = 0;
+                do {
+                    size_t part = static_cast<size_t>(std::min(PATH_WINDOW_SIZE, size - offset));
+
+                    tracker.stage("read_file");
+                    auto read_start = std::chrono::steady_clock::now();
+                    window.resize(part);
+                    read_stats = file->read(offset, part,
+                        [&window, offset](uint64_t at, const char* data, size_t length) {
+                            std::memcpy(&window[static_cast<size_t>(at - offset)], data, length);
+                        });
+                    auto read_end = std::chrono::steady_clock::now();
+                    stats.read_file.observe(read_end - read_start);
+                    stats.path_bytes.add(part);
+                    tracing::record(trace, "read_file", tracing::to_us(read_start), tracing::to_us(read_end));
+                    read_time += read_end - read_start;
+                    reads += read_stats.reads;
+
+                    auto start_time = std::chrono::steady_clock::now();
+                    result_json = json::parse(process_text_request(window, request));
+                    processing_time += std::chrono::steady_clock::now() - start_time;
+                    if (!result_json.value("success", false)) {
+                        break;
+                    }
+                    letters += result_json["letters_count"].get<int64_t>();
+                    numbers += result_json["numbers_count"].get<int64_t>();
+                    offset += part;
+                } while (offset < size);
+
+                Logger::debug_f("Arquivo %s processado (%llu bytes, %s, %zu leituras)", path.c_str(),
+                               static_cast<unsigned long long>(size), read_stats.method, reads);
+
+                if (result_json.value("success", false)) {
+                    result_json["letters_count"] = letters;
+                    result_json["numbers_count"] = numbers;
+                } else {
+                    stats.path_errors.add();
+                }
+                result_json["total_characters"] = size;
+                result_json["processing_time_ms"] =
+                    std::chrono::duration_cast<std::chrono::milliseconds>(processing_time).count();
+                result_json["read_time_ms"] =
+                    std::chrono::duration_cast<std::chrono::milliseconds>(read_time).count();
+                result_json["read_method"] = read_stats.method;
+
+                tracker.stage("respond");
+                res.set_content(result_json.dump(), "application/json");
+
+            } catch (const std::exception& e) {
+                LOG_RATE_LIMITED(LogLevel::ERROR, 5, "Erro ao processar %s: %s", path.c_str(), e.what());
+                stats.path_errors.add();
+
+                json error_response;
+                error_response["success"] = false;
+                error_response["error_message"] = e.what();
+                res.status = 500;
+                res.set_content(error_response.dump(), "application/json");
+            }
+        });
+
+        // Upload em partes: cria a sessão; os blocos chegam em paralelo em
+        // PUT /upload/{id}/chunks/{n} e o resultado sai em /upload/{id}/finish
+        server.Post("/upload", [this](const httplib::Request& req, httplib::Response& res) {
+            try {
+                json request_json = json::parse(req.body);
+                uint64_t size = request_json.at("size").get<uint64_t>();
+                uint64_t chunk_size = request_json.value("chunk_size", DEFAULT_UPLOAD_CHUNK_SIZE);
+                uint32_t chunks = 0;
+                std::string upload_id = uploads.create(size, chunk_size, chunks);
+                master_metrics().upload_sessions.add();
+
+                Logger::debug_f("Upload %s criado: %llu bytes em %u blocos", upload_id.c_str(),
+                               static_cast<unsigned long long>(size), chunks);
+
+                json response;
+                response["success"] = true;
+                response["upload_id"] = upload_id;
+                response["chunk_size"] = chunk_size;
+                response["chunks"] = chunks;
+                res.set_content(response.dump(), "application/json");
+
+            } catch (const std::length_error& e) {
+                json error_response;
+                error_response["success"] = false;
+                error_response["error_message"] = e.what();
+                res.status = 503;
+                res.set_content(error_response.dump(), "application/json");
+            } catch (const std::runtime_error& e) {
+                Logger::error_f("Erro ao criar upload: %s", e.what());
+                json error_response;
+                error_response["success"] = false;
+                error_response["error_message"] = e.what();
+                res.status = 500;
+                res.set_content(error_response.dump(), "application/json");
+            } catch (const std::exception& e) {
+                json error_response;
+                error_response["success"] = false;
+                error_response["error_message"] = e.what();
+                res.status = 400;
+                res.set_content(error_response.dump(), "application/json");
+            }
+        });
+
+        // Um bloco do upload: o corpo é o texto cru e X-Chunk-Hash traz o
+        // FNV-1a de 64 bits do bloco em hexadecimal. O bloco é contado aqui,
+        // como um /process, e só as contagens ficam na sessão
+        server.Put(R"(/upload/([0-9a-f]+)/chunks/(\d+))", [this](const httplib::Request& req, httplib::Response& res) {
+            static AccessLog access_log("PUT /upload/chunks");
+            AccessLog::Scope access(access_log, res.status, req.body.size());
+            static alloc_tracking::Endpoint allocations("/upload/chunks");
+            alloc_tracking::Scope allocation_scope(allocations);
+
+            tracing::Context trace = tracing::accept(req.get_header_value(tracing::REQUEST_ID_HEADER),
+                                                     req.get_header_value(tracing::SAMPLED_HEADER));
+            res.set_header(tracing::REQUEST_ID_HEADER, trace.request_id);
+            RequestTracker::Handle tracker(trace.request_id, "/upload/chunks", req.body.size(), res.status);
+            RequestContext request{trace, tracker, allocation_scope};
+            tracing::Span process_span(trace, "process");
+
+            MasterMetrics& stats = master_metrics();
+            stats.upload_chunks.add();
+            stats.upload_bytes.add(req.body.size());
+            metrics::ScopedTimer request_timer(stats.upload_chunk_duration);
 
+            auto fail = [&](int status, const std::string& message) {
+                stats.upload_chunk_errors.add();
+                json error_response;
+                error_response["success"] = false;
+                error_response["error_message"] = message;
+                res.status = status;
+                res.set_content(error_response.dump(), "application/json");
+            };
+
+            // Bloco comprimido pelo cliente: tamanho e hash são os do bloco original
+            compression::Encoding encoding;
+            if (!request_encoding(req, res, encoding)) {
+                stats.upload_chunk_errors.add();
+                return;
+            }
+            std::string decoded;
+            const std::string* chunk = &req.body;
+            if (encoding == compression::Encoding::ZSTD) {
+                try {
+                    decoded = compression::decompress(encoding, req.body);
+                } catch (const std::exception& e) {
+                    fail(400, e.what());
+                    return;
+                }
+                chunk = &decoded;
+            }
+
+            std::string upload_id = req.matches[1];
+            uint32_t index = 0;
+            try {
+                unsigned long parsed = std::stoul(req.matches[2]);
+                if (parsed > UINT32_MAX) {
+                    throw std::out_of_range("Bloco fora da sessão de upload");
+                }
+                index = static_cast<uint32_t>(parsed);
+                if (uploads.chunk_length(upload_id, index) != chunk->size()) {
+                    fail(400, "Tamanho do bloco não confere com a sessão");
+                    return;
+                }
+            } catch (const std::exception& e) {
+                fail(404, e.what());
+                return;
+            }
+
+            // Bloco corrompido no caminho: o cliente reenvia. O hash fica no
+            // estado da sessão para reconhecer reenvios do mesmo bloco
+            std::string expected_hash = req.get_header_value("X-Chunk-Hash");
+            if (expected_hash.empty()) {
+                fail(400, "X-Chunk-Hash ausente");
+                return;
+            }
+            uint64_t chunk_hash = capture::fnv1a(chunk->data(), chunk->size());
+            if (std::strtoull(expected_hash.c_str(), nullptr, 16) != chunk_hash) {
+                fail(422, "Hash do bloco não confere");
+                return;
+            }
+
+            auto respond = [&](bool duplicate) {
+                json response;
+                response["success"] = true;
+                response["index"] = index;
+                response["duplicate"] = duplicate;
+                res.set_content(response.dump(), "application/json");
+            };
+
+            try {
+                // Reenvio de um bloco já gravado (resposta perdida, retomada):
+                // responde antes de ocupar o escalonador e contar de novo
+                if (uploads.counted(upload_id, index, chunk_hash)) {
+                    respond(true);
+                    return;
+                }
+
+                tracker.stage("scheduler_queue");
+                PriorityClass priority = classify_request(req);
+                auto queue_start = std::chrono::steady_clock::now();
+                RequestScheduler::Slot slot = scheduler.acquire(priority, chunk->size(),
+                                                                SCHEDULER_QUEUE_TIMEOUT);
+                auto queue_end = std::chrono::steady_clock::now();
+                stats.scheduler_wait.observe(queue_end - queue_start);
+                tracing::record(trace, "scheduler_queue", tracing::to_us(queue_start), tracing::to_us(queue_end));
+
+                if (!slot) {
+                    fail(503, "Servidor sobrecarregado, tente novamente");
+                    return;
+                }
+
+                json result_json = json::parse(process_text_request(*chunk, request));
+                if (!result_json.value("success", false)) {
+                    fail(502, result_json.value("error_message", "Falha ao contar o bloco"));
+                    return;
+                }
+
+                // Dois envios simultâneos do mesmo bloco: só um é somado
+                bool counted = uploads.complete_chunk(upload_id, index, chunk_hash,
+                                                      result_json["letters_count"].get<int64_t>(),
+                                                      result_json["numbers_count"].get<int64_t>());
+                respond(!counted);
+
+            } catch (const std::out_of_range& e) {
+                // Sessão expirada ou finalizada enquanto o bloco era contado
+                fail(404, e.what());
+            } catch (const std::invalid_argument& e) {
+                fail(409, e.what());
             } catch (const std::exception& e) {
-                Logger::error_f("Erro no processamento: %s", e.what());
+                LOG_RATE_LIMITED(LogLevel::ERROR, 5, "Erro no bloco %u do upload %s: %s", index,
+                                 upload_id.c_str(), e.what());
+                fail(500, e.what());
+            }
+        });
 
+        // Estado da sessão para retomar um upload interrompido: o cliente
+        // reenvia só os blocos listados em missing
+        server.Get(R"(/upload/([0-9a-f]+))", [this](const httplib::Request& req, httplib::Response& res) {
+            std::vector<uint32_t> missing;
+            UploadSessions::Summary summary;
+            try {
+                summary = uploads.status(req.matches[1], &missing);
+            } catch (const std::exception& e) {
                 json error_response;
                 error_response["success"] = false;
                 error_response["error_message"] = e.what();
+                res.status = 404;
+                res.set_content(error_response.dump(), "application/json");
+                return;
+            }
+
+            json response;
+            response["success"] = true;
+            response["upload_id"] = req.matches[1].str();
+            response["size"] = summary.size;
+            response["chunk_size"] = summary.chunk_size;
+            response["chunks"] = summary.chunks;
+            response["received"] = summary.received;
+            response["missing"] = missing;
+            res.set_content(response.dump(), "application/json");
+        });
+
+        // Fecha o upload: com todos os blocos contados, responde como /process;
+        // senão, 409 com quantos blocos faltam (a sessão continua aberta)
+        server.Post(R"(/upload/([0-9a-f]+)/finish)", [this](const httplib::Request& req, httplib::Response& res) {
+            UploadSessions::Summary summary;
+            bool complete = false;
+            try {
+                complete = uploads.finish(req.matches[1], summary);
+            } catch (const std::exception& e) {
+                json error_response;
+                error_response["success"] = false;
+                error_response["error_message"] = e.what();
+                res.status = 404;
+                res.set_content(error_response.dump(), "application/json");
+                return;
+            }
+
+            if (!complete) {
+                json error_response;
+                error_response["success"] = false;
+                error_response["error_message"] = "Upload incompleto";
+                error_response["chunks"] = summary.chunks;
+                error_response["received"] = summary.received;
+                res.status = 409;
+                res.set_content(error_response.dump(), "application/json");
+                return;
+            }
+
+            json response;
+            response["success"] = true;
+            response["letters_count"] = summary.letters;
+            response["numbers_count"] = summary.numbers;
+            response["total_characters"] = summary.size;
+            response["chunks"] = summary.chunks;
+            response["processing_time_ms"] =
+                std::chrono::duration_cast<std::chrono::milliseconds>(summary.elapsed).count();
+            response["error_message"] = "";
+            res.set_content(response.dump(), "application/json");
+        });
+
+        // Registro dinâmico de escravos
+        server.Post("/register", [this](const httplib::Request& req, httplib::Response& res) {
+            try {
+                json request_json = json::parse(req.body);
+                std::string name = request_json.at("name");
+                std::string type = request_json.at("type");
+                std::string endpoint = request_json.at("endpoint");
+                int slave_port = request_json.at("port");
+
+                // Sem host explícito, usar o endereço de origem da conexão
+                std::string host = request_json.value("host", "");
+                if (host.empty()) {
+                    host = req.remote_addr;
+                }
+
+                register_slave(name, host, slave_port, endpoint, type);
+
+                json response;
+                response["success"] = true;
+                response["lease_ttl_s"] = SLAVE_LEASE_TTL.count();
+                response["heartbeat_interval_s"] = SLAVE_HEARTBEAT_INTERVAL.count();
+                res.set_content(response.dump(), "application/json");
+
+            } catch (const std::exception& e) {
+                Logger::error_f("Registro de escravo inválido: %s", e.what());
+
+                json error_response;
+                error_response["success"] = false;
+                error_response["error"] = e.what();
+
+                res.status = 400;
+                res.set_content(error_response.dump(), "application/json");
+            }
+        });
+
+        server.Post("/heartbeat", [this](const httplib::Request& req, httplib::Response& res) {
+            try {
+                json request_json = json::parse(req.body);
+                std::string name = request_json.at("name");
+
+                bool known = renew_lease(name,
+                                         request_json.value("in_flight", 0),
+                                         request_json.value("requests_total", 0ULL),
+                                         request_json.value("load_average", 0.0));
+
+                json response;
+                response["success"] = known;
+                if (!known) {
+                    // Lease expirado ou master reiniciado: o escravo deve se registrar de novo
+                    response["error"] = "escravo desconhecido";
+                    res.status = 404;
+                }
+                res.set_content(response.dump(), "application/json");
+
+            } catch (const std::exception& e) {
+                json error_response;
+                error_response["success"] = false;
+                error_response["error"] = e.what();
+
+                res.status = 400;
+                res.set_content(error_response.dump(), "application/json");
+            }
+        });
+
+        server.Post("/deregister", [this](const httplib::Request& req, httplib::Response& res) {
+            try {
+                json request_json = json::parse(req.body);
+                bool removed = remove_slave(request_json.at("name"));
+
+                json response;
+                response["success"] = removed;
+                res.status = removed ? 200 : 404;
+                res.set_content(response.dump(), "application/json");
+
+            } catch (const std::exception& e) {
+                json error_response;
+                error_response["success"] = false;
+                error_response["error"] = e.what();
+
+                res.status = 400;
+                res.set_content(error_response.dump(), "application/json");
+            }
+        });
+
+        // Modo pull: long poll de tarefas pelos workers
+        server.Get("/work/poll", [this](const httplib::Request& req, httplib::Response& res) {
+            std::string worker = req.has_param("worker") ? req.get_param_value("worker") : req.remote_addr;
+            std::string prefer = req.get_param_value("prefer");
+
+            std::chrono::milliseconds wait = MAX_POLL_WAIT;
+            if (req.has_param("wait_ms")) {
+                try {
+                    wait = std::min(MAX_POLL_WAIT, std::chrono::milliseconds(std::stol(req.get_param_value("wait_ms"))));
+                } catch (const std::exception&) {
+                    // Valor inválido: usar a espera padrão
+                }
+            }
+
+            WorkQueue::Lease lease;
+            if (!work_queue.poll(worker, prefer, wait, lease)) {
+                res.status = 204;
+                return;
+            }
+
+            // Fatia vai crua no corpo: sem escapar JSON nem validar UTF-8
+            res.set_header("X-Task-Id", std::to_string(lease.task_id));
+            res.set_header("X-Task-Type", lease.type);
+            res.set_header(tracing::REQUEST_ID_HEADER, lease.trace.request_id);
+            res.set_header(tracing::SAMPLED_HEADER, lease.trace.sampled ? "1" : "0");
+            res.set_content(lease.data, "application/octet-stream");
+        });
+
+        server.Post("/work/result", [this](const httplib::Request& req, httplib::Response& res) {
+            try {
+                json request_json = json::parse(req.body);
+
+                WorkResult result;
+                result.success = request_json.value("success", false);
+                result.count = request_json.value("count", 0LL);
+                result.error = request_json.value("error", "");
+
+                bool accepted = work_queue.complete(request_json.at("task_id").get<uint64_t>(), result);
+
+                json response;
+                response["accepted"] = accepted;
+                res.set_content(response.dump(), "application/json");
+
+            } catch (const std::exception& e) {
+                json error_response;
+                error_response["accepted"] = false;
+                error_response["error"] = e.what();
 
                 res.status = 400;
                 res.set_content(error_response.dump(), "application/json");
@@ -99,10 +1084,20 @@ bool MasterServer::start() {
         });
 
         // CORS headers
+        // Cabeçalhos lidos; o corpo ainda não. O intervalo até o handler é a recepção do corpo
+        server.set_pre_routing_handler([](const httplib::Request&, httplib::Response&) {
+            request_headers_us = tracing::now_us();
+            return httplib::Server::HandlerResponse::Unhandled;
+        });
+
         server.set_post_routing_handler([](const httplib::Request&, httplib::Response& res) {
             res.set_header("Access-Control-Allow-Origin", "*");
-            res.set_header("Access-Control-Allow-Methods", "GET, POST, OPTIONS");
-            res.set_header("Access-Control-Allow-Headers", "Content-Type");
+            res.set_header("Access-Control-Allow-Methods", "GET, POST, PUT, OPTIONS");
+            res.set_header("Access-Control-Allow-Headers",
+                           "Content-Type, Content-Encoding, X-Priority, X-Client-Id, X-Request-Id, X-Chunk-Hash");
+            res.set_header("Access-Control-Expose-Headers", "X-Request-Id, Accept-Encoding");
+            // Codificações aceitas no corpo de /process e dos blocos de /upload
+            res.set_header("Accept-Encoding", compression::accepted());
         });
 
         Logger::info_f("Iniciando servidor mestre na porta %d", port);
@@ -111,6 +1106,12 @@ bool MasterServer::start() {
         // Health check inicial dos escravos
         update_slaves_health();
 
+        // Expiração de leases e health checks periódicos
+        if (maintenance_thread.joinable()) {
+            maintenance_thread.join();
+        }
+        maintenance_thread = std::thread(&MasterServer::maintenance_loop, this);
+
         Logger::info("Rotas configuradas no servidor mestre");
 
         // Iniciar servidor (bloqueia thread)
@@ -142,157 +1143,271 @@ bool MasterServer::is_running() const {
     return running.load();
 }
 
-std::string MasterServer::process_text_request(const std::string& text) {
+bool MasterServer::is_plain_text(const httplib::Request& req) {
+    std::string content_type = req.get_header_value("Content-Type");
+    return content_type.compare(0, 10, "text/plain") == 0;
+}
+
+bool MasterServer::request_encoding(const httplib::Request& req, httplib::Response& res,
+                                    compression::Encoding& encoding) {
+    try {
+        encoding = compression::parse(req.get_header_value("Content-Encoding"));
+        return true;
+    } catch (const std::invalid_argument& e) {
+        json error_response;
+        error_response["success"] = false;
+        error_response["error_message"] = e.what();
+
+        res.status = 415;
+        res.set_content(error_response.dump(), "application/json");
+        return false;
+    }
+}
+
+PriorityClass MasterServer::classify_request(const httplib::Request& req) const {
+    // Classe explícita no cabeçalho tem precedência
+    PriorityClass cls = PriorityClass::NORMAL;
+    if (RequestScheduler::parse_class(req.get_header_value("X-Priority"), cls)) {
+        return cls;
+    }
+
+    // Senão, pela identidade do cliente (cabeçalho ou endereço de origem)
+    std::string client_id = req.get_header_value("X-Client-Id");
+    if (client_id.empty()) {
+        client_id = req.remote_addr;
+    }
+
+    auto it = client_priorities.find(client_id);
+    if (it != client_priorities.end()) {
+        return it->second;
+    }
+
+    return PriorityClass::NORMAL;
+}
+
+std::string MasterServer::process_text_request(const std::string& text, const RequestContext& request,
+                                               compression::Encoding encoding) {
+    bool encoded = encoding != compression::Encoding::IDENTITY;
+
+    // As fatias da fila de trabalho são do texto: só nesse modo o mestre descomprime
+    if (encoded && pull_mode && work_queue.has_active_workers(WORKER_ACTIVE_WINDOW)) {
+        return process_text_request(compression::decompress(encoding, text), request);
+    }
+
     json result;
     result["success"] = false;
     result["letters_count"] = 0;
     result["numbers_count"] = 0;
-    result["total_characters"] = text.length();
+    result["total_characters"] = encoded ? 0 : text.length();
     result["error_message"] = "";
 
     try {
-        // Encontrar escravos saudáveis por tipo
-        SlaveInfo* letters_slave = nullptr;
-        SlaveInfo* numbers_slave = nullptr;
-
-        for (const auto& slave : slaves) {
-            if (slave->type == "letters" && slave->is_healthy) {
-                letters_slave = slave.get();
-            } else if (slave->type == "numbers" && slave->is_healthy) {
-                numbers_slave = slave.get();
-            }
-        }
+        std::string letters_result;
+        std::string numbers_result;
 
-        if (!letters_slave) {
-            throw std::runtime_error("Nenhum escravo de letras disponível");
+        // Modo pull com workers ativos: fatias vão para a fila compartilhada
+        if (pull_mode && work_queue.has_active_workers(WORKER_ACTIVE_WINDOW)) {
+            Logger::debug_f("Enfileirando fatias para os workers (modo pull)");
+
+            request.tracker.stage("work_queue");
+            tracing::Span work_span(request.trace, "work_queue");
+            metrics::ScopedTimer wait_timer(master_metrics().work_queue);
+
+            WorkQueue::Batch letters_batch = work_queue.submit("letters", text.data(), text.size(),
+                                                               shard_size, request.trace);
+            WorkQueue::Batch numbers_batch = work_queue.submit("numbers", text.data(), text.size(),
+                                                               shard_size, request.trace);
+
+            auto deadline = std::chrono::steady_clock::now() + WORK_DEADLINE;
+            letters_result = work_result_json(work_queue.wait(letters_batch, deadline));
+            numbers_result = work_result_json(work_queue.wait(numbers_batch, deadline));
+        } else {
+            request.tracker.stage("dispatch");
+            std::tie(letters_result, numbers_result) = dispatch_to_slaves(text, encoding, request);
         }
-        if (!numbers_slave) {
-            throw std::runtime_error("Nenhum escravo de números disponível");
+
+        // Combinar resultados
+        metrics::ScopedTimer merge_timer(master_metrics().merge);
+        request.tracker.stage("merge");
+        tracing::Span merge_span(request.trace, "merge");
+        size_t characters = text.length();
+        if (encoded) {
+            characters = json::parse(letters_result).value("processed_characters", static_cast<size_t>(0));
         }
+        result = merge_results(letters_result, numbers_result, characters);
 
-        // Delegar processamento para escravos EM PARALELO usando threads
-        Logger::info("Iniciando processamento paralelo com threads");
+    } catch (const std::exception& e) {
+        result["error_message"] = e.what();
+        LOG_RATE_LIMITED(LogLevel::ERROR, 5, "Erro no processamento distribuído: %s", e.what());
+    }
 
-        // Criar futures para execução paralela
-        std::future<std::string> letters_future = std::async(std::launch::async,
-            [this, letters_slave, &text]() {
-                Logger::debug("Thread de letras iniciada");
-                return delegate_to_slave(*letters_slave, text);
-            });
+    return result.dump();
+}
 
-        std::future<std::string> numbers_future = std::async(std::launch::async,
-            [this, numbers_slave, &text]() {
-                Logger::debug("Thread de números iniciada");
-                return delegate_to_slave(*numbers_slave, text);
-            });
+std::pair<std::string, std::string> MasterServer::dispatch_to_slaves(const std::string& text,
+                                                                     compression::Encoding encoding,
+                                                                     const RequestContext& request) {
+    // Encontrar escravos saudáveis por tipo (o de maior folga no limite).
+    // O shared_ptr mantém o escravo vivo mesmo se ele for removido durante a chamada
+    std::shared_ptr<SlaveInfo> letters_slave = select_slave("letters");
+    std::shared_ptr<SlaveInfo> numbers_slave = select_slave("numbers");
 
-        // Aguardar resultados das duas threads
-        Logger::debug("Aguardando resultados das threads paralelas");
-        std::string letters_result = letters_future.get();
-        std::string numbers_result = numbers_future.get();
-        Logger::info("Processamento paralelo concluído");
+    if (!letters_slave) {
+        throw std::runtime_error("Nenhum escravo de letras disponível");
+    }
+    if (!numbers_slave) {
+        throw std::runtime_error("Nenhum escravo de números disponível");
+    }
 
-        // Combinar resultados
-        json letters_json = json::parse(letters_result);
-        json numbers_json = json::parse(numbers_result);
+    // Delegar processamento para escravos EM PARALELO usando threads
+    Logger::debug_f("Iniciando processamento paralelo com threads");
 
-        if (letters_json["success"] && numbers_json["success"]) {
-            result["success"] = true;
-            result["letters_count"] = letters_json["count"];
-            result["numbers_count"] = numbers_json["count"];
+    // Criar futures para execução paralela
+    std::future<std::string> letters_future = std::async(std::launch::async,
+        [this, letters_slave, &text, encoding, &request]() {
+            Logger::debug_f("Thread de letras iniciada");
+            alloc_tracking::Adopt adopt(request.allocations);
+            return delegate_to_slave(*letters_slave, text, encoding, request);
+        });
 
-            Logger::info_f("Processamento distribuído concluído: %d letras, %d números",
-                          (int)result["letters_count"], (int)result["numbers_count"]);
-        } else {
-            std::string error = "Erro nos escravos: ";
-            if (!letters_json["success"]) {
-                error += "letras(" + letters_json.value("error", "desconhecido") + ") ";
-            }
-            if (!numbers_json["success"]) {
-                error += "números(" + numbers_json.value("error", "desconhecido") + ")";
-            }
-            result["error_message"] = error;
+    std::future<std::string> numbers_future = std::async(std::launch::async,
+        [this, numbers_slave, &text, encoding, &request]() {
+            Logger::debug_f("Thread de números iniciada");
+            alloc_tracking::Adopt adopt(request.allocations);
+            return delegate_to_slave(*numbers_slave, text, encoding, request);
+        });
+
+    // Aguardar resultados das duas threads
+    Logger::debug_f("Aguardando resultados das threads paralelas");
+    std::string letters_result = letters_future.get();
+    std::string numbers_result = numbers_future.get();
+    Logger::debug_f("Processamento paralelo concluído");
+
+    return {letters_result, numbers_result};
+}
+
+std::string MasterServer::work_result_json(const WorkResult& result) {
+    // Mesmo formato da resposta dos escravos, para a combinação ser única
+    json response;
+    response["success"] = result.success;
+    response["count"] = result.count;
+    if (!result.success) {
+        response["error"] = result.error;
+    }
+    return response.dump();
+}
+
+std::shared_ptr<SlaveInfo> MasterServer::select_slave(const std::string& type) {
+    // Caminho quente: leitura sem lock da snapshot atual
+    auto snapshot = registry.read();
+
+    std::shared_ptr<SlaveInfo> best;
+    int best_headroom = 0;
+
+    for (const auto& slave : snapshot.slaves()) {
+        if (slave->type != type || !slave->is_healthy) {
+            continue;
         }
 
-    } catch (const std::exception& e) {
-        result["error_message"] = e.what();
-        Logger::error_f("Erro no processamento distribuído: %s", e.what());
+        int headroom = slave->limiter.headroom();
+        if (!best || headroom > best_headroom) {
+            best = slave;
+            best_headroom = headroom;
+        }
     }
 
-    return result.dump();
+    return best;
 }
 
-std::string MasterServer::delegate_to_slave(const SlaveInfo& slave, const std::string& data) {
+std::string MasterServer::delegate_to_slave(SlaveInfo& slave, const std::string& data,
+                                           compression::Encoding encoding, const RequestContext& request) {
     Logger::debug_f("Delegando para escravo %s (%s:%d)",
                    slave.name.c_str(), slave.host.c_str(), slave.port);
 
-    try {
-        httplib::Client client(slave.host, slave.port);
-        client.set_connection_timeout(5, 0);
-        client.set_read_timeout(15, 0);
+    // Duração inclui a espera por vaga no limite do escravo
+    MasterMetrics& stats = master_metrics();
+    bool letters = slave.type == "letters";
+    metrics::ScopedTimer call_timer(letters ? stats.letters_call : stats.numbers_call);
+    metrics::Counter& call_errors = letters ? stats.letters_call_errors : stats.numbers_call_errors;
+    const char* call_name = letters ? "letters_rpc" : "numbers_rpc";
+    tracing::Span call_span(request.trace, call_name);
+    request.tracker.add_target(slave.name);
 
-        json request_data;
-        request_data["text"] = data;
+    // Registra a duração da chamada nas etapas da requisição em qualquer saída
+    struct CallTiming {
+        RequestTracker::Handle& tracker;
+        const char* name;
+        std::chrono::steady_clock::time_point start;
+        ~CallTiming() { tracker.add_timing(name, std::chrono::steady_clock::now() - start); }
+    } call_timing{request.tracker, call_name, std::chrono::steady_clock::now()};
 
-        httplib::Headers headers = {
-            {"Content-Type", "application/json"}
-        };
+    // Respeitar o limite adaptativo: aguardar brevemente por uma vaga
+    if (!slave.limiter.acquire(SLAVE_QUEUE_TIMEOUT)) {
+        LOG_RATE_LIMITED(LogLevel::WARNING, 1, "Escravo %s no limite de concorrência (%d chamadas)",
+                         slave.name.c_str(), slave.limiter.limit());
+        call_errors.add();
 
-        auto response = client.Post(slave.endpoint.c_str(), headers,
-                                   request_data.dump(), "application/json");
+        json error_response;
+        error_response["success"] = false;
+        error_response["error"] = "escravo sobrecarregado";
+        error_response["count"] = 0;
+        return error_response.dump();
+    }
 
-        if (!response) {
-            throw std::runtime_error("Falha na conexão com escravo " + slave.name);
-        }
+    auto call_start = std::chrono::steady_clock::now();
+    auto call_rtt = [&call_start]() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - call_start);
+    };
 
-        if (response->status != 200) {
-            throw std::runtime_error("Escravo " + slave.name + " retornou status " +
-                                   std::to_string(response->status));
-        }
+    try {
+        std::string response = encoding == compression::Encoding::IDENTITY
+                                   ? transport->call(slave, data, request.trace)
+                                   : transport->forward(slave, data, encoding, request.trace);
+
+        slave.limiter.release(call_rtt(), true);
 
         Logger::debug_f("Resposta do escravo %s recebida", slave.name.c_str());
-        return response->body;
+        return response;
 
     } catch (const std::exception& e) {
+        slave.limiter.release(call_rtt(), false);
+        call_errors.add();
+
         json error_response;
         error_response["success"] = false;
         error_response["error"] = e.what();
         error_response["count"] = 0;
 
-        Logger::error_f("Erro ao comunicar com escravo %s: %s",
-                       slave.name.c_str(), e.what());
+        LOG_RATE_LIMITED(LogLevel::ERROR, 5, "Erro ao comunicar com escravo %s: %s",
+                         slave.name.c_str(), e.what());
 
         return error_response.dump();
     }
 }
 
 bool MasterServer::check_slave_health(const SlaveInfo& slave) {
-    try {
-        httplib::Client client(slave.host, slave.port);
-        client.set_connection_timeout(3, 0);
-        client.set_read_timeout(5, 0);
-
-        auto response = client.Get("/health");
-
-        return response && response->status == 200;
-
-    } catch (const std::exception&) {
-        return false;
-    }
+    return transport->check_health(slave);
 }
 
 void MasterServer::update_slaves_health() {
-    Logger::debug("Atualizando status de saúde dos escravos");
+    Logger::debug_f("Atualizando status de saúde dos escravos");
+
+    // Escravos dinâmicos são acompanhados pelos heartbeats; aqui só os estáticos.
+    // A verificação de rede acontece fora do lock
+    for (auto& slave : registry.copy()) {
+        if (slave->dynamic) {
+            continue;
+        }
 
-    for (auto& slave : slaves) {
-        bool old_status = slave->is_healthy;
-        slave->is_healthy = check_slave_health(*slave);
+        bool healthy = check_slave_health(*slave);
+        bool old_status = slave->is_healthy.exchange(healthy);
 
-        if (old_status != slave->is_healthy) {
+        if (old_status != healthy) {
             Logger::info_f("Escravo %s mudou status: %s -> %s",
                           slave->name.c_str(),
                           old_status ? "saudável" : "indisponível",
-                          slave->is_healthy ? "saudável" : "indisponível");
+                          healthy ? "saudável" : "indisponível");
         }
     }
 }
\ No newline at end of file
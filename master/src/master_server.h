@@ -4,19 +4,29 @@
 #include <vector>
 #include <memory>
 #include <atomic>
+#include <chrono>
+#include <map>
+#include <thread>
+#include <utility>
+#include "request_scheduler.h"
+#include "request_tracker.h"
+#include "alloc_tracking.h"
+#include "compression.h"
+#include "slave_registry.h"
+#include "slave_transport.h"
+#include "work_queue.h"
+#include "upload_sessions.h"
 
-// Estrutura para informações do escravo
-struct SlaveInfo {
-    std::string name;
-    std::string host;
-    int port;
-    std::string endpoint;
-    std::string type;
-    bool is_healthy = false;
+namespace httplib {
+    struct Request;
+    struct Response;
+}
 
-    SlaveInfo(const std::string& n, const std::string& h, int p,
-              const std::string& e, const std::string& t)
-        : name(n), host(h), port(p), endpoint(e), type(t) {}
+// Contexto de uma requisição /process repassado às etapas de despacho
+struct RequestContext {
+    const tracing::Context& trace;
+    RequestTracker::Handle& tracker;
+    alloc_tracking::Scope& allocations;
 };
 
 // Servidor mestre para coordenação dos escravos
@@ -24,7 +34,28 @@ class MasterServer {
 private:
     int port;
     std::atomic<bool> running;
-    std::vector<std::unique_ptr<SlaveInfo>> slaves;
+    SlaveRegistry registry;
+
+    // Modo pull: workers genéricos buscam fatias na fila do mestre
+    WorkQueue work_queue;
+    bool pull_mode = false;
+    size_t shard_size;
+
+    // Manutenção periódica: expiração de leases e health checks
+    std::thread maintenance_thread;
+
+    // Escalonamento por classe de prioridade
+    RequestScheduler scheduler;
+    std::map<std::string, PriorityClass> client_priorities;
+
+    // Uploads em partes em andamento (/upload)
+    UploadSessions uploads;
+
+    // Raiz do volume compartilhado lido por /process/path (vazia = desabilitado)
+    std::string ingest_root;
+
+    // Chamadas aos escravos no modo push (HTTP por padrão)
+    std::shared_ptr<SlaveTransport> transport;
 
 public:
     explicit MasterServer(int server_port);
@@ -34,6 +65,30 @@ public:
     void add_slave(const std::string& name, const std::string& host, int port,
                    const std::string& endpoint, const std::string& type);
 
+    // Registro dinâmico (chamado pelos endpoints /register, /heartbeat, /deregister)
+    void register_slave(const std::string& name, const std::string& host, int port,
+                        const std::string& endpoint, const std::string& type);
+    bool renew_lease(const std::string& name, int in_flight,
+                     unsigned long long requests_total, double load_average);
+    bool remove_slave(const std::string& name);
+
+    // Modo de despacho: push (mestre chama escravos) ou pull (workers buscam tarefas)
+    void set_pull_mode(bool enabled);
+    void set_shard_size(size_t bytes);
+
+    // Configuração do escalonador
+    void set_dispatch_slots(size_t slots);
+    void set_client_priority(const std::string& client_id, PriorityClass cls);
+
+    // Persiste as sessões de /upload em dir para retomá-las após um reinício
+    bool set_upload_state_dir(const std::string& dir);
+
+    // Habilita /process/path para arquivos dentro de root
+    bool set_ingest_root(const std::string& root);
+
+    // Troca o transporte das chamadas aos escravos (antes de start())
+    void set_transport(std::shared_ptr<SlaveTransport> slave_transport);
+
     // Controle do servidor
     bool start();
     void stop();
@@ -45,6 +100,22 @@ public:
 
 private:
     // Métodos auxiliares
-    std::string process_text_request(const std::string& text);
-    std::string delegate_to_slave(const SlaveInfo& slave, const std::string& data);
+    PriorityClass classify_request(const httplib::Request& req) const;
+    static bool is_plain_text(const httplib::Request& req);
+    // Content-Encoding do corpo; sem suporte, responde 415 e devolve false
+    static bool request_encoding(const httplib::Request& req, httplib::Response& res,
+                                 compression::Encoding& encoding);
+    // Com `encoding`, o texto ainda está comprimido pelo cliente e vai assim
+    // aos escravos; o total de caracteres vem da resposta deles
+    std::string process_text_request(const std::string& text, const RequestContext& request,
+                                     compression::Encoding encoding = compression::Encoding::IDENTITY);
+    std::pair<std::string, std::string> dispatch_to_slaves(const std::string& text,
+                                                           compression::Encoding encoding,
+                                                           const RequestContext& request);
+    std::shared_ptr<SlaveInfo> select_slave(const std::string& type);
+    void expire_leases();
+    void maintenance_loop();
+    std::string delegate_to_slave(SlaveInfo& slave, const std::string& data,
+                                  compression::Encoding encoding, const RequestContext& request);
+    std::string work_result_json(const WorkResult& result);
 };
\ No newline at end of file
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+
+// Profiler de CPU por amostragem, usado por /debug/profile.
+//
+// Durante a coleta, o ITIMER_PROF dispara SIGPROF a cada 1/frequency
+// segundos de CPU consumida pelo processo; o handler copia a pilha da
+// thread interrompida para um buffer pré-alocado, reservando a posição
+// com um fetch_add (sem lock nem alocação dentro do sinal). Fora da coleta
+// o timer fica desligado e nenhum sinal é gerado: o custo é zero.
+namespace profiler {
+
+struct Options {
+    int seconds = 10;
+    int frequency = 99;  // Hz; evita sincronizar com timers de 100 Hz
+};
+
+struct Profile {
+    std::string folded;     // "main;f;g 12\n", pronto para flamegraph.pl
+    size_t samples = 0;
+    size_t dropped = 0;     // amostras perdidas com o buffer cheio
+};
+
+// Bloqueia a thread chamadora pela duração da coleta. Retorna false se já
+// houver uma coleta em andamento (só uma por processo, o timer é global)
+bool collect(const Options& options, Profile& profile);
+
+} // namespace profiler
@@ -0,0 +1,168 @@
+#include "request_scheduler.h"
+#include <algorithm>
+
+namespace {
+    // Custo mínimo (em bytes) para que requisições vazias não tenham custo zero
+    constexpr double MIN_COST_BYTES = 1024.0;
+
+    size_t index_of(PriorityClass cls) {
+        return static_cast<size_t>(cls);
+    }
+}
+
+RequestScheduler::Slot::Slot(Slot&& other) noexcept : scheduler(other.scheduler) {
+    other.scheduler = nullptr;
+}
+
+RequestScheduler::Slot& RequestScheduler::Slot::operator=(Slot&& other) noexcept {
+    if (this != &other) {
+        if (scheduler) {
+            scheduler->release();
+        }
+        scheduler = other.scheduler;
+        other.scheduler = nullptr;
+    }
+    return *this;
+}
+
+RequestScheduler::Slot::~Slot() {
+    if (scheduler) {
+        scheduler->release();
+    }
+}
+
+RequestScheduler::RequestScheduler(size_t dispatch_slots)
+    : slots(std::max<size_t>(1, dispatch_slots)), weights{8.0, 4.0, 1.0} {}
+
+RequestScheduler::Slot RequestScheduler::acquire(PriorityClass cls, size_t cost_bytes,
+                                                 std::chrono::milliseconds max_wait) {
+    size_t idx = index_of(cls);
+    std::unique_lock<std::mutex> lock(mutex);
+
+    double cost = std::max(MIN_COST_BYTES, static_cast<double>(cost_bytes));
+    double start_tag = std::max(virtual_time, last_finish[idx]);
+
+    Waiter waiter;
+    waiter.finish_tag = start_tag + cost / weights[idx];
+    last_finish[idx] = waiter.finish_tag;
+
+    queues[idx].push_back(&waiter);
+    dispatch_locked();
+
+    if (!waiter.cv.wait_for(lock, max_wait, [&waiter]() { return waiter.granted; })) {
+        // Desistiu: sair da fila sem consumir vaga
+        auto& queue = queues[idx];
+        queue.erase(std::remove(queue.begin(), queue.end(), &waiter), queue.end());
+        return Slot();
+    }
+
+    return Slot(this);
+}
+
+void RequestScheduler::release() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (slots_in_use > 0) {
+        slots_in_use--;
+    }
+    dispatch_locked();
+}
+
+void RequestScheduler::dispatch_locked() {
+    while (slots_in_use < slots) {
+        std::deque<Waiter*>* best_queue = nullptr;
+        size_t best_idx = 0;
+
+        for (size_t i = 0; i < CLASS_COUNT; i++) {
+            if (queues[i].empty()) {
+                continue;
+            }
+            if (!best_queue || queues[i].front()->finish_tag < best_queue->front()->finish_tag) {
+                best_queue = &queues[i];
+                best_idx = i;
+            }
+        }
+
+        if (!best_queue) {
+            break;
+        }
+
+        Waiter* next = best_queue->front();
+        best_queue->pop_front();
+
+        virtual_time = std::max(virtual_time, next->finish_tag);
+        slots_in_use++;
+        dispatched_count[best_idx]++;
+
+        next->granted = true;
+        next->cv.notify_one();
+    }
+
+    // Sistema ocioso: reiniciar o relógio virtual evita que marcas antigas
+    // penalizem a próxima rajada
+    if (slots_in_use == 0) {
+        bool all_empty = std::all_of(queues.begin(), queues.end(),
+                                     [](const std::deque<Waiter*>& q) { return q.empty(); });
+        if (all_empty) {
+            virtual_time = 0.0;
+            last_finish.fill(0.0);
+        }
+    }
+}
+
+void RequestScheduler::set_capacity(size_t dispatch_slots) {
+    std::lock_guard<std::mutex> lock(mutex);
+    slots = std::max<size_t>(1, dispatch_slots);
+    dispatch_locked();
+}
+
+void RequestScheduler::set_weight(PriorityClass cls, double weight) {
+    std::lock_guard<std::mutex> lock(mutex);
+    weights[index_of(cls)] = std::max(0.01, weight);
+}
+
+size_t RequestScheduler::capacity() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return slots;
+}
+
+size_t RequestScheduler::in_use() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return slots_in_use;
+}
+
+size_t RequestScheduler::queued(PriorityClass cls) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return queues[index_of(cls)].size();
+}
+
+unsigned long long RequestScheduler::dispatched(PriorityClass cls) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return dispatched_count[index_of(cls)];
+}
+
+double RequestScheduler::weight(PriorityClass cls) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return weights[index_of(cls)];
+}
+
+const char* RequestScheduler::class_name(PriorityClass cls) {
+    switch (cls) {
+        case PriorityClass::INTERACTIVE: return "interactive";
+        case PriorityClass::NORMAL:      return "normal";
+        case PriorityClass::BATCH:       return "batch";
+        default:                         return "normal";
+    }
+}
+
+bool RequestScheduler::parse_class(const std::string& name, PriorityClass& cls) {
+    if (name == "interactive") {
+        cls = PriorityClass::INTERACTIVE;
+    } else if (name == "normal") {
+        cls = PriorityClass::NORMAL;
+    } else if (name == "batch") {
+        cls = PriorityClass::BATCH;
+    } else {
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+
+// Classes de prioridade das requisições
+enum class PriorityClass {
+    INTERACTIVE,
+    NORMAL,
+    BATCH
+};
+
+// Escalonador justo ponderado (WFQ) para o despacho aos escravos.
+//
+// Cada requisição recebe uma marca de término virtual proporcional ao seu
+// tamanho dividido pelo peso da classe; as vagas de despacho livres vão
+// sempre para a menor marca. Assim requisições pequenas e interativas
+// passam à frente de lotes grandes sem que o lote fique sem progresso.
+class RequestScheduler {
+public:
+    static constexpr size_t CLASS_COUNT = 3;
+
+    // Vaga de despacho concedida; é devolvida ao ser destruída
+    class Slot {
+    public:
+        Slot() = default;
+        Slot(Slot&& other) noexcept;
+        Slot& operator=(Slot&& other) noexcept;
+        Slot(const Slot&) = delete;
+        Slot& operator=(const Slot&) = delete;
+        ~Slot();
+
+        explicit operator bool() const { return scheduler != nullptr; }
+
+    private:
+        friend class RequestScheduler;
+        explicit Slot(RequestScheduler* s) : scheduler(s) {}
+        RequestScheduler* scheduler = nullptr;
+    };
+
+    explicit RequestScheduler(size_t dispatch_slots);
+
+    // Bloqueia até a requisição ser escalonada ou até max_wait expirar
+    Slot acquire(PriorityClass cls, size_t cost_bytes, std::chrono::milliseconds max_wait);
+
+    void set_capacity(size_t dispatch_slots);
+    void set_weight(PriorityClass cls, double weight);
+
+    // Estatísticas (para /health)
+    size_t capacity() const;
+    size_t in_use() const;
+    size_t queued(PriorityClass cls) const;
+    unsigned long long dispatched(PriorityClass cls) const;
+    double weight(PriorityClass cls) const;
+
+    static const char* class_name(PriorityClass cls);
+    static bool parse_class(const std::string& name, PriorityClass& cls);
+
+private:
+    struct Waiter {
+        double finish_tag;
+        bool granted = false;
+        std::condition_variable cv;
+    };
+
+    mutable std::mutex mutex;
+    size_t slots;
+    size_t slots_in_use = 0;
+    double virtual_time = 0.0;
+
+    std::array<double, CLASS_COUNT> weights;
+    std::array<double, CLASS_COUNT> last_finish{};
+    std::array<std::deque<Waiter*>, CLASS_COUNT> queues;
+    std::array<unsigned long long, CLASS_COUNT> dispatched_count{};
+
+    void release();
+    void dispatch_locked();
+};
@@ -0,0 +1,189 @@
+#include "request_tracker.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+
+using json = nlohmann::json;
+
+constexpr std::chrono::minutes RequestTracker::SLOWEST_WINDOW;
+
+static uint64_t elapsed_us(std::chrono::steady_clock::time_point from,
+                           std::chrono::steady_clock::time_point to) {
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(to - from).count();
+    return us > 0 ? static_cast<uint64_t>(us) : 0;
+}
+
+RequestTracker& RequestTracker::instance() {
+    static RequestTracker tracker;
+    return tracker;
+}
+
+RequestTracker::Handle::Handle(const std::string& request_id, const char* route, size_t bytes,
+                               const int& response_status)
+    : entry(RequestTracker::instance().begin(request_id, route, bytes)), status(response_status) {}
+
+RequestTracker::Handle::~Handle() {
+    {
+        std::lock_guard<std::mutex> lock(entry->mutex);
+        entry->status = status == -1 ? 200 : status;
+    }
+    RequestTracker::instance().finish(entry);
+}
+
+void RequestTracker::Handle::stage(const char* name) {
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(entry->mutex);
+    entry->stages.emplace_back(entry->stage, elapsed_us(entry->stage_start, now));
+    entry->stage = name;
+    entry->stage_start = now;
+}
+
+void RequestTracker::Handle::add_timing(const char* name, std::chrono::steady_clock::duration elapsed) {
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+    std::lock_guard<std::mutex> lock(entry->mutex);
+    entry->stages.emplace_back(name, us > 0 ? static_cast<uint64_t>(us) : 0);
+}
+
+void RequestTracker::Handle::add_target(const std::string& target) {
+    std::lock_guard<std::mutex> lock(entry->mutex);
+    entry->targets.push_back(target);
+}
+
+std::shared_ptr<RequestTracker::Entry> RequestTracker::begin(const std::string& request_id,
+                                                             const char* route, size_t bytes) {
+    auto entry = std::make_shared<Entry>();
+    entry->id = next_id.fetch_add(1, std::memory_order_relaxed);
+    entry->request_id = request_id;
+    entry->route = route;
+    entry->bytes = bytes;
+    entry->start = std::chrono::steady_clock::now();
+    entry->stage_start = entry->start;
+
+    Shard& shard = shards[entry->id % SHARDS];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.entries.emplace(entry->id, entry);
+    return entry;
+}
+
+void RequestTracker::finish(const std::shared_ptr<Entry>& entry) {
+    auto now = std::chrono::steady_clock::now();
+    {
+        Shard& shard = shards[entry->id % SHARDS];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.entries.erase(entry->id);
+    }
+
+    uint64_t total_us = elapsed_us(entry->start, now);
+    if (total_us <= slowest_threshold_us.load(std::memory_order_relaxed) &&
+        now.time_since_epoch().count() < slowest_expiry.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(entry->mutex);
+        entry->stages.emplace_back(entry->stage, elapsed_us(entry->stage_start, now));
+        entry->stage = "done";
+    }
+
+    std::lock_guard<std::mutex> lock(slowest_mutex);
+    slowest.erase(std::remove_if(slowest.begin(), slowest.end(),
+                                 [now](const Finished& f) { return now - f.finished_at > SLOWEST_WINDOW; }),
+                  slowest.end());
+
+    if (slowest.size() < SLOWEST_CAPACITY) {
+        slowest.push_back({entry, total_us, now});
+    } else {
+        auto fastest = std::min_element(slowest.begin(), slowest.end(),
+                                        [](const Finished& a, const Finished& b) { return a.total_us < b.total_us; });
+        if (fastest->total_us < total_us) {
+            *fastest = {entry, total_us, now};
+        }
+    }
+    update_threshold_locked();
+}
+
+void RequestTracker::update_threshold_locked() {
+    if (slowest.size() < SLOWEST_CAPACITY) {
+        slowest_threshold_us.store(0, std::memory_order_relaxed);
+        slowest_expiry.store(0, std::memory_order_relaxed);
+        return;
+    }
+
+    uint64_t threshold = UINT64_MAX;
+    auto oldest = slowest.front().finished_at;
+    for (const Finished& f : slowest) {
+        threshold = std::min(threshold, f.total_us);
+        oldest = std::min(oldest, f.finished_at);
+    }
+    slowest_threshold_us.store(threshold, std::memory_order_relaxed);
+    slowest_expiry.store((oldest + SLOWEST_WINDOW).time_since_epoch().count(), std::memory_order_relaxed);
+}
+
+static json entry_stages(const std::vector<std::pair<const char*, uint64_t>>& stages) {
+    json result = json::array();
+    for (const auto& stage : stages) {
+        result.push_back({{"stage", stage.first}, {"ms", stage.second / 1000.0}});
+    }
+    return result;
+}
+
+std::string RequestTracker::render() const {
+    auto now = std::chrono::steady_clock::now();
+
+    std::vector<std::shared_ptr<Entry>> active;
+    for (const Shard& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (const auto& item : shard.entries) {
+            active.push_back(item.second);
+        }
+    }
+    std::sort(active.begin(), active.end(),
+              [](const auto& a, const auto& b) { return a->start < b->start; });
+
+    json in_flight = json::array();
+    for (const auto& entry : active) {
+        std::lock_guard<std::mutex> lock(entry->mutex);
+        in_flight.push_back({
+            {"request_id", entry->request_id},
+            {"route", entry->route},
+            {"age_ms", elapsed_us(entry->start, now) / 1000.0},
+            {"bytes", entry->bytes},
+            {"stage", entry->stage},
+            {"stage_age_ms", elapsed_us(entry->stage_start, now) / 1000.0},
+            {"targets", entry->targets},
+            {"stages", entry_stages(entry->stages)}
+        });
+    }
+
+    std::vector<Finished> finished;
+    {
+        std::lock_guard<std::mutex> lock(slowest_mutex);
+        for (const Finished& f : slowest) {
+            if (now - f.finished_at <= SLOWEST_WINDOW) {
+                finished.push_back(f);
+            }
+        }
+    }
+    std::sort(finished.begin(), finished.end(),
+              [](const Finished& a, const Finished& b) { return a.total_us > b.total_us; });
+
+    json slow = json::array();
+    for (const Finished& f : finished) {
+        std::lock_guard<std::mutex> lock(f.entry->mutex);
+        slow.push_back({
+            {"request_id", f.entry->request_id},
+            {"route", f.entry->route},
+            {"total_ms", f.total_us / 1000.0},
+            {"finished_ago_s", elapsed_us(f.finished_at, now) / 1e6},
+            {"bytes", f.entry->bytes},
+            {"status", f.entry->status},
+            {"targets", f.entry->targets},
+            {"stages", entry_stages(f.entry->stages)}
+        });
+    }
+
+    json response;
+    response["in_flight"] = in_flight;
+    response["slowest"] = slow;
+    response["slowest_window_s"] = std::chrono::duration_cast<std::chrono::seconds>(SLOWEST_WINDOW).count();
+    return response.dump(2);
+}
@@ -0,0 +1,37 @@
+#include "result_merge.h"
+#include "logger.h"
+
+using json = nlohmann::json;
+
+json merge_results(const std::string& letters_result, const std::string& numbers_result,
+                   size_t total_characters) {
+    json result;
+    result["success"] = false;
+    result["letters_count"] = 0;
+    result["numbers_count"] = 0;
+    result["total_characters"] = total_characters;
+    result["error_message"] = "";
+
+    json letters_json = json::parse(letters_result);
+    json numbers_json = json::parse(numbers_result);
+
+    if (letters_json["success"] && numbers_json["success"]) {
+        result["success"] = true;
+        result["letters_count"] = letters_json["count"];
+        result["numbers_count"] = numbers_json["count"];
+
+        Logger::debug_f("Processamento distribuído concluído: %lld letras, %lld números",
+                       result["letters_count"].get<long long>(), result["numbers_count"].get<long long>());
+    } else {
+        std::string error = "Erro nos escravos: ";
+        if (!letters_json["success"]) {
+            error += "letras(" + letters_json.value("error", "desconhecido") + ") ";
+        }
+        if (!numbers_json["success"]) {
+            error += "números(" + numbers_json.value("error", "desconhecido") + ")";
+        }
+        result["error_message"] = error;
+    }
+
+    return result;
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+#include <string>
+
+// Combina as respostas de letras e números (dos escravos ou da fila de
+// trabalho, que usam o mesmo formato) no resultado de /process. Lança
+// exceção se alguma das respostas não for JSON válido.
+nlohmann::json merge_results(const std::string& letters_result, const std::string& numbers_result,
+                             size_t total_characters);
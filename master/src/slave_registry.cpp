@@ -0,0 +1,112 @@
+#include "slave_registry.h"
+#include <algorithm>
+#include <thread>
+
+SlaveRegistry::ReadGuard::ReadGuard(ReadGuard&& other) noexcept
+    : reader_counter(other.reader_counter), snapshot(other.snapshot) {
+    other.reader_counter = nullptr;
+    other.snapshot = nullptr;
+}
+
+SlaveRegistry::ReadGuard::~ReadGuard() {
+    if (reader_counter) {
+        reader_counter->fetch_sub(1);
+    }
+}
+
+SlaveRegistry::SlaveRegistry() : current(new Snapshot()) {}
+
+SlaveRegistry::~SlaveRegistry() {
+    delete current.load();
+    for (const Retired& old : retired) {
+        delete old.snapshot;
+    }
+}
+
+SlaveRegistry::ReaderShard& SlaveRegistry::reader_shard() const {
+    // Cada thread usa sempre o mesmo par de contadores
+    static thread_local size_t shard =
+        std::hash<std::thread::id>()(std::this_thread::get_id()) % READER_SHARDS;
+    return readers[shard];
+}
+
+SlaveRegistry::ReadGuard SlaveRegistry::read() const {
+    ReaderShard& shard = reader_shard();
+    for (;;) {
+        // O incremento precisa ser visível antes da releitura da época e do
+        // ponteiro (todos seq_cst). Se a época mudou no meio, o contador
+        // pode já ter sido dado como vazio: desfazer e entrar na nova
+        uint64_t current_epoch = epoch.load();
+        std::atomic<long>& counter = shard.active[current_epoch & 1];
+        counter.fetch_add(1);
+        if (epoch.load() == current_epoch) {
+            return ReadGuard(&counter, current.load());
+        }
+        counter.fetch_sub(1);
+    }
+}
+
+SlaveRegistry::Snapshot SlaveRegistry::copy() const {
+    ReadGuard guard = read();
+    return guard.slaves();
+}
+
+bool SlaveRegistry::update(const std::function<bool(Snapshot&)>& mutate) {
+    std::lock_guard<std::mutex> lock(writer_mutex);
+
+    auto next = std::make_unique<Snapshot>(*current.load());
+    if (!mutate(*next)) {
+        return false;
+    }
+
+    retired.push_back(Retired{current.exchange(next.release()), epoch.load()});
+    reclaim_locked();
+    return true;
+}
+
+void SlaveRegistry::reclaim() {
+    std::lock_guard<std::mutex> lock(writer_mutex);
+    reclaim_locked();
+}
+
+void SlaveRegistry::reclaim_locked() {
+    if (retired.empty()) {
+        return;
+    }
+
+    // Leitores da época anterior ainda ativos: tentar de novo depois. Eles
+    // só terminam, pois a época anterior não recebe leitores novos
+    uint64_t current_epoch = epoch.load();
+    if (!readers_drained((current_epoch + 1) & 1)) {
+        return;
+    }
+
+    // Despublicada antes da época atual: quem a leu está na época anterior
+    // (já vazia) ou numa mais antiga, que precisou esvaziar para a época avançar
+    auto it = std::remove_if(retired.begin(), retired.end(), [current_epoch](const Retired& old) {
+        if (old.epoch < current_epoch) {
+            delete old.snapshot;
+            return true;
+        }
+        return false;
+    });
+    retired.erase(it, retired.end());
+
+    // As despublicadas nesta época ficam liberáveis assim que os leitores
+    // atuais terminarem
+    if (!retired.empty()) {
+        epoch.store(current_epoch + 1);
+    }
+}
+
+bool SlaveRegistry::readers_drained(uint64_t parity) const {
+    // Um contador visto em zero garante que nenhum leitor daquele shard e
+    // daquela paridade ainda segura uma snapshot: quem entra depois não
+    // passa da releitura da época ou já lê o ponteiro novo
+    for (const auto& shard : readers) {
+        if (shard.active[parity].load() != 0) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "concurrency_limiter.h"
+
+// Estrutura para informações do escravo.
+// Identidade e endereço são imutáveis após a publicação; saúde, lease e carga
+// são atômicos para que heartbeats e health checks não exijam nova snapshot
+struct SlaveInfo {
+    const std::string name;
+    const std::string host;
+    const int port;
+    const std::string endpoint;
+    const std::string type;
+
+    // Escravos registrados dinamicamente mantêm um lease renovado por heartbeats;
+    // os estáticos (configurados no início) são verificados via /health
+    const bool dynamic;
+
+    std::atomic<bool> is_healthy{false};
+    std::atomic<std::chrono::steady_clock::rep> lease_expiry{0};
+
+    // Carga reportada no último heartbeat
+    std::atomic<int> reported_in_flight{0};
+    std::atomic<unsigned long long> reported_requests{0};
+    std::atomic<double> reported_load_average{0.0};
+
+    // Limite adaptativo de chamadas simultâneas para este escravo
+    ConcurrencyLimiter limiter;
+
+    SlaveInfo(const std::string& n, const std::string& h, int p,
+              const std::string& e, const std::string& t, bool is_dynamic = false)
+        : name(n), host(h), port(p), endpoint(e), type(t), dynamic(is_dynamic) {}
+
+    void renew_lease(std::chrono::steady_clock::duration ttl) {
+        lease_expiry.store((std::chrono::steady_clock::now() + ttl).time_since_epoch().count());
+    }
+
+    bool lease_expired(std::chrono::steady_clock::time_point now) const {
+        return dynamic && lease_expiry.load() < now.time_since_epoch().count();
+    }
+};
+
+// Registro de escravos no estilo RCU.
+//
+// Leitores obtêm a snapshot imutável publicada por um ponteiro atômico sem
+// tomar lock. Escritores (registro, remoção, expiração) copiam a lista,
+// aplicam a mudança e publicam a nova versão; a antiga só é liberada depois
+// que todos os leitores que poderiam enxergá-la terminaram.
+//
+// Os leitores se contam no par de contadores da época atual. Avançar a
+// época desvia os novos leitores para o outro contador, então o da época
+// anterior só desce até zero: o período de espera é limitado pela seção de
+// leitura mais longa, mesmo com leituras contínuas, e as snapshots
+// aposentadas são liberadas em no máximo duas chamadas a reclaim().
+class SlaveRegistry {
+public:
+    using Snapshot = std::vector<std::shared_ptr<SlaveInfo>>;
+
+    // Seção de leitura: mantém a snapshot válida enquanto existir
+    class ReadGuard {
+    public:
+        ReadGuard(ReadGuard&& other) noexcept;
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+        ~ReadGuard();
+
+        const Snapshot& slaves() const { return *snapshot; }
+        const Snapshot* operator->() const { return snapshot; }
+
+    private:
+        friend class SlaveRegistry;
+        ReadGuard(std::atomic<long>* counter, const Snapshot* s) : reader_counter(counter), snapshot(s) {}
+        std::atomic<long>* reader_counter;
+        const Snapshot* snapshot;
+    };
+
+    SlaveRegistry();
+    ~SlaveRegistry();
+
+    SlaveRegistry(const SlaveRegistry&) = delete;
+    SlaveRegistry& operator=(const SlaveRegistry&) = delete;
+
+    ReadGuard read() const;
+
+    // Cópia da lista (com referências) para uso fora da seção de leitura
+    Snapshot copy() const;
+
+    // Aplica a mudança numa cópia e publica; retorna o valor de mutate
+    bool update(const std::function<bool(Snapshot&)>& mutate);
+
+    // Libera snapshots antigas que nenhum leitor pode mais estar usando
+    void reclaim();
+
+private:
+    // Contadores de leitores ativos (um por paridade de época) espalhados em
+    // linhas de cache distintas
+    struct alignas(64) ReaderShard {
+        std::atomic<long> active[2] = {{0}, {0}};
+    };
+    static constexpr size_t READER_SHARDS = 16;
+
+    // Snapshot despublicada e a época em que isso aconteceu
+    struct Retired {
+        const Snapshot* snapshot;
+        uint64_t epoch;
+    };
+
+    mutable std::array<ReaderShard, READER_SHARDS> readers;
+    std::atomic<const Snapshot*> current;
+    std::atomic<uint64_t> epoch{0};
+
+    std::mutex writer_mutex;
+    std::vector<Retired> retired;
+
+    ReaderShard& reader_shard() const;
+    bool readers_drained(uint64_t parity) const;
+    // Com writer_mutex: libera o que já pode e avança a época
+    void reclaim_locked();
+};
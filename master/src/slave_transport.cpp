@@ -0,0 +1,241 @@
+#include "slave_transport.h"
+#include "logger.h"
+#include <httplib.h>
+#include <cstring>
+#include <stdexcept>
+#include <arpa/inet.h>
+#include <ifaddrs.h>
+#include <netdb.h>
+#include <netinet/in.h>
+
+// Abaixo disso o ganho de banda não paga a compressão e a descompressão
+static constexpr size_t MIN_COMPRESS_SIZE = 64 * 1024;
+// Texto que não encolhe pelo menos 10% vai sem compressão
+static constexpr size_t MIN_GAIN_PERCENT = 10;
+
+namespace {
+
+bool same_address(const sockaddr* a, const sockaddr* b) {
+    if (a->sa_family != b->sa_family) {
+        return false;
+    }
+    if (a->sa_family == AF_INET) {
+        return reinterpret_cast<const sockaddr_in*>(a)->sin_addr.s_addr ==
+               reinterpret_cast<const sockaddr_in*>(b)->sin_addr.s_addr;
+    }
+    if (a->sa_family == AF_INET6) {
+        return std::memcmp(&reinterpret_cast<const sockaddr_in6*>(a)->sin6_addr,
+                           &reinterpret_cast<const sockaddr_in6*>(b)->sin6_addr, sizeof(in6_addr)) == 0;
+    }
+    return false;
+}
+
+bool is_loopback(const sockaddr* address) {
+    if (address->sa_family == AF_INET) {
+        return (ntohl(reinterpret_cast<const sockaddr_in*>(address)->sin_addr.s_addr) >> 24) == 127;
+    }
+    if (address->sa_family == AF_INET6) {
+        return IN6_IS_ADDR_LOOPBACK(&reinterpret_cast<const sockaddr_in6*>(address)->sin6_addr);
+    }
+    return false;
+}
+
+// host resolve para o loopback ou para um endereço das interfaces locais
+bool is_local_host(const std::string& host) {
+    addrinfo hints{};
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* resolved = nullptr;
+    if (getaddrinfo(host.c_str(), nullptr, &hints, &resolved) != 0) {
+        return false;
+    }
+
+    ifaddrs* interfaces = nullptr;
+    if (getifaddrs(&interfaces) != 0) {
+        interfaces = nullptr;
+    }
+
+    bool local = false;
+    for (addrinfo* entry = resolved; entry && !local; entry = entry->ai_next) {
+        local = is_loopback(entry->ai_addr);
+        for (ifaddrs* interface = interfaces; interface && !local; interface = interface->ifa_next) {
+            local = interface->ifa_addr && same_address(entry->ai_addr, interface->ifa_addr);
+        }
+    }
+
+    if (interfaces) {
+        freeifaddrs(interfaces);
+    }
+    freeaddrinfo(resolved);
+    return local;
+}
+
+bool accepts(const std::string& accepted, compression::Encoding encoding) {
+    // Escravo ainda sem resposta: mesmo build do mestre, tenta-se a preferida
+    return accepted.empty() || accepted.find(compression::name(encoding)) != std::string::npos;
+}
+
+} // namespace
+
+HttpSlaveTransport::HttpSlaveTransport(TransportCompression compression_mode) : mode(compression_mode) {}
+
+TransportCompression HttpSlaveTransport::parse_compression(const std::string& value) {
+    if (value == "off") {
+        return TransportCompression::OFF;
+    }
+    if (value == "auto") {
+        return TransportCompression::AUTO;
+    }
+    if (value == "gzip" && compression::supported(compression::Encoding::GZIP)) {
+        return TransportCompression::GZIP;
+    }
+    if (value == "zstd" && compression::supported(compression::Encoding::ZSTD)) {
+        return TransportCompression::ZSTD;
+    }
+    throw std::invalid_argument("Compressão de transporte inválida ou não disponível: " + value);
+}
+
+HttpSlaveTransport::Peer HttpSlaveTransport::peer(const SlaveInfo& slave) {
+    std::string key = slave.host + ":" + std::to_string(slave.port);
+    {
+        std::lock_guard<std::mutex> lock(peers_mutex);
+        auto it = peers.find(key);
+        if (it != peers.end()) {
+            return it->second;
+        }
+    }
+
+    // Resolução fora do lock; dois primeiros contatos simultâneos só
+    // resolvem o mesmo host duas vezes
+    Peer resolved;
+    resolved.local = mode == TransportCompression::AUTO && is_local_host(slave.host);
+    if (resolved.local) {
+        Logger::info_f("Escravo %s no mesmo host, texto enviado sem compressão", slave.name.c_str());
+    }
+
+    std::lock_guard<std::mutex> lock(peers_mutex);
+    return peers.emplace(key, resolved).first->second;
+}
+
+void HttpSlaveTransport::set_accepted(const SlaveInfo& slave, const std::string& accepted) {
+    std::lock_guard<std::mutex> lock(peers_mutex);
+    peers[slave.host + ":" + std::to_string(slave.port)].accepted = accepted;
+}
+
+void HttpSlaveTransport::forget(const SlaveInfo& slave) {
+    std::lock_guard<std::mutex> lock(peers_mutex);
+    peers.erase(slave.host + ":" + std::to_string(slave.port));
+}
+
+compression::Encoding HttpSlaveTransport::choose_encoding(const Peer& peer, size_t length) const {
+    using compression::Encoding;
+
+    switch (mode) {
+    case TransportCompression::OFF:
+        return Encoding::IDENTITY;
+    case TransportCompression::GZIP:
+        return accepts(peer.accepted, Encoding::GZIP) ? Encoding::GZIP : Encoding::IDENTITY;
+    case TransportCompression::ZSTD:
+        return accepts(peer.accepted, Encoding::ZSTD) ? Encoding::ZSTD : Encoding::IDENTITY;
+    case TransportCompression::AUTO:
+        break;
+    }
+
+    if (peer.local || length < MIN_COMPRESS_SIZE) {
+        return Encoding::IDENTITY;
+    }
+    for (Encoding encoding : {Encoding::ZSTD, Encoding::GZIP}) {
+        if (compression::supported(encoding) && accepts(peer.accepted, encoding)) {
+            return encoding;
+        }
+    }
+    return Encoding::IDENTITY;
+}
+
+std::string HttpSlaveTransport::call(const SlaveInfo& slave, const std::string& text,
+                                     const tracing::Context& trace) {
+    // O texto vai cru (text/plain): sem o escape do JSON, e o escravo conta
+    // enquanto recebe e descomprime
+    std::string result;
+    compression::Encoding encoding = choose_encoding(peer(slave), text.size());
+    if (encoding != compression::Encoding::IDENTITY) {
+        std::string compressed = compression::compress(encoding, text.data(), text.size());
+        if (compressed.size() * 100 <= text.size() * (100 - MIN_GAIN_PERCENT) &&
+            send(slave, compressed, encoding, trace, result)) {
+            return result;
+        }
+    }
+
+    send(slave, text, compression::Encoding::IDENTITY, trace, result);
+    return result;
+}
+
+std::string HttpSlaveTransport::forward(const SlaveInfo& slave, const std::string& body,
+                                        compression::Encoding encoding, const tracing::Context& trace) {
+    // Repassar a compressão do cliente não custa CPU ao mestre, então vale
+    // em qualquer modo, inclusive off e no loopback
+    std::string result;
+    if (accepts(peer(slave).accepted, encoding) && send(slave, body, encoding, trace, result)) {
+        return result;
+    }
+
+    // Escravo sem essa codificação: só nesse caso o texto é montado no mestre
+    send(slave, compression::decompress(encoding, body), compression::Encoding::IDENTITY, trace, result);
+    return result;
+}
+
+bool HttpSlaveTransport::send(const SlaveInfo& slave, const std::string& body, compression::Encoding encoding,
+                              const tracing::Context& trace, std::string& result) {
+    httplib::Client client(slave.host, slave.port);
+    client.set_connection_timeout(5, 0);
+    client.set_read_timeout(15, 0);
+
+    httplib::Headers headers = {
+        {tracing::REQUEST_ID_HEADER, trace.request_id},
+        {tracing::SAMPLED_HEADER, trace.sampled ? "1" : "0"}
+    };
+    if (encoding != compression::Encoding::IDENTITY) {
+        headers.emplace("Content-Encoding", compression::name(encoding));
+    }
+
+    auto response = client.Post(slave.endpoint.c_str(), headers, body, "text/plain; charset=utf-8");
+
+    if (!response) {
+        throw std::runtime_error("Falha na conexão com escravo " + slave.name);
+    }
+
+    // Escravo de um build sem essa codificação: aprende, e quem chamou reenvia cru
+    if (response->status == 415 && encoding != compression::Encoding::IDENTITY) {
+        Logger::warning_f("Escravo %s não aceita %s, enviando sem compressão",
+                          slave.name.c_str(), compression::name(encoding));
+        std::string accepted = response->get_header_value("Accept-Encoding");
+        set_accepted(slave, accepted.empty() ? "identity" : accepted);
+        return false;
+    }
+
+    if (response->status != 200) {
+        throw std::runtime_error("Escravo " + slave.name + " retornou status " +
+                               std::to_string(response->status));
+    }
+
+    std::string accepted = response->get_header_value("Accept-Encoding");
+    if (!accepted.empty()) {
+        set_accepted(slave, accepted);
+    }
+    result = std::move(response->body);
+    return true;
+}
+
+bool HttpSlaveTransport::check_health(const SlaveInfo& slave) {
+    try {
+        httplib::Client client(slave.host, slave.port);
+        client.set_connection_timeout(3, 0);
+        client.set_read_timeout(5, 0);
+
+        auto response = client.Get("/health");
+
+        return response && response->status == 200;
+
+    } catch (const std::exception&) {
+        return false;
+    }
+}
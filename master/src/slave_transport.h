@@ -0,0 +1,85 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <string>
+#include "compression.h"
+#include "slave_registry.h"
+#include "tracing.h"
+
+// Como o mestre fala com um escravo no modo push.
+//
+// O padrão é HTTP (POST no endpoint do escravo). O binário embutido
+// (embedded/) troca por chamadas diretas às funções dos escravos no mesmo
+// processo. Limite de concorrência, métricas e spans continuam no
+// MasterServer, iguais para qualquer transporte.
+class SlaveTransport {
+public:
+    virtual ~SlaveTransport() = default;
+
+    // Corpo da resposta do escravo ({"success", "count", ...}). Lança
+    // std::runtime_error se o escravo não puder ser alcançado ou falhar
+    virtual std::string call(const SlaveInfo& slave, const std::string& text,
+                             const tracing::Context& trace) = 0;
+
+    // Texto que o cliente mandou comprimido em `encoding`. O padrão
+    // descomprime e usa call(); o HTTP repassa o corpo como chegou
+    virtual std::string forward(const SlaveInfo& slave, const std::string& body,
+                                compression::Encoding encoding, const tracing::Context& trace) {
+        return call(slave, compression::decompress(encoding, body), trace);
+    }
+
+    // Health check dos escravos estáticos
+    virtual bool check_health(const SlaveInfo& slave) = 0;
+
+    // O escravo saiu do registro (remoção, lease expirado ou novo registro
+    // com o mesmo nome): descartar o que o transporte guarda sobre ele
+    virtual void forget(const SlaveInfo&) {}
+};
+
+// Compressão do texto enviado aos escravos (TRANSPORT_COMPRESSION).
+// AUTO comprime só corpos grandes para escravos em outro host: no loopback
+// ou numa interface do próprio mestre a rede não é o gargalo e a compressão
+// só gastaria CPU dos dois lados
+enum class TransportCompression {
+    OFF,
+    AUTO,
+    GZIP,
+    ZSTD
+};
+
+class HttpSlaveTransport : public SlaveTransport {
+public:
+    explicit HttpSlaveTransport(TransportCompression mode = TransportCompression::AUTO);
+
+    // "off", "auto", "gzip" ou "zstd"; lança std::invalid_argument
+    static TransportCompression parse_compression(const std::string& value);
+
+    std::string call(const SlaveInfo& slave, const std::string& text,
+                     const tracing::Context& trace) override;
+    std::string forward(const SlaveInfo& slave, const std::string& body,
+                        compression::Encoding encoding, const tracing::Context& trace) override;
+    bool check_health(const SlaveInfo& slave) override;
+    void forget(const SlaveInfo& slave) override;
+
+private:
+    // O que já se sabe de cada escravo (host:porta). Escravos dinâmicos que
+    // voltam em outro endereço saem daqui por forget()
+    struct Peer {
+        bool local = false;
+        // Accept-Encoding da última resposta ("" = ainda desconhecido)
+        std::string accepted;
+    };
+
+    Peer peer(const SlaveInfo& slave);
+    void set_accepted(const SlaveInfo& slave, const std::string& accepted);
+    compression::Encoding choose_encoding(const Peer& peer, size_t length) const;
+    // POST do corpo já codificado; false se o escravo respondeu 415 (o que
+    // ele aceita fica em peers). Lança std::runtime_error nas outras falhas
+    bool send(const SlaveInfo& slave, const std::string& body, compression::Encoding encoding,
+              const tracing::Context& trace, std::string& result);
+
+    TransportCompression mode;
+    std::mutex peers_mutex;
+    std::map<std::string, Peer> peers;
+};
@@ -0,0 +1,215 @@
+#include "traffic_capture.h"
+#include "logger.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <stdexcept>
+
+namespace capture {
+
+static constexpr std::chrono::milliseconds WRITE_INTERVAL(100);
+static constexpr size_t DEFAULT_BUFFER_MB = 64;
+
+uint64_t fnv1a(const char* data, size_t length) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+Reader::Reader(const std::string& path) : file(std::fopen(path.c_str(), "rb")) {
+    if (!file) {
+        throw std::runtime_error("não foi possível abrir " + path);
+    }
+    if (std::fread(&header, sizeof(header), 1, file) != 1 ||
+        std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION) {
+        std::fclose(file);
+        throw std::runtime_error(path + " não é um arquivo de captura (versão " +
+                                 std::to_string(VERSION) + ")");
+    }
+}
+
+Reader::~Reader() {
+    std::fclose(file);
+}
+
+bool Reader::next(Record& record) {
+    if (std::fread(&record.header, sizeof(record.header), 1, file) != 1) {
+        return false;
+    }
+
+    auto read_string = [this](std::string& value, size_t length) {
+        value.resize(length);
+        return length == 0 || std::fread(&value[0], 1, length, file) == length;
+    };
+    if (!read_string(record.content_type, record.header.content_type_length) ||
+        !read_string(record.content_encoding, record.header.content_encoding_length)) {
+        return false;
+    }
+
+    record.body.clear();
+    if (record.header.flags & FLAG_BODY) {
+        record.body.resize(record.header.body_size);
+        if (record.header.body_size > 0 &&
+            std::fread(&record.body[0], 1, record.body.size(), file) != record.body.size()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+Recorder& Recorder::instance() {
+    static Recorder recorder;
+    return recorder;
+}
+
+Recorder::~Recorder() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    if (writer.joinable()) {
+        writer.join();
+    }
+    if (file) {
+        std::fclose(file);
+    }
+}
+
+void Recorder::configure() {
+    const char* path = std::getenv("CAPTURE_FILE");
+    if (!path || !*path || active) {
+        return;
+    }
+
+    if (const char* sample = std::getenv("CAPTURE_BODY_SAMPLE")) {
+        body_sample = std::strtod(sample, nullptr);
+    }
+    size_t buffer_mb = DEFAULT_BUFFER_MB;
+    if (const char* limit = std::getenv("CAPTURE_BUFFER_MB")) {
+        buffer_mb = std::strtoul(limit, nullptr, 10);
+    }
+    buffer_limit = buffer_mb * 1024 * 1024;
+
+    file = std::fopen(path, "wb");
+    if (!file) {
+        Logger::error_f("Não foi possível abrir o arquivo de captura %s", path);
+        return;
+    }
+
+    FileHeader header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.start_unix_us = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+    std::fwrite(&header, sizeof(header), 1, file);
+
+    start = std::chrono::steady_clock::now();
+    active = true;
+    writer = std::thread(&Recorder::writer_loop, this);
+    Logger::info_f("Captura de tráfego em %s (corpos: %.3f)", path, body_sample);
+}
+
+void Recorder::record(std::chrono::steady_clock::time_point arrival, const std::string& body,
+                      const std::string& content_type, const std::string& content_encoding,
+                      int status, std::chrono::steady_clock::duration latency) {
+    if (!active) {
+        return;
+    }
+
+    thread_local std::mt19937_64 engine(std::random_device{}() ^
+                                        std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    // Corpo maior que o buffer inteiro nunca caberia: nem é sorteado
+    bool with_body = body_sample > 0 && body.size() <= buffer_limit &&
+                     std::uniform_real_distribution<double>(0.0, 1.0)(engine) < body_sample;
+
+    Pending entry;
+    RecordHeader& header = entry.header;
+    auto arrival_us = std::chrono::duration_cast<std::chrono::microseconds>(arrival - start).count();
+    auto latency_us = std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+    header.arrival_us = arrival_us > 0 ? static_cast<uint64_t>(arrival_us) : 0;
+    header.body_size = body.size();
+    // Só o início: o custo na thread da requisição não cresce com o corpo
+    header.body_hash = fnv1a(body.data(), std::min(body.size(), HASH_PREFIX));
+    header.latency_us = static_cast<uint32_t>(std::min<long long>(latency_us, UINT32_MAX));
+    header.status = static_cast<uint16_t>(status);
+    header.flags = with_body ? FLAG_BODY : 0;
+    entry.content_type = content_type.substr(0, UINT16_MAX);
+    entry.content_encoding = content_encoding.substr(0, UINT16_MAX);
+    header.content_type_length = static_cast<uint16_t>(entry.content_type.size());
+    header.content_encoding_length = static_cast<uint16_t>(entry.content_encoding.size());
+
+    size_t size = sizeof(header) + entry.content_type.size() + entry.content_encoding.size() +
+                  (with_body ? body.size() : 0);
+
+    // A cópia do corpo é feita fora do lock; sob ele só entra a movimentação
+    if (with_body) {
+        entry.body = body;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (pending_bytes + size > buffer_limit) {
+        dropped_records++;
+        return;
+    }
+    pending_bytes += size;
+    pending.push_back(std::move(entry));
+}
+
+unsigned long long Recorder::dropped() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return dropped_records;
+}
+
+void Recorder::writer_loop() {
+    std::deque<Pending> batch;
+    unsigned long long reported_drops = 0;
+
+    for (;;) {
+        unsigned long long drops;
+        bool stop;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait_for(lock, WRITE_INTERVAL, [this] { return stopping; });
+            batch.swap(pending);
+            pending_bytes = 0;
+            drops = dropped_records;
+            stop = stopping;
+        }
+
+        if (!batch.empty()) {
+            for (const Pending& entry : batch) {
+                std::fwrite(&entry.header, sizeof(entry.header), 1, file);
+                std::fwrite(entry.content_type.data(), 1, entry.content_type.size(), file);
+                std::fwrite(entry.content_encoding.data(), 1, entry.content_encoding.size(), file);
+                std::fwrite(entry.body.data(), 1, entry.body.size(), file);
+            }
+            std::fflush(file);
+            batch.clear();
+        }
+
+        if (drops != reported_drops) {
+            Logger::warning_f("Captura descartou %llu registros (buffer cheio)", drops - reported_drops);
+            reported_drops = drops;
+        }
+
+        if (stop) {
+            break;
+        }
+    }
+}
+
+Recorder::Scope::~Scope() {
+    Recorder& recorder = Recorder::instance();
+    if (recorder.enabled()) {
+        recorder.record(arrival, body, content_type, content_encoding, status == -1 ? 200 : status,
+                        std::chrono::steady_clock::now() - arrival);
+    }
+}
+
+} // namespace capture
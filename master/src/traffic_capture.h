@@ -0,0 +1,161 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Captura do tráfego de /process para reprodução (tools/replay).
+//
+// Com CAPTURE_FILE definido, cada requisição gera um registro binário com o
+// instante de chegada, o tamanho do corpo e o hash FNV-1a do seu início, o
+// Content-Type e o Content-Encoding, o status e a latência. Uma fração
+// CAPTURE_BODY_SAMPLE (0 a 1, padrão 0) leva também o corpo, como chegou
+// (ainda comprimido, se for o caso). As threads das requisições só montam o
+// registro e o enfileiram: o hash cobre no máximo HASH_PREFIX bytes, o corpo
+// amostrado é copiado fora do lock e a serialização e a gravação são feitas
+// por uma thread própria. Se o disco não acompanhar e o buffer passar de
+// CAPTURE_BUFFER_MB (padrão 64), registros são descartados e contados.
+//
+// Formato (little-endian): cabeçalho de 16 bytes ("MSCAP\0" + versão u16 +
+// início em us desde a época u64) seguido de registros:
+//   u64 chegada em us desde o início   u64 tamanho do corpo
+//   u64 FNV-1a do início do corpo      u32 latência em us
+//   u16 status                         u16 flags (bit 0: corpo presente)
+//   u16 tamanho do Content-Type        u16 tamanho do Content-Encoding
+//   [Content-Type] [Content-Encoding] [corpo, se presente]
+namespace capture {
+
+constexpr char MAGIC[6] = {'M', 'S', 'C', 'A', 'P', '\0'};
+constexpr uint16_t VERSION = 2;
+constexpr uint16_t FLAG_BODY = 1;
+
+// Bytes do início do corpo cobertos por body_hash
+constexpr size_t HASH_PREFIX = 4096;
+
+#pragma pack(push, 1)
+struct FileHeader {
+    char magic[6];
+    uint16_t version;
+    uint64_t start_unix_us;
+};
+
+struct RecordHeader {
+    uint64_t arrival_us;
+    uint64_t body_size;
+    uint64_t body_hash;
+    uint32_t latency_us;
+    uint16_t status;
+    uint16_t flags;
+    uint16_t content_type_length;
+    uint16_t content_encoding_length;
+};
+#pragma pack(pop)
+
+uint64_t fnv1a(const char* data, size_t length);
+
+// Registro lido de um arquivo de captura
+struct Record {
+    RecordHeader header;
+    std::string content_type;
+    std::string content_encoding;
+    std::string body;  // vazio se o corpo não foi amostrado
+};
+
+// Leitura sequencial de um arquivo de captura
+class Reader {
+public:
+    // Lança std::runtime_error se o arquivo não puder ser aberto ou não for
+    // uma captura
+    explicit Reader(const std::string& path);
+    ~Reader();
+
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+
+    const FileHeader& file_header() const { return header; }
+
+    // false no fim do arquivo (ou num registro truncado)
+    bool next(Record& record);
+
+private:
+    FILE* file;
+    FileHeader header;
+};
+
+class Recorder {
+public:
+    static Recorder& instance();
+
+    // Lê CAPTURE_FILE, CAPTURE_BODY_SAMPLE e CAPTURE_BUFFER_MB e inicia a
+    // thread de gravação. Sem CAPTURE_FILE, a captura fica desligada
+    void configure();
+
+    bool enabled() const { return active; }
+
+    void record(std::chrono::steady_clock::time_point arrival, const std::string& body,
+                const std::string& content_type, const std::string& content_encoding,
+                int status, std::chrono::steady_clock::duration latency);
+
+    unsigned long long dropped() const;
+
+    // Registra a requisição ao fim do escopo (status é lido no fim, -1 = 200).
+    // Request é o httplib::Request; os cabeçalhos só são lidos com a
+    // captura ligada
+    class Scope {
+    public:
+        template <typename Request>
+        Scope(const Request& request, const int& response_status)
+            : body(request.body), status(response_status), arrival(std::chrono::steady_clock::now()) {
+            if (Recorder::instance().enabled()) {
+                content_type = request.get_header_value("Content-Type");
+                content_encoding = request.get_header_value("Content-Encoding");
+            }
+        }
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        const std::string& body;
+        const int& status;
+        std::chrono::steady_clock::time_point arrival;
+        std::string content_type;
+        std::string content_encoding;
+    };
+
+private:
+    Recorder() = default;
+    ~Recorder();
+
+    // Registro aguardando a thread de gravação
+    struct Pending {
+        RecordHeader header;
+        std::string content_type;
+        std::string content_encoding;
+        std::string body;
+    };
+
+    void writer_loop();
+
+    bool active = false;
+    FILE* file = nullptr;
+    double body_sample = 0;
+    size_t buffer_limit = 0;
+    std::chrono::steady_clock::time_point start;
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<Pending> pending;
+    size_t pending_bytes = 0;
+    unsigned long long dropped_records = 0;
+    bool stopping = false;
+    std::thread writer;
+};
+
+} // namespace capture
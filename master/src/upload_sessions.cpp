@@ -0,0 +1,416 @@
+#include "upload_sessions.h"
+#include "logger.h"
+#include "tracing.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <stdexcept>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Limites do tamanho de bloco: abaixo de 256 KB o custo por requisição
+// domina; acima de 64 MB um bloco reenviado custa caro e o mestre guarda
+// blocos grandes demais em memória enquanto conta
+static constexpr uint64_t MIN_CHUNK_SIZE = 256 * 1024;
+static constexpr uint64_t MAX_CHUNK_SIZE = 64 * 1024 * 1024;
+static constexpr uint64_t MAX_CHUNKS = 1 << 20;
+static constexpr size_t MAX_SESSIONS = 1024;
+
+// Arquivo de estado: cabeçalho seguido de um ChunkRecord por bloco, na
+// posição do índice. Cada registro é gravado com um único pwrite
+static constexpr char STATE_MAGIC[8] = {'U', 'P', 'L', 'O', 'A', 'D', 'S', '1'};
+static constexpr uint32_t STATE_VERSION = 1;
+static constexpr const char* STATE_SUFFIX = ".upload";
+static constexpr uint32_t FLAG_COUNTED = 1;
+
+// Intervalo entre varreduras do diretório de estado atrás de arquivos velhos
+static constexpr std::chrono::minutes STATE_SWEEP_INTERVAL(10);
+
+// Só em memória: o registro do bloco ainda não chegou ao disco
+static constexpr uint32_t FLAG_WRITING = 2;
+
+namespace {
+
+struct StateHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t chunks;
+    uint64_t size;
+    uint64_t chunk_size;
+};
+
+uint64_t chunk_count(uint64_t size, uint64_t chunk_size) {
+    return (size + chunk_size - 1) / chunk_size;
+}
+
+// Mesmos limites para sessões novas e para as recarregadas do disco
+bool valid_layout(uint64_t size, uint64_t chunk_size) {
+    return size > 0 && chunk_size >= MIN_CHUNK_SIZE && chunk_size <= MAX_CHUNK_SIZE &&
+           chunk_count(size, chunk_size) <= MAX_CHUNKS;
+}
+
+bool is_session_id(const std::string& id) {
+    return !id.empty() &&
+           std::all_of(id.begin(), id.end(), [](char c) { return std::isxdigit(static_cast<unsigned char>(c)); });
+}
+
+} // namespace
+
+UploadSessions::Session::~Session() {
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+UploadSessions::Summary UploadSessions::Session::summary() const {
+    Summary summary;
+    summary.size = size;
+    summary.chunk_size = chunk_size;
+    summary.chunks = static_cast<uint32_t>(records.size());
+    summary.received = received - writing;
+    summary.letters = letters;
+    summary.numbers = numbers;
+    summary.elapsed = std::chrono::steady_clock::now() - created;
+    return summary;
+}
+
+bool UploadSessions::set_state_dir(const std::string& dir) {
+    if (mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST) {
+        Logger::warning_f("Diretório de estado de uploads inválido '%s': %s", dir.c_str(), std::strerror(errno));
+        return false;
+    }
+
+    DIR* directory = opendir(dir.c_str());
+    if (!directory) {
+        Logger::warning_f("Diretório de estado de uploads inválido '%s': %s", dir.c_str(), std::strerror(errno));
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    state_dir = dir;
+
+    size_t suffix_length = std::strlen(STATE_SUFFIX);
+    while (struct dirent* entry = readdir(directory)) {
+        std::string name = entry->d_name;
+        if (name.size() <= suffix_length ||
+            name.compare(name.size() - suffix_length, suffix_length, STATE_SUFFIX) != 0) {
+            continue;
+        }
+        std::string id = name.substr(0, name.size() - suffix_length);
+        if (!is_session_id(id)) {
+            continue;
+        }
+        if (!load_state(id, dir + "/" + name)) {
+            Logger::warning_f("Estado de upload ilegível ignorado: %s", name.c_str());
+        }
+    }
+    closedir(directory);
+
+    Logger::info_f("Estado dos uploads em %s (%zu sessões retomáveis)", dir.c_str(), sessions.size());
+    return true;
+}
+
+bool UploadSessions::open_state(const std::string& id, Session& session) {
+    session.path = state_dir + "/" + id + STATE_SUFFIX;
+    session.fd = open(session.path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (session.fd < 0) {
+        return false;
+    }
+
+    StateHeader header;
+    std::memcpy(header.magic, STATE_MAGIC, sizeof(STATE_MAGIC));
+    header.version = STATE_VERSION;
+    header.chunks = static_cast<uint32_t>(session.records.size());
+    header.size = session.size;
+    header.chunk_size = session.chunk_size;
+
+    // Registros zerados = nenhum bloco contado
+    off_t length = static_cast<off_t>(sizeof(header) + session.records.size() * sizeof(ChunkRecord));
+    if (pwrite(session.fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) ||
+        ftruncate(session.fd, length) != 0 || fsync(session.fd) != 0) {
+        unlink(session.path.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool UploadSessions::load_state(const std::string& id, const std::string& path) {
+    auto session = std::make_shared<Session>();
+    session->path = path;
+    session->fd = open(path.c_str(), O_RDWR | O_CLOEXEC);
+    if (session->fd < 0) {
+        return false;
+    }
+
+    StateHeader header;
+    if (pread(session->fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) ||
+        std::memcmp(header.magic, STATE_MAGIC, sizeof(STATE_MAGIC)) != 0 || header.version != STATE_VERSION ||
+        !valid_layout(header.size, header.chunk_size) ||
+        header.chunks != chunk_count(header.size, header.chunk_size)) {
+        return false;
+    }
+
+    session->size = header.size;
+    session->chunk_size = header.chunk_size;
+    session->records.resize(header.chunks);
+    size_t records_size = session->records.size() * sizeof(ChunkRecord);
+    if (pread(session->fd, session->records.data(), records_size, sizeof(header)) !=
+        static_cast<ssize_t>(records_size)) {
+        return false;
+    }
+
+    for (const ChunkRecord& record : session->records) {
+        if (record.flags & FLAG_COUNTED) {
+            session->received++;
+            session->letters += record.letters;
+            session->numbers += record.numbers;
+        }
+    }
+
+    session->created = std::chrono::steady_clock::now();
+    session->last_activity = session->created;
+    sessions.emplace(id, std::move(session));
+    return true;
+}
+
+std::string UploadSessions::create(uint64_t size, uint64_t& chunk_size, uint32_t& chunks) {
+    if (size == 0) {
+        throw std::invalid_argument("Tamanho do upload deve ser positivo");
+    }
+
+    chunk_size = std::min(std::max(chunk_size, MIN_CHUNK_SIZE), MAX_CHUNK_SIZE);
+    if (!valid_layout(size, chunk_size)) {
+        throw std::invalid_argument("Upload grande demais para o tamanho de bloco");
+    }
+    chunks = static_cast<uint32_t>(chunk_count(size, chunk_size));
+
+    auto session = std::make_shared<Session>();
+    session->size = size;
+    session->chunk_size = chunk_size;
+    session->records.assign(chunks, ChunkRecord{});
+    session->created = std::chrono::steady_clock::now();
+    session->last_activity = session->created;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (sessions.size() >= MAX_SESSIONS) {
+        throw std::length_error("Sessões de upload demais em andamento");
+    }
+    std::string id = tracing::new_request_id();
+    while (sessions.count(id)) {
+        id = tracing::new_request_id();
+    }
+    if (!state_dir.empty() && !open_state(id, *session)) {
+        throw std::runtime_error("Não foi possível gravar o estado do upload");
+    }
+    sessions.emplace(id, std::move(session));
+    return id;
+}
+
+std::shared_ptr<UploadSessions::Session> UploadSessions::find(const std::string& id) {
+    auto it = sessions.find(id);
+    if (it != sessions.end()) {
+        return it->second;
+    }
+
+    // Sessão persistida que saiu da memória por inatividade: o cliente
+    // retoma e ela volta do arquivo de estado
+    if (!state_dir.empty() && is_session_id(id)) {
+        std::string path = state_dir + "/" + id + STATE_SUFFIX;
+        if (access(path.c_str(), F_OK) == 0) {
+            if (load_state(id, path)) {
+                return sessions.at(id);
+            }
+            Logger::warning_f("Estado de upload ilegível: %s", path.c_str());
+        }
+    }
+    throw std::out_of_range("Sessão de upload não encontrada");
+}
+
+void UploadSessions::remove(std::map<std::string, std::shared_ptr<Session>>::iterator it) {
+    if (it->second->fd >= 0) {
+        unlink(it->second->path.c_str());
+    }
+    sessions.erase(it);
+}
+
+uint64_t UploadSessions::chunk_length(const std::string& id, uint32_t index) {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::shared_ptr<Session> session = find(id);
+    if (index >= session->records.size()) {
+        throw std::out_of_range("Bloco fora da sessão de upload");
+    }
+    uint64_t offset = index * session->chunk_size;
+    return std::min(session->chunk_size, session->size - offset);
+}
+
+bool UploadSessions::counted(const std::string& id, uint32_t index, uint64_t hash) {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::shared_ptr<Session> session = find(id);
+    if (index >= session->records.size()) {
+        throw std::out_of_range("Bloco fora da sessão de upload");
+    }
+
+    const ChunkRecord& slot = session->records[index];
+    if (!(slot.flags & FLAG_COUNTED) || (slot.flags & FLAG_WRITING)) {
+        return false;
+    }
+    if (hash != slot.hash && slot.hash != 0) {
+        throw std::invalid_argument("Bloco já contado com outro conteúdo");
+    }
+    session->last_activity = std::chrono::steady_clock::now();
+    return true;
+}
+
+bool UploadSessions::complete_chunk(const std::string& id, uint32_t index, uint64_t hash,
+                                    int64_t letters, int64_t numbers) {
+    std::shared_ptr<Session> session;
+    ChunkRecord record;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        session = find(id);
+        if (index >= session->records.size()) {
+            throw std::out_of_range("Bloco fora da sessão de upload");
+        }
+
+        session->last_activity = std::chrono::steady_clock::now();
+        ChunkRecord& slot = session->records[index];
+        if (slot.flags & FLAG_COUNTED) {
+            if (hash != 0 && slot.hash != 0 && hash != slot.hash) {
+                throw std::invalid_argument("Bloco já contado com outro conteúdo");
+            }
+            // Confirmar o reenvio antes de a gravação terminar prometeria um
+            // bloco que ainda pode ser desfeito abaixo
+            if (slot.flags & FLAG_WRITING) {
+                throw std::runtime_error("Bloco ainda sendo gravado, tente novamente");
+            }
+            return false;
+        }
+
+        record = ChunkRecord{hash, letters, numbers, FLAG_COUNTED, 0};
+        slot = record;
+        if (session->fd >= 0) {
+            slot.flags |= FLAG_WRITING;
+            session->writing++;
+        }
+        session->received++;
+        session->letters += letters;
+        session->numbers += numbers;
+    }
+
+    if (session->fd < 0) {
+        return true;
+    }
+
+    // Fora do lock: a sessão fica viva pelo shared_ptr e cada bloco grava
+    // a própria posição, então uploads e blocos não se bloqueiam no disco
+    off_t offset = static_cast<off_t>(sizeof(StateHeader) + index * sizeof(ChunkRecord));
+    bool persisted = pwrite(session->fd, &record, sizeof(record), offset) == static_cast<ssize_t>(sizeof(record)) &&
+                     fdatasync(session->fd) == 0;
+    int error = errno;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    ChunkRecord& slot = session->records[index];
+    session->writing--;
+    if (persisted) {
+        slot.flags &= ~FLAG_WRITING;
+        return true;
+    }
+
+    // Bloco não confirmado ao cliente: volta a faltar e será reenviado
+    slot = ChunkRecord{};
+    session->received--;
+    session->letters -= letters;
+    session->numbers -= numbers;
+    LOG_RATE_LIMITED(LogLevel::WARNING, 5, "Falha ao gravar o estado do upload %s: %s",
+                     id.c_str(), std::strerror(error));
+    throw std::runtime_error("Não foi possível gravar o estado do upload");
+}
+
+UploadSessions::Summary UploadSessions::status(const std::string& id, std::vector<uint32_t>* missing) {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::shared_ptr<Session> session = find(id);
+
+    if (missing) {
+        missing->clear();
+        for (uint32_t i = 0; i < session->records.size(); i++) {
+            if (!(session->records[i].flags & FLAG_COUNTED)) {
+                missing->push_back(i);
+            }
+        }
+    }
+    return session->summary();
+}
+
+bool UploadSessions::finish(const std::string& id, Summary& summary) {
+    std::lock_guard<std::mutex> lock(mutex);
+    find(id);
+    auto it = sessions.find(id);
+
+    summary = it->second->summary();
+    if (summary.received < summary.chunks) {
+        return false;
+    }
+    remove(it);
+    return true;
+}
+
+size_t UploadSessions::expire(std::chrono::steady_clock::duration idle,
+                              std::chrono::steady_clock::duration persisted_idle) {
+    auto now = std::chrono::steady_clock::now();
+    size_t removed = 0;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto it = sessions.begin(); it != sessions.end();) {
+        auto current = it++;
+        if (now - current->second->last_activity <= idle) {
+            continue;
+        }
+        // Com estado em disco, só a memória é liberada; o arquivo fica para
+        // o cliente retomar e é apagado pela varredura abaixo
+        if (current->second->fd >= 0) {
+            sessions.erase(current);
+        } else {
+            remove(current);
+            removed++;
+        }
+    }
+
+    if (state_dir.empty() || now < next_state_sweep) {
+        return removed;
+    }
+    next_state_sweep = now + STATE_SWEEP_INTERVAL;
+
+    DIR* directory = opendir(state_dir.c_str());
+    if (!directory) {
+        return removed;
+    }
+    auto max_age = std::chrono::duration_cast<std::chrono::seconds>(persisted_idle).count();
+    time_t wall_now = time(nullptr);
+    size_t suffix_length = std::strlen(STATE_SUFFIX);
+    while (struct dirent* entry = readdir(directory)) {
+        std::string name = entry->d_name;
+        if (name.size() <= suffix_length ||
+            name.compare(name.size() - suffix_length, suffix_length, STATE_SUFFIX) != 0 ||
+            sessions.count(name.substr(0, name.size() - suffix_length))) {
+            continue;
+        }
+
+        // Cada bloco gravado atualiza o mtime: ele marca a última atividade
+        std::string path = state_dir + "/" + name;
+        struct stat info;
+        if (stat(path.c_str(), &info) == 0 && wall_now - info.st_mtime > max_age && unlink(path.c_str()) == 0) {
+            removed++;
+        }
+    }
+    closedir(directory);
+    return removed;
+}
+
+size_t UploadSessions::active() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return sessions.size();
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Sessões de upload em partes (/upload): o cliente divide um arquivo grande
+// em blocos de tamanho fixo e os envia em paralelo, por várias conexões.
+// Cada bloco é contado quando chega; a sessão guarda apenas as somas e
+// quais blocos já foram contados, nunca o texto.
+//
+// Com um diretório de estado (set_state_dir), cada sessão tem um arquivo
+// com um registro de tamanho fixo por bloco, gravado e sincronizado antes
+// de o bloco ser confirmado ao cliente. Após um reinício do mestre as
+// sessões são recarregadas e o cliente retoma enviando só os blocos que
+// faltam (status()). Sessões persistidas inativas saem da memória bem antes
+// de o arquivo ser apagado (expire()) e voltam dele quando retomadas.
+//
+// Sessão ou bloco inexistente lança std::out_of_range; parâmetros inválidos,
+// std::invalid_argument; sessões demais, std::length_error.
+class UploadSessions {
+public:
+    // Estado de uma sessão
+    struct Summary {
+        uint64_t size = 0;
+        uint64_t chunk_size = 0;
+        uint32_t chunks = 0;
+        uint32_t received = 0;
+        int64_t letters = 0;
+        int64_t numbers = 0;
+        std::chrono::steady_clock::duration elapsed{};
+    };
+
+    UploadSessions() = default;
+    UploadSessions(const UploadSessions&) = delete;
+    UploadSessions& operator=(const UploadSessions&) = delete;
+
+    // Persiste as sessões em dir (criado se preciso) e recarrega as que já
+    // estiverem lá. Devolve false se o diretório não puder ser usado
+    bool set_state_dir(const std::string& dir);
+
+    // Cria uma sessão para size bytes em blocos de chunk_size (ajustado aos
+    // limites); devolve o ID e preenche o tamanho e o número de blocos
+    std::string create(uint64_t size, uint64_t& chunk_size, uint32_t& chunks);
+
+    // Tamanho esperado do bloco index (o último pode ser menor)
+    uint64_t chunk_length(const std::string& id, uint32_t index);
+
+    // true se o bloco já foi contado e gravado, para o reenvio ser
+    // respondido sem contar de novo. Com hash diferente do contado, lança
+    // std::invalid_argument
+    bool counted(const std::string& id, uint32_t index, uint64_t hash);
+
+    // Soma as contagens do bloco. Devolve false se ele já tinha sido contado
+    // (reenvio após timeout, por exemplo), sem somar de novo. hash é o
+    // FNV-1a do bloco (0 se desconhecido); um reenvio com hash diferente do
+    // contado lança std::invalid_argument. Se o registro não puder ser
+    // gravado no estado, o bloco é desfeito e std::runtime_error é lançada
+    bool complete_chunk(const std::string& id, uint32_t index, uint64_t hash,
+                        int64_t letters, int64_t numbers);
+
+    // Estado atual; com missing, preenche os índices dos blocos que faltam
+    Summary status(const std::string& id, std::vector<uint32_t>* missing = nullptr);
+
+    // Com todos os blocos contados, remove a sessão e devolve true. Senão,
+    // mantém a sessão e devolve false; summary traz o estado nos dois casos
+    bool finish(const std::string& id, Summary& summary);
+
+    // Remove sessões sem atividade há mais de idle. As que têm estado em
+    // disco só saem da memória (voltam do arquivo quando o cliente retoma);
+    // o arquivo é apagado depois de persisted_idle sem blocos novos.
+    // Devolve quantas sessões foram descartadas de vez
+    size_t expire(std::chrono::steady_clock::duration idle, std::chrono::steady_clock::duration persisted_idle);
+
+    size_t active() const;
+
+private:
+    // Registro de um bloco no arquivo de estado
+    struct ChunkRecord {
+        uint64_t hash;
+        int64_t letters;
+        int64_t numbers;
+        uint32_t flags;
+        uint32_t reserved;
+    };
+
+    struct Session {
+        uint64_t size = 0;
+        uint64_t chunk_size = 0;
+        std::vector<ChunkRecord> records;
+        uint32_t received = 0;
+        uint32_t writing = 0;   // contados, mas ainda não gravados no estado
+        int64_t letters = 0;
+        int64_t numbers = 0;
+        std::chrono::steady_clock::time_point created;
+        std::chrono::steady_clock::time_point last_activity;
+
+        // Arquivo de estado (-1 sem persistência); fechado no destrutor, que
+        // só roda quando nenhuma gravação em andamento usa mais a sessão
+        int fd = -1;
+        std::string path;
+        ~Session();
+
+        Summary summary() const;
+    };
+
+    // Procura na memória e, se preciso, no diretório de estado
+    std::shared_ptr<Session> find(const std::string& id);
+    void remove(std::map<std::string, std::shared_ptr<Session>>::iterator it);
+    bool open_state(const std::string& id, Session& session);
+    bool load_state(const std::string& id, const std::string& path);
+
+    mutable std::mutex mutex;
+    std::map<std::string, std::shared_ptr<Session>> sessions;
+    std::string state_dir;
+    std::chrono::steady_clock::time_point next_state_sweep{};
+};
@@ -0,0 +1,241 @@
+#include "work_queue.h"
+#include <algorithm>
+
+// Tentativas por tarefa antes de desistir
+static constexpr int MAX_TASK_ATTEMPTS = 3;
+
+WorkQueue::Batch WorkQueue::submit(const std::string& type, const char* data, size_t length,
+                                   size_t shard_size, const tracing::Context& trace) {
+    Batch batch;
+    shard_size = std::max<size_t>(1, shard_size);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& queue = queues[type];
+
+        // Texto vazio ainda gera uma tarefa para manter a resposta uniforme
+        size_t offset = 0;
+        do {
+            size_t part = std::min(shard_size, length - offset);
+            uint64_t id = next_task_id++;
+
+            Task& task = tasks[id];
+            task.type = type;
+            task.data = data + offset;
+            task.length = part;
+            task.trace = trace;
+
+            batch.task_ids.push_back(id);
+            batch.results.push_back(task.promise.get_future());
+            queue.push_back(id);
+
+            offset += part;
+        } while (offset < length);
+    }
+
+    for (size_t i = 0; i < batch.task_ids.size(); i++) {
+        task_available.notify_one();
+    }
+    return batch;
+}
+
+WorkResult WorkQueue::wait(Batch& batch, std::chrono::steady_clock::time_point deadline) {
+    WorkResult total;
+    total.success = true;
+
+    for (auto& future : batch.results) {
+        if (future.wait_until(deadline) != std::future_status::ready) {
+            cancel(batch.task_ids);
+
+            total.success = false;
+            total.error = "timeout aguardando workers";
+            return total;
+        }
+
+        WorkResult part = future.get();
+        if (!part.success) {
+            total.success = false;
+            total.error = part.error;
+        }
+        total.count += part.count;
+    }
+
+    // Fatias que falharam definitivamente já saíram da fila; garantir o resto
+    if (!total.success) {
+        cancel(batch.task_ids);
+    }
+    return total;
+}
+
+void WorkQueue::cancel(const std::vector<uint64_t>& task_ids) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (uint64_t id : task_ids) {
+        auto it = tasks.find(id);
+        if (it == tasks.end()) {
+            continue;
+        }
+
+        if (!it->second.leased) {
+            auto& queue = queues[it->second.type];
+            queue.erase(std::remove(queue.begin(), queue.end(), id), queue.end());
+        }
+        tasks.erase(it);
+    }
+}
+
+std::deque<uint64_t>* WorkQueue::pick_queue_locked(const std::string& preferred_type, bool& stolen) {
+    auto preferred = queues.find(preferred_type);
+    if (preferred != queues.end() && !preferred->second.empty()) {
+        stolen = false;
+        return &preferred->second;
+    }
+
+    // Roubo de trabalho: a fila com mais fatias pendentes
+    std::deque<uint64_t>* busiest = nullptr;
+    for (auto& entry : queues) {
+        if (!entry.second.empty() && (!busiest || entry.second.size() > busiest->size())) {
+            busiest = &entry.second;
+        }
+    }
+
+    stolen = busiest != nullptr && !preferred_type.empty();
+    return busiest;
+}
+
+bool WorkQueue::poll(const std::string& worker, const std::string& preferred_type,
+                     std::chrono::milliseconds max_wait, Lease& lease) {
+    auto deadline = std::chrono::steady_clock::now() + max_wait;
+    std::unique_lock<std::mutex> lock(mutex);
+
+    workers_seen[worker] = std::chrono::steady_clock::now();
+
+    while (true) {
+        bool stolen = false;
+        std::deque<uint64_t>* queue = pick_queue_locked(preferred_type, stolen);
+
+        if (queue) {
+            uint64_t id = queue->front();
+            queue->pop_front();
+
+            Task& task = tasks.at(id);
+            task.leased = true;
+            task.lease_deadline = std::chrono::steady_clock::now() + lease_ttl;
+            task.attempts++;
+
+            // A cópia é feita sob o lock: depois disso a tarefa não referencia
+            // mais o texto original, que pode ser liberado após cancel()
+            lease.task_id = id;
+            lease.type = task.type;
+            lease.data.assign(task.data, task.length);
+            lease.trace = task.trace;
+
+            if (stolen) {
+                stolen_count++;
+            }
+            return true;
+        }
+
+        if (task_available.wait_until(lock, deadline) == std::cv_status::timeout) {
+            return false;
+        }
+    }
+}
+
+bool WorkQueue::complete(uint64_t task_id, const WorkResult& result) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = tasks.find(task_id);
+    if (it == tasks.end()) {
+        return false;
+    }
+
+    // Lease expirado e tarefa de volta à fila: o resultado do worker original
+    // ainda vale, e ela não pode ser entregue (e contada) de novo
+    if (!it->second.leased) {
+        auto& queue = queues[it->second.type];
+        queue.erase(std::remove(queue.begin(), queue.end(), task_id), queue.end());
+    }
+
+    it->second.promise.set_value(result);
+    tasks.erase(it);
+    completed_count++;
+    return true;
+}
+
+void WorkQueue::requeue_expired() {
+    auto now = std::chrono::steady_clock::now();
+    size_t requeued = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        for (auto it = tasks.begin(); it != tasks.end();) {
+            Task& task = it->second;
+            if (!task.leased || task.lease_deadline > now) {
+                ++it;
+                continue;
+            }
+
+            if (task.attempts >= MAX_TASK_ATTEMPTS) {
+                WorkResult failed;
+                failed.error = "tarefa excedeu o número de tentativas";
+                task.promise.set_value(failed);
+                it = tasks.erase(it);
+                continue;
+            }
+
+            task.leased = false;
+            queues[task.type].push_front(it->first);
+            requeued_count++;
+            requeued++;
+            ++it;
+        }
+
+        // Workers reiniciados voltam com outro id; o antigo some daqui. O TTL
+        // da tarefa é maior que qualquer janela de atividade consultada
+        for (auto it = workers_seen.begin(); it != workers_seen.end();) {
+            if (now - it->second > lease_ttl) {
+                it = workers_seen.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < requeued; i++) {
+        task_available.notify_one();
+    }
+}
+
+bool WorkQueue::has_active_workers(std::chrono::seconds window) const {
+    auto cutoff = std::chrono::steady_clock::now() - window;
+    std::lock_guard<std::mutex> lock(mutex);
+
+    return std::any_of(workers_seen.begin(), workers_seen.end(),
+                       [cutoff](const auto& entry) { return entry.second >= cutoff; });
+}
+
+WorkQueue::Stats WorkQueue::stats(std::chrono::seconds worker_window) const {
+    auto cutoff = std::chrono::steady_clock::now() - worker_window;
+    std::lock_guard<std::mutex> lock(mutex);
+
+    Stats result;
+    for (const auto& entry : queues) {
+        result.pending[entry.first] = entry.second.size();
+    }
+    for (const auto& entry : tasks) {
+        if (entry.second.leased) {
+            result.leased++;
+        }
+    }
+    for (const auto& entry : workers_seen) {
+        if (entry.second >= cutoff) {
+            result.active_workers++;
+        }
+    }
+    result.completed = completed_count;
+    result.stolen = stolen_count;
+    result.requeued = requeued_count;
+    return result;
+}
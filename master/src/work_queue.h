@@ -0,0 +1,107 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "tracing.h"
+
+// Resultado de uma tarefa de contagem executada por um worker
+struct WorkResult {
+    bool success = false;
+    long long count = 0;
+    std::string error;
+};
+
+// Fila de tarefas para o modo pull: o mestre divide o texto em fatias,
+// workers genéricos buscam tarefas com long poll e devolvem as contagens.
+// Um worker sem tarefas do seu tipo preferido rouba da fila mais cheia.
+class WorkQueue {
+public:
+    // Tarefa entregue a um worker
+    struct Lease {
+        uint64_t task_id = 0;
+        std::string type;
+        std::string data;
+        tracing::Context trace;
+    };
+
+    // Conjunto de fatias de um mesmo texto e tipo
+    struct Batch {
+        std::vector<uint64_t> task_ids;
+        std::vector<std::future<WorkResult>> results;
+    };
+
+    // Estatísticas para /health
+    struct Stats {
+        std::map<std::string, size_t> pending;
+        size_t leased = 0;
+        size_t active_workers = 0;
+        unsigned long long completed = 0;
+        unsigned long long stolen = 0;
+        unsigned long long requeued = 0;
+    };
+
+    // Tempo que um worker tem para devolver uma tarefa antes de ela voltar à fila
+    static constexpr std::chrono::seconds DEFAULT_LEASE_TTL{30};
+
+    explicit WorkQueue(std::chrono::milliseconds lease = DEFAULT_LEASE_TTL) : lease_ttl(lease) {}
+
+    // Enfileira o texto em fatias de até shard_size bytes. O texto precisa
+    // permanecer válido até wait() retornar. O contexto de trace segue com
+    // cada fatia até o worker
+    Batch submit(const std::string& type, const char* data, size_t length, size_t shard_size,
+                 const tracing::Context& trace);
+
+    // Aguarda todas as fatias e soma as contagens; em timeout, cancela o resto
+    WorkResult wait(Batch& batch, std::chrono::steady_clock::time_point deadline);
+
+    // Long poll do worker: retorna false se nada chegou dentro de max_wait
+    bool poll(const std::string& worker, const std::string& preferred_type,
+              std::chrono::milliseconds max_wait, Lease& lease);
+
+    // Resultado enviado pelo worker; false se a tarefa não existe mais
+    bool complete(uint64_t task_id, const WorkResult& result);
+
+    // Devolve à fila tarefas cujo worker não respondeu a tempo e esquece
+    // workers sem poll há mais que o TTL da tarefa
+    void requeue_expired();
+
+    bool has_active_workers(std::chrono::seconds window) const;
+    Stats stats(std::chrono::seconds worker_window) const;
+
+private:
+    struct Task {
+        std::string type;
+        const char* data;
+        size_t length;
+        tracing::Context trace;
+        std::promise<WorkResult> promise;
+        bool leased = false;
+        std::chrono::steady_clock::time_point lease_deadline;
+        int attempts = 0;
+    };
+
+    const std::chrono::milliseconds lease_ttl;
+
+    mutable std::mutex mutex;
+    std::condition_variable task_available;
+
+    uint64_t next_task_id = 1;
+    std::unordered_map<uint64_t, Task> tasks;
+    std::map<std::string, std::deque<uint64_t>> queues;
+    std::map<std::string, std::chrono::steady_clock::time_point> workers_seen;
+
+    unsigned long long completed_count = 0;
+    unsigned long long stolen_count = 0;
+    unsigned long long requeued_count = 0;
+
+    void cancel(const std::vector<uint64_t>& task_ids);
+    std::deque<uint64_t>* pick_queue_locked(const std::string& preferred_type, bool& stolen);
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+
+// Codificação do corpo das requisições (Content-Encoding) entre cliente,
+// mestre e escravos. gzip usa a zlib, a mesma que o httplib usa para
+// descomprimir sozinho os corpos gzip antes do handler (CPPHTTPLIB_ZLIB_SUPPORT);
+// zstd usa a libzstd (HAVE_ZSTD) e é descomprimido aqui, em streaming.
+namespace compression {
+
+enum class Encoding {
+    IDENTITY,
+    GZIP,
+    ZSTD
+};
+
+// Nome no cabeçalho Content-Encoding ("" para identity)
+const char* name(Encoding encoding);
+
+// Lê o cabeçalho Content-Encoding; lança std::invalid_argument para
+// codificações desconhecidas ou não compiladas
+Encoding parse(const std::string& content_encoding);
+
+bool supported(Encoding encoding);
+
+// Codificações aceitas nos corpos de requisição, na ordem de preferência
+// (para o cabeçalho Accept-Encoding das respostas)
+std::string accepted();
+
+// Comprime o corpo inteiro; lança std::runtime_error em falha
+std::string compress(Encoding encoding, const char* data, size_t length);
+
+// Descompressão em streaming: cada pedaço descomprimido vai para o sink
+// assim que sai do decodificador, sem montar o texto inteiro. Identity
+// repassa os bytes; gzip não passa por aqui (o httplib já descomprimiu).
+// write() e finish() lançam std::runtime_error se o fluxo for inválido
+class StreamDecoder {
+public:
+    using Sink = std::function<void(const char* data, size_t length)>;
+
+    StreamDecoder(Encoding encoding, Sink sink);
+    ~StreamDecoder();
+
+    void write(const char* data, size_t length);
+    // Confere que o fluxo terminou num quadro completo
+    void finish();
+
+private:
+    struct State;
+
+    Encoding encoding;
+    Sink sink;
+    std::unique_ptr<State> state;
+};
+
+// Descomprime o corpo inteiro (quando o texto precisa ficar em memória)
+std::string decompress(Encoding encoding, const std::string& data);
+
+} // namespace compression
@@ -0,0 +1,100 @@
+#include "hw_counters.h"
+#include <cerrno>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static int perf_event_open(perf_event_attr* attr, int group_fd) {
+    // Thread atual, qualquer CPU
+    return static_cast<int>(::syscall(SYS_perf_event_open, attr, 0, -1, group_fd, 0));
+}
+
+HardwareCounters::HardwareCounters() {
+    static const uint64_t configs[EVENTS] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_BRANCH_MISSES,
+        PERF_COUNT_HW_CACHE_MISSES,
+    };
+
+    for (int i = 0; i < EVENTS; i++) {
+        fds[i] = -1;
+    }
+
+    for (int i = 0; i < EVENTS; i++) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = configs[i];
+        attr.disabled = i == 0;  // o líder controla o grupo
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                           PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        fds[i] = perf_event_open(&attr, i == 0 ? -1 : fds[0]);
+        if (fds[i] < 0) {
+            open_error = std::string("perf_event_open: ") + std::strerror(errno);
+            break;
+        }
+    }
+}
+
+HardwareCounters::~HardwareCounters() {
+    for (int i = EVENTS - 1; i >= 0; i--) {
+        if (fds[i] >= 0) {
+            close(fds[i]);
+        }
+    }
+}
+
+void HardwareCounters::start() {
+    if (open_error.empty()) {
+        ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+}
+
+HardwareCounters::Reading HardwareCounters::stop() {
+    Reading reading;
+    if (!open_error.empty()) {
+        reading.error = open_error;
+        return reading;
+    }
+
+    ioctl(fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+    // Formato de PERF_FORMAT_GROUP: nr, time_enabled, time_running, valores
+    uint64_t data[3 + EVENTS] = {};
+    ssize_t bytes = read(fds[0], data, sizeof(data));
+    if (bytes != static_cast<ssize_t>(sizeof(data)) || data[0] != EVENTS) {
+        reading.error = "leitura dos contadores falhou";
+        return reading;
+    }
+
+    uint64_t enabled = data[1];
+    uint64_t running = data[2];
+    if (running == 0) {
+        reading.error = "contadores não foram agendados no PMU";
+        return reading;
+    }
+
+    uint64_t values[EVENTS];
+    for (int i = 0; i < EVENTS; i++) {
+        values[i] = data[3 + i];
+        if (running < enabled) {
+            values[i] = static_cast<uint64_t>(static_cast<double>(values[i]) * enabled / running);
+        }
+    }
+
+    reading.available = true;
+    reading.scaled = running < enabled;
+    reading.cycles = values[CYCLES];
+    reading.instructions = values[INSTRUCTIONS];
+    reading.branch_misses = values[BRANCH_MISSES];
+    reading.cache_misses = values[CACHE_MISSES];
+    return reading;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Contadores de hardware (perf_event_open) da thread atual, para medir um
+// trecho de código: ciclos, instruções, erros de predição de desvio e
+// faltas de cache. Os quatro formam um grupo lido de uma vez; se o kernel
+// multiplexar o PMU, os valores são escalados pelo tempo em que o grupo
+// realmente contou.
+//
+// Em containers o perf_event_open costuma exigir kernel.perf_event_paranoid
+// <= 2 e não ser bloqueado pelo seccomp; sem isso, available fica false e
+// error explica o motivo.
+class HardwareCounters {
+public:
+    struct Reading {
+        bool available = false;
+        std::string error;
+        uint64_t cycles = 0;
+        uint64_t instructions = 0;
+        uint64_t branch_misses = 0;
+        uint64_t cache_misses = 0;
+        bool scaled = false;  // houve multiplexação
+    };
+
+    HardwareCounters();
+    ~HardwareCounters();
+
+    HardwareCounters(const HardwareCounters&) = delete;
+    HardwareCounters& operator=(const HardwareCounters&) = delete;
+
+    void start();
+    Reading stop();
+
+private:
+    enum { CYCLES, INSTRUCTIONS, BRANCH_MISSES, CACHE_MISSES, EVENTS };
+
+    int fds[EVENTS];
+    std::string open_error;
+};
@@ -1,12 +1,12 @@
 #pragma once
 
-#include <iostream>
-#include <fstream>
-#include <sstream>
 #include <string>
 #include <chrono>
-#include <iomanip>
 #include <mutex>
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+#include <memory>
 
 enum class LogLevel {
     DEBUG,
@@ -15,59 +15,185 @@ enum class LogLevel {
     ERROR
 };
 
+// O que fazer quando o buffer da thread está cheio
+enum class LogOverflowPolicy {
+    BLOCK,  // espera o escritor liberar espaço (nenhuma linha se perde)
+    DROP    // descarta a linha e contabiliza; o escritor reporta o total
+};
+
+// Nível mínimo compilado: chamadas abaixo dele somem do binário.
+// 0 = DEBUG, 1 = INFO, 2 = WARNING, 3 = ERROR (Release define 1)
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL 0
+#endif
+
+// Verificação de tipos dos argumentos no estilo printf
+#if defined(__GNUC__)
+#define LOGGER_PRINTF_FORMAT(fmt, first) __attribute__((format(printf, fmt, first)))
+#else
+#define LOGGER_PRINTF_FORMAT(fmt, first)
+#endif
+
+// Logger assíncrono: cada thread grava num buffer circular próprio (SPSC,
+// sem lock) e uma thread escritora drena todos os buffers em lote para a
+// saída padrão. O formato das linhas é o mesmo da versão síncrona.
 class Logger {
 private:
-    static std::mutex log_mutex;
-    static LogLevel current_level;
-    static std::string component_name;
+    static std::atomic<LogLevel> current_level;
 
-    static std::string get_timestamp();
-    static std::string level_to_string(LogLevel level);
-    static std::string get_color_code(LogLevel level);
-    static std::string get_reset_color();
+    static void log_text(LogLevel level, const char* text, size_t length);
+    static void log_format(LogLevel level, const char* format, va_list args);
 
 public:
     static void set_component_name(const std::string& name);
     static void set_log_level(LogLevel level);
 
+    // Política de overflow; o padrão vem de LOG_OVERFLOW (block|drop)
+    static void set_overflow_policy(LogOverflowPolicy policy);
+
+    // Bloqueia até que tudo que foi registrado antes esteja escrito
+    static void flush();
+
+    // Linhas descartadas pela política DROP desde o início
+    static unsigned long long dropped_count();
+
+    // Verificação barata feita antes de montar qualquer mensagem
+    static bool enabled(LogLevel level) {
+        return static_cast<int>(level) >= LOG_MIN_LEVEL &&
+               level >= current_level.load(std::memory_order_relaxed);
+    }
+
+    // Abaixo de LOG_MIN_LEVEL também viram funções vazias; nos caminhos
+    // quentes prefira as variantes _f com literais, que não montam string
+#if LOG_MIN_LEVEL > 0
+    static void debug(const std::string&) {}
+#else
     static void debug(const std::string& message);
+#endif
+#if LOG_MIN_LEVEL > 1
+    static void info(const std::string&) {}
+#else
     static void info(const std::string& message);
+#endif
+#if LOG_MIN_LEVEL > 2
+    static void warning(const std::string&) {}
+#else
     static void warning(const std::string& message);
+#endif
     static void error(const std::string& message);
 
     static void log(LogLevel level, const std::string& message);
 
-    // Macros para facilitar o uso com formatação
-    template<typename... Args>
-    static void debug_f(const std::string& format, Args... args) {
-        debug(format_string(format, args...));
-    }
+    // Variantes com formatação printf: o nível é testado antes de formatar
+    // e o texto é montado num buffer de pilha. Abaixo de LOG_MIN_LEVEL viram
+    // funções vazias que o compilador elimina junto com a chamada (sem
+    // va_start, elas são inlinadas); o formato continua verificado
+#if LOG_MIN_LEVEL > 0
+    static void debug_f(const char*, ...) LOGGER_PRINTF_FORMAT(1, 2) {}
+#else
+    static void debug_f(const char* format, ...) LOGGER_PRINTF_FORMAT(1, 2);
+#endif
 
-    template<typename... Args>
-    static void info_f(const std::string& format, Args... args) {
-        info(format_string(format, args...));
-    }
+#if LOG_MIN_LEVEL > 1
+    static void info_f(const char*, ...) LOGGER_PRINTF_FORMAT(1, 2) {}
+#else
+    static void info_f(const char* format, ...) LOGGER_PRINTF_FORMAT(1, 2);
+#endif
 
-    template<typename... Args>
-    static void warning_f(const std::string& format, Args... args) {
-        warning(format_string(format, args...));
-    }
+#if LOG_MIN_LEVEL > 2
+    static void warning_f(const char*, ...) LOGGER_PRINTF_FORMAT(1, 2) {}
+#else
+    static void warning_f(const char* format, ...) LOGGER_PRINTF_FORMAT(1, 2);
+#endif
 
-    template<typename... Args>
-    static void error_f(const std::string& format, Args... args) {
-        error(format_string(format, args...));
-    }
+    static void error_f(const char* format, ...) LOGGER_PRINTF_FORMAT(1, 2);
+
+    // Nível escolhido em tempo de execução (usado pelas macros de amostragem)
+    static void log_f(LogLevel level, const char* format, ...) LOGGER_PRINTF_FORMAT(2, 3);
+
+    // Log de acesso: uma linha por requisição (lines) ou resumo periódico
+    // por rota (summary). O padrão vem de LOG_ACCESS
+    static void set_access_summary(bool enabled);
+    static bool access_summary();
+};
+
+// Estado de um ponto de log amostrado ou limitado; criado como estático
+// local pelas macros abaixo, um por chamada no código. Mensagens suprimidas
+// são contadas e resumidas periodicamente pela thread escritora
+class LogSite {
+public:
+    LogSite(const char* file, int line, LogLevel level);
+
+    // Deixa passar 1 a cada every_n chamadas
+    bool sample(unsigned every_n);
+
+    // Token bucket (GCRA): até per_second mensagens por segundo, com
+    // rajada do mesmo tamanho
+    bool admit(double per_second);
+
+    const char* const file;
+    const int line;
+    const LogLevel level;
+    LogSite* next = nullptr;
+    std::atomic<unsigned long long> suppressed{0};
 
 private:
-    template<typename... Args>
-    static std::string format_string(const std::string& format, Args... args) {
-        int size_s = std::snprintf(nullptr, 0, format.c_str(), args...) + 1;
-        if (size_s <= 0) {
-            return format;
+    std::atomic<unsigned long long> calls{0};
+    std::atomic<long long> theoretical_arrival_ns{0};
+};
+
+#define LOG_EVERY_N(level, every_n, ...) \
+    do { \
+        if (Logger::enabled(level)) { \
+            static LogSite log_site_(__FILE__, __LINE__, level); \
+            if (log_site_.sample(every_n)) { \
+                Logger::log_f(level, __VA_ARGS__); \
+            } \
+        } \
+    } while (0)
+
+#define LOG_RATE_LIMITED(level, per_second, ...) \
+    do { \
+        if (Logger::enabled(level)) { \
+            static LogSite log_site_(__FILE__, __LINE__, level); \
+            if (log_site_.admit(per_second)) { \
+                Logger::log_f(level, __VA_ARGS__); \
+            } \
+        } \
+    } while (0)
+
+// Log de acesso de uma rota. No modo resumo acumula contadores atômicos
+// que a thread escritora publica e zera a cada intervalo
+class AccessLog {
+public:
+    explicit AccessLog(const char* route);
+
+    void record(int status, std::chrono::steady_clock::duration elapsed, size_t bytes);
+
+    // Registra a requisição ao sair do escopo do handler, com o status final
+    class Scope {
+    public:
+        Scope(AccessLog& target, const int& response_status, size_t request_bytes)
+            : log(target), status(response_status), bytes(request_bytes),
+              start(std::chrono::steady_clock::now()) {}
+        ~Scope() {
+            // httplib usa -1 até o handler definir; o padrão enviado é 200
+            log.record(status == -1 ? 200 : status, std::chrono::steady_clock::now() - start, bytes);
         }
-        auto size = static_cast<size_t>(size_s);
-        std::unique_ptr<char[]> buf(new char[size]);
-        std::snprintf(buf.get(), size, format.c_str(), args...);
-        return std::string(buf.get(), buf.get() + size - 1);
-    }
-};
\ No newline at end of file
+
+    private:
+        AccessLog& log;
+        const int& status;
+        size_t bytes;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    const char* const route;
+    AccessLog* next = nullptr;
+
+    std::atomic<unsigned long long> requests{0};
+    std::atomic<unsigned long long> errors{0};
+    std::atomic<unsigned long long> bytes_total{0};
+    std::atomic<unsigned long long> total_us{0};
+    std::atomic<unsigned long long> max_us{0};
+};
@@ -0,0 +1,193 @@
+#include "metrics.h"
+#include <cstdio>
+#include <stdexcept>
+
+namespace metrics {
+
+// Histogramas são exportados até este limite (~67 s); acima disso só +Inf
+static constexpr uint64_t EXPORT_LIMIT_US = 1ull << 26;
+
+size_t shard_index() {
+    static std::atomic<size_t> next_shard{0};
+    thread_local size_t index = next_shard.fetch_add(1, std::memory_order_relaxed) % SHARDS;
+    return index;
+}
+
+uint64_t Counter::value() const {
+    uint64_t total = 0;
+    for (const auto& shard : shards) {
+        total += shard.value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+int64_t Gauge::value() const {
+    int64_t total = 0;
+    for (const auto& shard : shards) {
+        total += shard.value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+int Histogram::bucket_for(uint64_t microseconds) {
+    // Faixas fechadas em cima: um valor igual ao limite fica no bucket
+    // desse limite. O bucket 0 fica com 0 e 1 us
+    if (microseconds > 0) {
+        microseconds--;
+    }
+    if (microseconds < static_cast<uint64_t>(SUB_BUCKETS)) {
+        return static_cast<int>(microseconds);
+    }
+
+    // Oitava = posição do bit mais alto; a faixa vem dos bits seguintes
+    int octave = 63 - __builtin_clzll(microseconds);
+    int shift = octave - SUB_BUCKET_BITS;
+    int sub = static_cast<int>(microseconds >> shift) - SUB_BUCKETS;
+    int bucket = SUB_BUCKETS * (shift + 1) + sub;
+    return bucket < BUCKETS ? bucket : BUCKETS - 1;
+}
+
+uint64_t Histogram::bucket_upper_us(int bucket) {
+    if (bucket < SUB_BUCKETS) {
+        return static_cast<uint64_t>(bucket) + 1;
+    }
+    int shift = bucket / SUB_BUCKETS - 1;
+    int sub = bucket % SUB_BUCKETS;
+    return static_cast<uint64_t>(SUB_BUCKETS + sub + 1) << shift;
+}
+
+void Histogram::observe(std::chrono::steady_clock::duration elapsed) {
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+    observe_us(us > 0 ? static_cast<uint64_t>(us) : 0);
+}
+
+void Histogram::observe_us(uint64_t microseconds) {
+    Shard& shard = shards[shard_index()];
+    shard.buckets[bucket_for(microseconds)].fetch_add(1, std::memory_order_relaxed);
+    shard.sum_us.fetch_add(microseconds, std::memory_order_relaxed);
+}
+
+Histogram::Snapshot Histogram::snapshot() const {
+    Snapshot result;
+    for (const auto& shard : shards) {
+        for (int i = 0; i < BUCKETS; i++) {
+            result.buckets[i] += shard.buckets[i].load(std::memory_order_relaxed);
+        }
+        result.sum_us += shard.sum_us.load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+Registry& Registry::instance() {
+    static Registry registry;
+    return registry;
+}
+
+Registry::Family& Registry::family(const std::string& name, const std::string& help, Type type) {
+    auto it = families.find(name);
+    if (it == families.end()) {
+        it = families.emplace(name, Family{type, help, {}, {}, {}}).first;
+    } else if (it->second.type != type) {
+        throw std::logic_error("métrica " + name + " registrada com outro tipo");
+    }
+    return it->second;
+}
+
+Counter& Registry::counter(const std::string& name, const std::string& help, const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& slot = family(name, help, Type::COUNTER).counters[labels];
+    if (!slot) {
+        slot = std::make_unique<Counter>();
+    }
+    return *slot;
+}
+
+Gauge& Registry::gauge(const std::string& name, const std::string& help, const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& slot = family(name, help, Type::GAUGE).gauges[labels];
+    if (!slot) {
+        slot = std::make_unique<Gauge>();
+    }
+    return *slot;
+}
+
+Histogram& Registry::histogram(const std::string& name, const std::string& help, const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& slot = family(name, help, Type::HISTOGRAM).histograms[labels];
+    if (!slot) {
+        slot = std::make_unique<Histogram>();
+    }
+    return *slot;
+}
+
+static std::string series(const std::string& name, const std::string& labels,
+                          const std::string& extra = "") {
+    std::string out = name;
+    if (!labels.empty() || !extra.empty()) {
+        out += '{';
+        out += labels;
+        if (!labels.empty() && !extra.empty()) {
+            out += ',';
+        }
+        out += extra;
+        out += '}';
+    }
+    return out;
+}
+
+static std::string seconds(uint64_t microseconds) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.9g", microseconds / 1e6);
+    return buffer;
+}
+
+std::string Registry::render() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string out;
+    out.reserve(16 * 1024);
+
+    for (const auto& entry : families) {
+        const std::string& name = entry.first;
+        const Family& family = entry.second;
+
+        static const char* type_names[] = {"counter", "gauge", "histogram"};
+        out += "# HELP " + name + " " + family.help + "\n";
+        out += "# TYPE " + name + " " + type_names[static_cast<int>(family.type)] + "\n";
+
+        for (const auto& counter : family.counters) {
+            out += series(name, counter.first) + " " + std::to_string(counter.second->value()) + "\n";
+        }
+        for (const auto& gauge : family.gauges) {
+            out += series(name, gauge.first) + " " + std::to_string(gauge.second->value()) + "\n";
+        }
+        for (const auto& histogram : family.histograms) {
+            Histogram::Snapshot snapshot = histogram.second->snapshot();
+            const std::string& labels = histogram.first;
+
+            // Buckets cumulativos nos limites log-lineares
+            uint64_t cumulative = 0;
+            for (int i = 0; i < Histogram::BUCKETS; i++) {
+                uint64_t upper = Histogram::bucket_upper_us(i);
+                if (upper > EXPORT_LIMIT_US) {
+                    break;
+                }
+                cumulative += snapshot.buckets[i];
+                out += series(name + "_bucket", labels, "le=\"" + seconds(upper) + "\"") + " " +
+                       std::to_string(cumulative) + "\n";
+            }
+
+            // +Inf e _count somam todos os buckets para manter a série monotônica
+            // mesmo com registros concorrentes à leitura
+            uint64_t total = 0;
+            for (uint64_t bucket : snapshot.buckets) {
+                total += bucket;
+            }
+            out += series(name + "_bucket", labels, "le=\"+Inf\"") + " " + std::to_string(total) + "\n";
+            out += series(name + "_sum", labels) + " " + seconds(snapshot.sum_us) + "\n";
+            out += series(name + "_count", labels) + " " + std::to_string(total) + "\n";
+        }
+    }
+    return out;
+}
+
+} // namespace metrics
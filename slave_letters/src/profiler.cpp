@@ -0,0 +1,187 @@
+#include "profiler.h"
+#include "logger.h"
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <signal.h>
+#include <sys/time.h>
+
+namespace profiler {
+
+static constexpr int MAX_DEPTH = 64;
+static constexpr size_t MAX_SAMPLES = 1 << 16;
+
+// Quadros do próprio handler e do trampolim do sinal no topo da pilha
+static constexpr int SKIP_FRAMES = 2;
+
+struct Sample {
+    std::atomic<bool> ready{false};
+    int depth = 0;
+    void* frames[MAX_DEPTH];
+};
+
+static std::atomic<bool> running{false};
+static bool handler_installed = false;
+static std::atomic<Sample*> samples{nullptr};
+static size_t capacity = 0;
+static std::atomic<size_t> next_sample{0};
+static std::atomic<int> handlers_active{0};
+
+static void on_sigprof(int, siginfo_t*, void*) {
+    int saved_errno = errno;
+    handlers_active.fetch_add(1);
+
+    Sample* buffer = samples.load();
+    if (buffer) {
+        size_t index = next_sample.fetch_add(1, std::memory_order_relaxed);
+        if (index < capacity) {
+            Sample& sample = buffer[index];
+            sample.depth = backtrace(sample.frames, MAX_DEPTH);
+            sample.ready.store(true, std::memory_order_release);
+        }
+    }
+
+    handlers_active.fetch_sub(1);
+    errno = saved_errno;
+}
+
+static std::string symbol_name(void* address) {
+    Dl_info info;
+    if (dladdr(address, &info) && info.dli_sname) {
+        int status = 0;
+        char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+        std::string name = status == 0 && demangled ? demangled : info.dli_sname;
+        std::free(demangled);
+        return name;
+    }
+
+    char buffer[64];
+    if (dladdr(address, &info) && info.dli_fname) {
+        const char* module = std::strrchr(info.dli_fname, '/');
+        std::snprintf(buffer, sizeof(buffer), "%s+0x%zx", module ? module + 1 : info.dli_fname,
+                      static_cast<size_t>(static_cast<char*>(address) - static_cast<char*>(info.dli_fbase)));
+    } else {
+        std::snprintf(buffer, sizeof(buffer), "%p", address);
+    }
+    return buffer;
+}
+
+// O formato "folded" usa ';' entre quadros e espaço antes da contagem
+static void append_frame(std::string& stack, const std::string& name) {
+    if (!stack.empty()) {
+        stack += ';';
+    }
+    for (char c : name) {
+        stack += (c == ';' || c == ' ' || c == '\n') ? '_' : c;
+    }
+}
+
+static std::string fold(const Sample* buffer, size_t count) {
+    std::unordered_map<void*, std::string> names;
+    std::unordered_map<std::string, size_t> stacks;
+
+    for (size_t i = 0; i < count; i++) {
+        const Sample& sample = buffer[i];
+        if (!sample.ready.load(std::memory_order_acquire)) {
+            continue;
+        }
+
+        std::string stack;
+        for (int frame = sample.depth - 1; frame >= SKIP_FRAMES; frame--) {
+            void* address = sample.frames[frame];
+            auto it = names.find(address);
+            if (it == names.end()) {
+                // Endereço de retorno: -1 cai dentro da instrução de chamada
+                it = names.emplace(address, symbol_name(static_cast<char*>(address) - 1)).first;
+            }
+            append_frame(stack, it->second);
+        }
+        if (!stack.empty()) {
+            stacks[stack]++;
+        }
+    }
+
+    std::string folded;
+    for (const auto& stack : stacks) {
+        folded += stack.first;
+        folded += ' ';
+        folded += std::to_string(stack.second);
+        folded += '\n';
+    }
+    return folded;
+}
+
+bool collect(const Options& options, Profile& profile) {
+    bool expected = false;
+    if (!running.compare_exchange_strong(expected, true)) {
+        return false;
+    }
+
+    int frequency = options.frequency > 0 ? options.frequency : 99;
+    int seconds = options.seconds > 0 ? options.seconds : 1;
+
+    // Dimensiona para até 8 threads ocupadas; acima disso conta como perdida
+    size_t wanted = static_cast<size_t>(seconds) * static_cast<size_t>(frequency) * 8;
+    size_t buffer_size = wanted < MAX_SAMPLES ? wanted : MAX_SAMPLES;
+    std::unique_ptr<Sample[]> buffer(new Sample[buffer_size]);
+
+    // A primeira chamada de backtrace carrega o unwinder (aloca); fazer
+    // isso aqui evita que aconteça dentro do handler
+    void* warmup[4];
+    backtrace(warmup, 4);
+
+    capacity = buffer_size;
+    next_sample.store(0);
+    samples.store(buffer.get());
+
+    // O handler fica instalado depois da primeira coleta: um SIGPROF ainda
+    // pendente após parar o timer encerraria o processo com a ação padrão
+    if (!handler_installed) {
+        struct sigaction action = {};
+        action.sa_sigaction = on_sigprof;
+        action.sa_flags = SA_SIGINFO | SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGPROF, &action, nullptr);
+        handler_installed = true;
+    }
+
+    struct itimerval timer = {};
+    timer.it_interval.tv_sec = 0;
+    timer.it_interval.tv_usec = 1000000 / frequency;
+    timer.it_value = timer.it_interval;
+    setitimer(ITIMER_PROF, &timer, nullptr);
+
+    Logger::info_f("Profiler iniciado: %d s a %d Hz", seconds, frequency);
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+
+    struct itimerval stop = {};
+    setitimer(ITIMER_PROF, &stop, nullptr);
+
+    // Sinais já entregues podem ainda estar no handler: o buffer só é lido
+    // e liberado depois que nenhum handler o referencia
+    samples.store(nullptr);
+    while (handlers_active.load() > 0) {
+        std::this_thread::yield();
+    }
+
+    size_t taken = next_sample.load();
+    profile.samples = taken < buffer_size ? taken : buffer_size;
+    profile.dropped = taken - profile.samples;
+    profile.folded = fold(buffer.get(), profile.samples);
+
+    running.store(false);
+    Logger::info_f("Profiler concluído: %zu amostras, %zu perdidas", profile.samples, profile.dropped);
+    return true;
+}
+
+} // namespace profiler
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace httplib {
+    class Client;
+}
+
+// Worker genérico do modo pull: busca fatias de texto na fila do mestre
+// (/work/poll), conta com o núcleo do tipo pedido e devolve o resultado
+// (/work/result). Qualquer escravo pode executar qualquer tipo de tarefa.
+class PullWorker {
+public:
+    PullWorker(const std::string& master_url, const std::string& name,
+               const std::string& preferred_type, int threads);
+    ~PullWorker();
+
+    void start();
+    void stop();
+
+    unsigned long long tasks_done() const;
+
+private:
+    std::string master_url;
+    std::string name;
+    std::string preferred_type;
+    int thread_count;
+
+    std::atomic<bool> running;
+    std::atomic<unsigned long long> completed;
+    std::vector<std::thread> threads;
+
+    // Um cliente por thread (conexão persistente); guardados para que stop()
+    // possa interromper long polls em andamento
+    std::vector<std::unique_ptr<httplib::Client>> clients;
+
+    void run(int index);
+};
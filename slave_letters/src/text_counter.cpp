@@ -0,0 +1,26 @@
+#include "text_counter.h"
+#include <cctype>
+
+long long count_letters_in(const char* data, size_t length) {
+    long long count = 0;
+
+    for (size_t i = 0; i < length; i++) {
+        if (std::isalpha(static_cast<unsigned char>(data[i]))) {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+long long count_digits_in(const char* data, size_t length) {
+    long long count = 0;
+
+    for (size_t i = 0; i < length; i++) {
+        if (std::isdigit(static_cast<unsigned char>(data[i]))) {
+            count++;
+        }
+    }
+
+    return count;
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstddef>
+
+// Núcleos de contagem compartilhados pelos endpoints dos escravos e pelo
+// modo worker, que executa tarefas de qualquer tipo
+
+// Letras ASCII básicas (a-z, A-Z)
+long long count_letters_in(const char* data, size_t length);
+
+// Dígitos ASCII (0-9)
+long long count_digits_in(const char* data, size_t length);
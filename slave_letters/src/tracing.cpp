@@ -0,0 +1,171 @@
+#include "tracing.h"
+#include "logger.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cctype>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <thread>
+#include <mutex>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace tracing {
+
+static constexpr double DEFAULT_SAMPLE_RATE = 0.01;
+
+static std::mutex configure_mutex;
+static FILE* trace_file = nullptr;
+static std::atomic<bool> tracing_enabled{false};
+static double sample_rate = DEFAULT_SAMPLE_RATE;
+
+// Containers costumam ter todos os serviços com PID 1; o "pid" do trace
+// combina host e PID para separar os processos na visualização
+static long trace_pid = 0;
+
+static std::mt19937_64& random_engine() {
+    thread_local std::mt19937_64 engine(std::random_device{}() ^
+                                        std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    return engine;
+}
+
+static long thread_id() {
+    thread_local long tid = static_cast<long>(::syscall(SYS_gettid));
+    return tid;
+}
+
+static void write_event(const char* line, int length) {
+    if (length > 0) {
+        std::fwrite(line, 1, static_cast<size_t>(length), trace_file);
+    }
+}
+
+void configure(const std::string& process_name) {
+    std::lock_guard<std::mutex> lock(configure_mutex);
+
+    const char* path = std::getenv("TRACE_FILE");
+    if (!path || !*path || trace_file) {
+        return;
+    }
+
+    if (const char* rate = std::getenv("TRACE_SAMPLE_RATE")) {
+        sample_rate = std::strtod(rate, nullptr);
+    }
+
+    trace_file = std::fopen(path, "a");
+    if (!trace_file) {
+        Logger::error_f("Não foi possível abrir o arquivo de trace %s", path);
+        return;
+    }
+
+    // Um evento por linha: bufferizado por linha para não perder spans num crash
+    std::setvbuf(trace_file, nullptr, _IOLBF, 0);
+
+    char host[256] = {};
+    gethostname(host, sizeof(host) - 1);
+    trace_pid = static_cast<long>((std::hash<std::string>{}(host) ^ static_cast<size_t>(getpid())) & 0x7fffffff);
+
+    if (std::ftell(trace_file) == 0) {
+        std::fputs("[\n", trace_file);
+    }
+
+    char line[512];
+    int length = std::snprintf(line, sizeof(line),
+                               "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%ld,"
+                               "\"args\":{\"name\":\"%s (%s)\"}},\n",
+                               trace_pid, process_name.c_str(), host);
+    write_event(line, length);
+
+    tracing_enabled.store(true);
+    Logger::info_f("Trace habilitado em %s (amostragem %.3f)", path, sample_rate);
+}
+
+bool enabled() {
+    return tracing_enabled.load(std::memory_order_relaxed);
+}
+
+std::string new_request_id() {
+    char buffer[17];
+    std::snprintf(buffer, sizeof(buffer), "%016llx",
+                  static_cast<unsigned long long>(random_engine()()));
+    return buffer;
+}
+
+// O ID vem de um cabeçalho e é repassado adiante e gravado no JSON do
+// trace: só caracteres seguros, até 64
+static std::string sanitize_request_id(const std::string& request_id) {
+    std::string safe;
+    for (char c : request_id) {
+        if (safe.size() >= 64) {
+            break;
+        }
+        if (std::isalnum(static_cast<unsigned char>(c)) || c == '-' || c == '_' || c == '.') {
+            safe += c;
+        }
+    }
+    return safe;
+}
+
+Context accept(const std::string& request_id, const std::string& sampled) {
+    Context context;
+    context.request_id = sanitize_request_id(request_id);
+    if (context.request_id.empty()) {
+        context.request_id = new_request_id();
+    }
+
+    if (!enabled()) {
+        context.sampled = false;
+    } else if (!sampled.empty()) {
+        context.sampled = sampled == "1";
+    } else {
+        std::uniform_real_distribution<double> distribution(0.0, 1.0);
+        context.sampled = distribution(random_engine()) < sample_rate;
+    }
+    return context;
+}
+
+uint64_t now_us() {
+    return to_us(std::chrono::steady_clock::now());
+}
+
+uint64_t to_us(std::chrono::steady_clock::time_point point) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        point.time_since_epoch()).count());
+}
+
+void record(const Context& context, const char* name, uint64_t start_us, uint64_t end_us) {
+    if (!context.sampled || !enabled()) {
+        return;
+    }
+
+    char line[512];
+    int written = std::snprintf(line, sizeof(line),
+                                "{\"name\":\"%s\",\"cat\":\"request\",\"ph\":\"X\",\"ts\":%llu,"
+                                "\"dur\":%llu,\"pid\":%ld,\"tid\":%ld,\"args\":{\"request_id\":\"%s\"}},\n",
+                                name, static_cast<unsigned long long>(start_us),
+                                static_cast<unsigned long long>(end_us >= start_us ? end_us - start_us : 0),
+                                trace_pid, thread_id(), context.request_id.c_str());
+    write_event(line, written);
+}
+
+Span::Span(const Context& trace_context, const char* span_name)
+    : context(trace_context), name(span_name), start_us(trace_context.sampled ? now_us() : 0),
+      open(true) {}
+
+Span::~Span() {
+    end();
+}
+
+void Span::end() {
+    if (open) {
+        open = false;
+        if (context.sampled) {
+            record(context, name, start_us, now_us());
+        }
+    }
+}
+
+} // namespace tracing
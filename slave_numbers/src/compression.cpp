@@ -0,0 +1,220 @@
+#include "compression.h"
+#include <algorithm>
+#include <climits>
+#include <stdexcept>
+#include <vector>
+#ifdef CPPHTTPLIB_ZLIB_SUPPORT
+#include <zlib.h>
+#endif
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace compression {
+
+// Nível rápido: o objetivo é economizar rede sem virar o gargalo da CPU
+static constexpr int GZIP_LEVEL = 1;
+static constexpr int ZSTD_LEVEL = 1;
+
+// Saída da compressão gzip, acrescentada ao resultado a cada volta
+static constexpr size_t GZIP_BUFFER_SIZE = 256 * 1024;
+
+const char* name(Encoding encoding) {
+    switch (encoding) {
+    case Encoding::GZIP:
+        return "gzip";
+    case Encoding::ZSTD:
+        return "zstd";
+    default:
+        return "";
+    }
+}
+
+Encoding parse(const std::string& content_encoding) {
+    Encoding encoding;
+    if (content_encoding.empty() || content_encoding == "identity") {
+        encoding = Encoding::IDENTITY;
+    } else if (content_encoding == "gzip") {
+        encoding = Encoding::GZIP;
+    } else if (content_encoding == "zstd") {
+        encoding = Encoding::ZSTD;
+    } else {
+        throw std::invalid_argument("Content-Encoding não suportado: " + content_encoding);
+    }
+
+    if (!supported(encoding)) {
+        throw std::invalid_argument("Content-Encoding não suportado: " + content_encoding);
+    }
+    return encoding;
+}
+
+bool supported(Encoding encoding) {
+    switch (encoding) {
+    case Encoding::IDENTITY:
+        return true;
+    case Encoding::GZIP:
+#ifdef CPPHTTPLIB_ZLIB_SUPPORT
+        return true;
+#else
+        return false;
+#endif
+    case Encoding::ZSTD:
+#ifdef HAVE_ZSTD
+        return true;
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+std::string accepted() {
+    std::string list;
+    for (Encoding encoding : {Encoding::ZSTD, Encoding::GZIP}) {
+        if (supported(encoding)) {
+            list += list.empty() ? "" : ", ";
+            list += name(encoding);
+        }
+    }
+    return list.empty() ? "identity" : list;
+}
+
+std::string compress(Encoding encoding, const char* data, size_t length) {
+    switch (encoding) {
+    case Encoding::IDENTITY:
+        return std::string(data, length);
+
+    case Encoding::GZIP: {
+#ifdef CPPHTTPLIB_ZLIB_SUPPORT
+        z_stream stream{};
+        // 15 + 16: janela máxima com cabeçalho gzip
+        if (deflateInit2(&stream, GZIP_LEVEL, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            throw std::runtime_error("Falha ao iniciar a compressão gzip");
+        }
+
+        // avail_in e avail_out são uInt: a entrada vai em partes de até
+        // UINT_MAX e a saída cresce por buffers, então textos de 4 GiB ou
+        // mais não são truncados
+        std::string output;
+        std::vector<char> buffer(GZIP_BUFFER_SIZE);
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+        size_t remaining = length;
+        int result = Z_OK;
+        while (result == Z_OK) {
+            uInt part = static_cast<uInt>(std::min<size_t>(remaining, UINT_MAX));
+            stream.avail_in = part;
+            stream.next_out = reinterpret_cast<Bytef*>(buffer.data());
+            stream.avail_out = static_cast<uInt>(buffer.size());
+            result = deflate(&stream, remaining == part ? Z_FINISH : Z_NO_FLUSH);
+            remaining -= part - stream.avail_in;
+            output.append(buffer.data(), buffer.size() - stream.avail_out);
+        }
+        deflateEnd(&stream);
+
+        if (result != Z_STREAM_END) {
+            throw std::runtime_error("Falha na compressão gzip");
+        }
+        return output;
+#else
+        break;
+#endif
+    }
+
+    case Encoding::ZSTD: {
+#ifdef HAVE_ZSTD
+        std::string output(ZSTD_compressBound(length), '\0');
+        size_t written = ZSTD_compress(&output[0], output.size(), data, length, ZSTD_LEVEL);
+        if (ZSTD_isError(written)) {
+            throw std::runtime_error(std::string("Falha na compressão zstd: ") + ZSTD_getErrorName(written));
+        }
+        output.resize(written);
+        return output;
+#else
+        break;
+#endif
+    }
+    }
+    throw std::runtime_error(std::string("Compressão não disponível: ") + name(encoding));
+}
+
+struct StreamDecoder::State {
+#ifdef HAVE_ZSTD
+    ZSTD_DStream* stream = nullptr;
+    std::vector<char> buffer;
+    // Último retorno de ZSTD_decompressStream: 0 = quadro completo
+    size_t pending = 0;
+#endif
+};
+
+StreamDecoder::StreamDecoder(Encoding stream_encoding, Sink chunk_sink)
+    : encoding(stream_encoding), sink(std::move(chunk_sink)), state(new State()) {
+    if (encoding == Encoding::GZIP) {
+        throw std::invalid_argument("gzip é descomprimido pelo httplib");
+    }
+    if (encoding == Encoding::ZSTD) {
+#ifdef HAVE_ZSTD
+        state->stream = ZSTD_createDStream();
+        if (!state->stream) {
+            throw std::runtime_error("Falha ao iniciar a descompressão zstd");
+        }
+        ZSTD_initDStream(state->stream);
+        state->buffer.resize(ZSTD_DStreamOutSize());
+#else
+        throw std::invalid_argument("Content-Encoding não suportado: zstd");
+#endif
+    }
+}
+
+StreamDecoder::~StreamDecoder() {
+#ifdef HAVE_ZSTD
+    if (state->stream) {
+        ZSTD_freeDStream(state->stream);
+    }
+#endif
+}
+
+void StreamDecoder::write(const char* data, size_t length) {
+    if (encoding == Encoding::IDENTITY) {
+        sink(data, length);
+        return;
+    }
+
+#ifdef HAVE_ZSTD
+    ZSTD_inBuffer input{data, length, 0};
+    bool output_full = false;
+    // Com a saída cheia o decodificador pode ter mais a entregar, mesmo
+    // com a entrada já consumida
+    while (input.pos < input.size || output_full) {
+        ZSTD_outBuffer output{state->buffer.data(), state->buffer.size(), 0};
+        size_t result = ZSTD_decompressStream(state->stream, &output, &input);
+        if (ZSTD_isError(result)) {
+            throw std::runtime_error(std::string("Corpo zstd inválido: ") + ZSTD_getErrorName(result));
+        }
+        state->pending = result;
+        if (output.pos > 0) {
+            sink(state->buffer.data(), output.pos);
+        }
+        output_full = output.pos == output.size;
+    }
+#endif
+}
+
+void StreamDecoder::finish() {
+#ifdef HAVE_ZSTD
+    if (encoding == Encoding::ZSTD && state->pending != 0) {
+        throw std::runtime_error("Corpo zstd truncado");
+    }
+#endif
+}
+
+std::string decompress(Encoding encoding, const std::string& data) {
+    std::string output;
+    StreamDecoder decoder(encoding, [&output](const char* chunk, size_t length) {
+        output.append(chunk, length);
+    });
+    decoder.write(data.data(), data.size());
+    decoder.finish();
+    return output;
+}
+
+} // namespace compression
@@ -4,22 +4,27 @@
 #include <thread>
 #include "numbers_server.h"
 #include "logger.h"
+#include "tracing.h"
+#include "master_registration.h"
+#include "pull_worker.h"
+#include <cstdlib>
+#include <memory>
 
 std::atomic<bool> keep_running(true);
-NumbersServer* server_instance = nullptr;
+std::atomic<int> received_signal(0);
 
+// Só atômicos aqui: o logger (anel por thread) e o stop() do servidor não
+// são seguros dentro de um handler de sinal. O loop principal loga e para
 void signal_handler(int signal) {
-    Logger::info_f("Sinal recebido: %d", signal);
+    received_signal = signal;
     keep_running = false;
-    if (server_instance) {
-        server_instance->stop();
-    }
 }
 
 int main(int argc, char* argv[]) {
     // Configurar logs
     Logger::set_component_name("SLAVE-NUMBERS");
     Logger::set_log_level(LogLevel::DEBUG);
+    tracing::configure("SLAVE-NUMBERS");
     
     Logger::info("=== INICIANDO ESCRAVO DE NÚMEROS ===");
     
@@ -42,7 +47,6 @@ int main(int argc, char* argv[]) {
     try {
         // Criar e iniciar servidor
         NumbersServer server(port);
-        server_instance = &server;
         
         Logger::info_f("Tentando iniciar servidor na porta %d", port);
         
@@ -56,6 +60,40 @@ int main(int argc, char* argv[]) {
         
         // Aguardar um pouco para verificar se o servidor iniciou
         std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        // Registro dinâmico no mestre (MASTER_URL=http://master:8080)
+        std::unique_ptr<MasterRegistration> registration;
+        const char* master_url = std::getenv("MASTER_URL");
+        if (keep_running && master_url && *master_url) {
+            std::string host = MasterRegistration::default_advertise_host();
+            registration = std::make_unique<MasterRegistration>(
+                master_url, "slave-numbers-" + host, host, port, "/numeros", "numbers",
+                [&server]() {
+                    LoadStats stats;
+                    stats.in_flight = server.in_flight_requests();
+                    stats.requests_total = server.total_requests();
+                    double load[1];
+                    if (getloadavg(load, 1) == 1) {
+                        stats.load_average = load[0];
+                    }
+                    return stats;
+                });
+            registration->start();
+        }
+
+        // Modo worker: buscar tarefas de qualquer tipo na fila do mestre
+        std::unique_ptr<PullWorker> worker;
+        const char* worker_mode = std::getenv("WORKER_MODE");
+        if (keep_running && master_url && *master_url && worker_mode && std::string(worker_mode) == "1") {
+            int threads = 2;
+            if (const char* worker_threads = std::getenv("WORKER_THREADS")) {
+                threads = std::atoi(worker_threads);
+            }
+            worker = std::make_unique<PullWorker>(master_url,
+                                                  "slave-numbers-" + MasterRegistration::default_advertise_host(),
+                                                  "numbers", threads);
+            worker->start();
+        }
         
         if (keep_running) {
             Logger::info("=== ESCRAVO DE NÚMEROS INICIADO COM SUCESSO ===");
@@ -68,7 +106,18 @@ int main(int argc, char* argv[]) {
             }
         }
         
+        if (received_signal) {
+            Logger::info_f("Sinal recebido: %d", received_signal.load());
+        }
         Logger::info("Iniciando shutdown graceful...");
+
+        // Parar de buscar tarefas e sair do mestre antes de parar de atender
+        if (worker) {
+            worker->stop();
+        }
+        if (registration) {
+            registration->stop();
+        }
         server.stop();
         
         if (server_thread.joinable()) {
@@ -0,0 +1,175 @@
+#include "master_registration.h"
+#include "logger.h"
+#include <httplib.h>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <unistd.h>
+
+using json = nlohmann::json;
+
+// Intervalo máximo entre tentativas de registro
+static constexpr int MAX_REGISTER_BACKOFF_S = 30;
+
+MasterRegistration::MasterRegistration(const std::string& master_url, const std::string& name,
+                                       const std::string& host, int port, const std::string& endpoint,
+                                       const std::string& type, std::function<LoadStats()> stats_provider)
+    : master_url(master_url), name(name), host(host), port(port), endpoint(endpoint),
+      type(type), stats_provider(std::move(stats_provider)) {}
+
+MasterRegistration::~MasterRegistration() {
+    stop();
+}
+
+void MasterRegistration::start() {
+    if (worker.joinable()) {
+        return;
+    }
+
+    Logger::info_f("Registrando %s no mestre %s (anunciando %s:%d)",
+                  name.c_str(), master_url.c_str(), host.c_str(), port);
+    worker = std::thread(&MasterRegistration::run, this);
+}
+
+void MasterRegistration::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+std::string MasterRegistration::default_advertise_host() {
+    if (const char* advertised = std::getenv("SLAVE_ADVERTISE_HOST")) {
+        if (*advertised) {
+            return advertised;
+        }
+    }
+
+    // Em redes Docker o hostname (ID curto do container) é resolvível pelos demais
+    char hostname[256] = {0};
+    if (gethostname(hostname, sizeof(hostname) - 1) == 0) {
+        return hostname;
+    }
+    return "localhost";
+}
+
+bool MasterRegistration::wait_for(std::chrono::seconds interval) {
+    std::unique_lock<std::mutex> lock(mutex);
+    return !wake.wait_for(lock, interval, [this]() { return stopping; });
+}
+
+void MasterRegistration::run() {
+    bool registered = false;
+    int backoff_s = 1;
+
+    while (true) {
+        if (!registered) {
+            registered = register_once();
+            if (!registered) {
+                if (!wait_for(std::chrono::seconds(backoff_s))) {
+                    break;
+                }
+                backoff_s = std::min(backoff_s * 2, MAX_REGISTER_BACKOFF_S);
+                continue;
+            }
+            backoff_s = 1;
+        }
+
+        if (!wait_for(std::chrono::seconds(heartbeat_interval_s))) {
+            break;
+        }
+
+        int status = send_heartbeat();
+        if (status == 404) {
+            // Lease expirou ou mestre reiniciou: registrar novamente
+            Logger::warning("Mestre não reconhece este escravo, registrando novamente");
+            registered = false;
+        } else if (status != 200) {
+            Logger::warning_f("Heartbeat para o mestre falhou (status %d)", status);
+        }
+    }
+
+    if (registered) {
+        deregister();
+    }
+}
+
+bool MasterRegistration::register_once() {
+    try {
+        httplib::Client client(master_url);
+        client.set_connection_timeout(3, 0);
+        client.set_read_timeout(5, 0);
+
+        json request_data;
+        request_data["name"] = name;
+        request_data["host"] = host;
+        request_data["port"] = port;
+        request_data["endpoint"] = endpoint;
+        request_data["type"] = type;
+
+        auto response = client.Post("/register", request_data.dump(), "application/json");
+        if (!response || response->status != 200) {
+            Logger::warning_f("Registro no mestre %s falhou, tentando novamente", master_url.c_str());
+            return false;
+        }
+
+        json response_json = json::parse(response->body);
+        heartbeat_interval_s = std::max(1, response_json.value("heartbeat_interval_s", 5));
+
+        Logger::info_f("Registrado no mestre como %s (heartbeat a cada %d s)",
+                      name.c_str(), heartbeat_interval_s);
+        return true;
+
+    } catch (const std::exception& e) {
+        Logger::warning_f("Erro ao registrar no mestre: %s", e.what());
+        return false;
+    }
+}
+
+int MasterRegistration::send_heartbeat() {
+    try {
+        httplib::Client client(master_url);
+        client.set_connection_timeout(3, 0);
+        client.set_read_timeout(5, 0);
+
+        LoadStats stats = stats_provider ? stats_provider() : LoadStats();
+
+        json request_data;
+        request_data["name"] = name;
+        request_data["in_flight"] = stats.in_flight;
+        request_data["requests_total"] = stats.requests_total;
+        request_data["load_average"] = stats.load_average;
+
+        auto response = client.Post("/heartbeat", request_data.dump(), "application/json");
+        return response ? response->status : -1;
+
+    } catch (const std::exception&) {
+        return -1;
+    }
+}
+
+void MasterRegistration::deregister() {
+    try {
+        httplib::Client client(master_url);
+        client.set_connection_timeout(2, 0);
+        client.set_read_timeout(2, 0);
+
+        json request_data;
+        request_data["name"] = name;
+
+        auto response = client.Post("/deregister", request_data.dump(), "application/json");
+        if (response && response->status == 200) {
+            Logger::info_f("Escravo %s removido do mestre", name.c_str());
+        } else {
+            Logger::warning_f("Falha ao remover %s do mestre", name.c_str());
+        }
+
+    } catch (const std::exception& e) {
+        Logger::warning_f("Erro ao remover registro no mestre: %s", e.what());
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Estatísticas de carga enviadas ao mestre em cada heartbeat
+struct LoadStats {
+    int in_flight = 0;
+    unsigned long long requests_total = 0;
+    double load_average = 0.0;
+};
+
+// Registro do escravo no mestre (/register), renovação do lease por
+// heartbeats (/heartbeat) e remoção no encerramento (/deregister)
+class MasterRegistration {
+public:
+    MasterRegistration(const std::string& master_url, const std::string& name,
+                       const std::string& host, int port, const std::string& endpoint,
+                       const std::string& type, std::function<LoadStats()> stats_provider);
+    ~MasterRegistration();
+
+    void start();
+    void stop();
+
+    // Host anunciado ao mestre: SLAVE_ADVERTISE_HOST ou o hostname do container
+    static std::string default_advertise_host();
+
+private:
+    std::string master_url;
+    std::string name;
+    std::string host;
+    int port;
+    std::string endpoint;
+    std::string type;
+    std::function<LoadStats()> stats_provider;
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    int heartbeat_interval_s = 5;
+
+    void run();
+    bool register_once();
+    int send_heartbeat();
+    void deregister();
+
+    // Aguarda o intervalo ou o pedido de parada; retorna false se deve parar
+    bool wait_for(std::chrono::seconds interval);
+};
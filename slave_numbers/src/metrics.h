@@ -0,0 +1,146 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Métricas no formato texto do Prometheus (/metrics).
+//
+// Cada métrica é dividida em fatias por thread, cada uma em sua linha de
+// cache: o registro é um fetch_add relaxado na fatia da thread atual, sem
+// lock nem disputa com outras threads. Só a exportação soma as fatias.
+namespace metrics {
+
+constexpr size_t SHARDS = 16;
+
+// Fatia da thread atual (atribuída em rodízio na primeira chamada)
+size_t shard_index();
+
+class Counter {
+public:
+    void add(uint64_t value = 1) {
+        shards[shard_index()].value.fetch_add(value, std::memory_order_relaxed);
+    }
+    uint64_t value() const;
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> value{0};
+    };
+    std::array<Shard, SHARDS> shards;
+};
+
+class Gauge {
+public:
+    void add(int64_t value) {
+        shards[shard_index()].value.fetch_add(value, std::memory_order_relaxed);
+    }
+    int64_t value() const;
+
+    // Incrementa na construção e decrementa na destruição (ex.: em andamento)
+    class Scope {
+    public:
+        explicit Scope(Gauge& target) : gauge(target) { gauge.add(1); }
+        ~Scope() { gauge.add(-1); }
+
+    private:
+        Gauge& gauge;
+    };
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<int64_t> value{0};
+    };
+    std::array<Shard, SHARDS> shards;
+};
+
+// Histograma log-linear de durações em microssegundos: cada potência de
+// dois é dividida em 4 faixas lineares (erro relativo máximo de 25%)
+class Histogram {
+public:
+    static constexpr int SUB_BUCKET_BITS = 2;
+    static constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static constexpr int OCTAVES = 36;  // até 2^36 us (~19 h)
+    static constexpr int BUCKETS = SUB_BUCKETS * OCTAVES;
+
+    void observe(std::chrono::steady_clock::duration elapsed);
+    void observe_us(uint64_t microseconds);
+
+    // Soma das fatias; o total de registros é a soma dos buckets
+    struct Snapshot {
+        std::array<uint64_t, BUCKETS> buckets{};
+        uint64_t sum_us = 0;
+    };
+    Snapshot snapshot() const;
+
+    static int bucket_for(uint64_t microseconds);
+
+    // Limite superior (inclusivo, como o "le" do Prometheus) da faixa, em
+    // microssegundos
+    static uint64_t bucket_upper_us(int bucket);
+
+private:
+    struct alignas(64) Shard {
+        std::array<std::atomic<uint64_t>, BUCKETS> buckets{};
+        std::atomic<uint64_t> sum_us{0};
+    };
+    std::array<Shard, SHARDS> shards;
+};
+
+// Registra a duração do escopo no histograma
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Histogram& target)
+        : histogram(target), start(std::chrono::steady_clock::now()) {}
+    ~ScopedTimer() { histogram.observe(std::chrono::steady_clock::now() - start); }
+
+private:
+    Histogram& histogram;
+    std::chrono::steady_clock::time_point start;
+};
+
+// Registro do processo. Métricas são criadas uma vez (normalmente em
+// estáticos) e nunca removidas; as referências retornadas são estáveis.
+// labels usa a sintaxe do Prometheus sem chaves: route="/process"
+class Registry {
+public:
+    static Registry& instance();
+
+    Counter& counter(const std::string& name, const std::string& help, const std::string& labels = "");
+    Gauge& gauge(const std::string& name, const std::string& help, const std::string& labels = "");
+    Histogram& histogram(const std::string& name, const std::string& help, const std::string& labels = "");
+
+    // Texto no formato de exposição 0.0.4
+    std::string render() const;
+
+private:
+    enum class Type { COUNTER, GAUGE, HISTOGRAM };
+
+    struct Family {
+        Type type;
+        std::string help;
+        std::map<std::string, std::unique_ptr<Counter>> counters;
+        std::map<std::string, std::unique_ptr<Gauge>> gauges;
+        std::map<std::string, std::unique_ptr<Histogram>> histograms;
+    };
+
+    mutable std::mutex mutex;
+    std::map<std::string, Family> families;
+
+    Family& family(const std::string& name, const std::string& help, Type type);
+};
+
+inline Registry& registry() {
+    return Registry::instance();
+}
+
+// Content-Type da resposta de /metrics
+constexpr const char* CONTENT_TYPE = "text/plain; version=0.0.4";
+
+} // namespace metrics
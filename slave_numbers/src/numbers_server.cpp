@@ -1,13 +1,72 @@
 #include "numbers_server.h"
 #include "logger.h"
+#include "metrics.h"
+#include "tracing.h"
+#include "request_tracker.h"
+#include "profiler.h"
+#include "text_counter.h"
+#include "hw_counters.h"
+#include "alloc_tracking.h"
+#include "compression.h"
 #include <httplib.h>
 #include <nlohmann/json.hpp>
-#include <cctype>
+#include <algorithm>
 #include <chrono>
+#include <memory>
+#include <stdexcept>
 
 using json = nlohmann::json;
 
-NumbersServer::NumbersServer(int server_port) : port(server_port), running(false) {
+// Métricas do escravo exportadas em /metrics
+namespace {
+
+struct SlaveMetrics {
+    metrics::Counter& requests = metrics::registry().counter(
+        "requests_total", "Requisições recebidas", "route=\"/numeros\"");
+    metrics::Counter& errors = metrics::registry().counter(
+        "request_errors_total", "Requisições que terminaram com erro", "route=\"/numeros\"");
+    metrics::Counter& bytes = metrics::registry().counter(
+        "request_bytes_total", "Bytes recebidos no corpo das requisições", "route=\"/numeros\"");
+    metrics::Counter& characters = metrics::registry().counter(
+        "characters_processed_total", "Caracteres de texto contados", "route=\"/numeros\"");
+    metrics::Gauge& in_flight = metrics::registry().gauge(
+        "requests_in_flight", "Requisições em andamento", "route=\"/numeros\"");
+    metrics::Histogram& duration = metrics::registry().histogram(
+        "request_duration_seconds", "Duração total da requisição", "route=\"/numeros\"");
+
+    metrics::Histogram& parse = metrics::registry().histogram(
+        "stage_duration_seconds", "Duração de cada etapa da requisição", "stage=\"parse\"");
+    metrics::Histogram& count = metrics::registry().histogram(
+        "stage_duration_seconds", "Duração de cada etapa da requisição", "stage=\"count\"");
+};
+
+SlaveMetrics& slave_metrics() {
+    static SlaveMetrics instance;
+    return instance;
+}
+
+// Momento em que os cabeçalhos da requisição atual chegaram (ver o
+// pre-routing handler); a mesma thread executa o handler da rota
+thread_local uint64_t request_headers_us = 0;
+
+// Corpo em text/plain: o próprio texto, sem o envelope JSON
+bool is_plain_text(const httplib::Request& req) {
+    return req.get_header_value("Content-Type").compare(0, 10, "text/plain") == 0;
+}
+
+// Tamanho do corpo pelo Content-Length (0 se ausente ou inválido)
+size_t request_length(const httplib::Request& req) {
+    try {
+        return std::stoull(req.get_header_value("Content-Length"));
+    } catch (const std::exception&) {
+        return 0;
+    }
+}
+
+} // namespace
+
+NumbersServer::NumbersServer(int server_port)
+    : port(server_port), running(false), in_flight(0), requests_total(0) {
     Logger::info_f("Servidor de números criado na porta %d", port);
 }
 
@@ -36,36 +95,216 @@ bool NumbersServer::start() {
             response["port"] = port;
 
             res.set_content(response.dump(), "application/json");
-            Logger::debug("Health check requisitado no servidor de números");
+            Logger::debug_f("Health check requisitado no servidor de números");
         });
 
-        // Endpoint principal para contar números
-        server.Post("/numeros", [this](const httplib::Request& req, httplib::Response& res) {
-            Logger::info_f("Servidor mestre conectado ao escravo de números de %s", req.remote_addr.c_str());
-            Logger::info("Requisição de contagem de números recebida");
+        // Métricas no formato Prometheus
+        server.Get("/metrics", [](const httplib::Request&, httplib::Response& res) {
+            res.set_content(metrics::registry().render(), metrics::CONTENT_TYPE);
+        });
 
+        // Requisições em andamento e as mais lentas recentes
+        server.Get("/debug/requests", [](const httplib::Request&, httplib::Response& res) {
+            res.set_content(RequestTracker::instance().render(), "application/json");
+        });
+
+        // Profile de CPU por amostragem, em formato folded (flamegraph.pl)
+        server.Get("/debug/profile", [](const httplib::Request& req, httplib::Response& res) {
+            profiler::Options options;
             try {
-                json request_json = json::parse(req.body);
-                std::string text = request_json["text"];
+                if (req.has_param("seconds")) {
+                    options.seconds = std::stoi(req.get_param_value("seconds"));
+                }
+                if (req.has_param("hz")) {
+                    options.frequency = std::stoi(req.get_param_value("hz"));
+                }
+            } catch (const std::exception&) {
+                res.status = 400;
+                json error_response;
+                error_response["success"] = false;
+                error_response["error"] = "Parâmetros inválidos";
+                res.set_content(error_response.dump(), "application/json");
+                return;
+            }
+            options.seconds = std::max(1, std::min(options.seconds, 60));
+            options.frequency = std::max(1, std::min(options.frequency, 1000));
 
-                Logger::debug_f("Processando texto de %zu caracteres para números", text.length());
+            profiler::Profile profile;
+            if (!profiler::collect(options, profile)) {
+                res.status = 409;
+                json error_response;
+                error_response["success"] = false;
+                error_response["error"] = "Profile já em andamento";
+                res.set_content(error_response.dump(), "application/json");
+                return;
+            }
+            res.set_header("X-Profile-Samples", std::to_string(profile.samples));
+            res.set_header("X-Profile-Dropped", std::to_string(profile.dropped));
+            res.set_content(profile.folded, "text/plain");
+        });
 
-                auto start_time = std::chrono::high_resolution_clock::now();
+        // Endpoint principal para contar números. O corpo é o texto cru
+        // (text/plain, como o mestre envia) ou {"text": "..."}, com
+        // Content-Encoding gzip ou zstd. Em text/plain a contagem acontece à
+        // medida que o corpo chega e é descomprimido, sem montar o texto
+        server.Post("/numeros", [this](const httplib::Request& req, httplib::Response& res,
+                                       const httplib::ContentReader& content_reader) {
+            // O corpo ainda não foi lido: tamanho (comprimido) pelo cabeçalho
+            size_t request_bytes = request_length(req);
+            static AccessLog access_log("POST /numeros");
+            AccessLog::Scope access(access_log, res.status, request_bytes);
+            static alloc_tracking::Endpoint allocations("/numeros");
+            alloc_tracking::Scope allocation_scope(allocations);
+
+            // Contexto de trace recebido do mestre
+            tracing::Context trace = tracing::accept(req.get_header_value(tracing::REQUEST_ID_HEADER),
+                                                     req.get_header_value(tracing::SAMPLED_HEADER));
+            res.set_header(tracing::REQUEST_ID_HEADER, trace.request_id);
+            RequestTracker::Handle tracker(trace.request_id, "/numeros", request_bytes, res.status);
+            tracing::Span request_span(trace, "numbers");
+
+            SlaveMetrics& stats = slave_metrics();
+            stats.requests.add();
+            metrics::Gauge::Scope in_flight_scope(stats.in_flight);
+            metrics::ScopedTimer request_timer(stats.duration);
+
+            Logger::debug_f("Servidor mestre conectado ao escravo de números de %s", req.remote_addr.c_str());
+            Logger::debug_f("Requisição de contagem de números recebida");
+
+            // gzip chega já descomprimido pelo httplib; zstd é descomprimido aqui
+            compression::Encoding encoding;
+            try {
+                encoding = compression::parse(req.get_header_value("Content-Encoding"));
+            } catch (const std::invalid_argument& e) {
+                stats.errors.add();
 
-                std::string result = process_numbers_request(text);
+                json error_response;
+                error_response["success"] = false;
+                error_response["error"] = e.what();
+                error_response["count"] = 0;
 
-                auto end_time = std::chrono::high_resolution_clock::now();
-                auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+                res.status = 415;
+                res.set_content(error_response.dump(), "application/json");
+                return;
+            }
+            if (encoding == compression::Encoding::GZIP) {
+                encoding = compression::Encoding::IDENTITY;
+            }
+
+            in_flight++;
+            requests_total++;
+            struct InFlightGuard {
+                std::atomic<int>& counter;
+                ~InFlightGuard() { counter--; }
+            } in_flight_guard{in_flight};
+
+            try {
+                // ?profile=1: contadores de hardware da contagem na resposta.
+                // Eles medem só a contagem, então o texto é montado antes
+                bool profile = req.get_param_value("profile") == "1";
+                json result_json;
+                std::chrono::milliseconds duration;
+
+                if (is_plain_text(req) && !profile) {
+                    // Recepção, descompressão e contagem sobrepostas na etapa count
+                    tracker.stage("count");
+                    tracing::Span count_span(trace, "count");
+                    auto start_time = std::chrono::high_resolution_clock::now();
+
+                    int64_t number_count = 0;
+                    size_t characters = 0;
+                    {
+                        // Mesmo histograma da contagem no caminho com buffer
+                        metrics::ScopedTimer count_timer(stats.count);
+                        compression::StreamDecoder decoder(encoding, [&](const char* data, size_t length) {
+                            number_count += count_digits_in(data, length);
+                            characters += length;
+                        });
+                        // Bytes contados à medida que chegam: em corpo chunked o
+                        // Content-Length é 0 (gzip já vem descomprimido pelo httplib)
+                        if (!content_reader([&decoder, &stats](const char* data, size_t length) {
+                                stats.bytes.add(length);
+                                decoder.write(data, length);
+                                return true;
+                            })) {
+                            throw std::runtime_error("Falha ao receber o corpo da requisição");
+                        }
+                        decoder.finish();
+                    }
+                    // O corpo termina de chegar junto com a contagem
+                    if (request_headers_us) {
+                        uint64_t received_us = tracing::now_us();
+                        tracing::record(trace, "receive", request_headers_us, received_us);
+                        tracker.add_timing("receive", std::chrono::microseconds(received_us - request_headers_us));
+                    }
+                    count_span.end();
+                    stats.characters.add(characters);
+
+                    auto end_time = std::chrono::high_resolution_clock::now();
+                    duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+
+                    result_json["success"] = true;
+                    result_json["count"] = number_count;
+                    result_json["service"] = "numbers";
+                    result_json["processed_characters"] = characters;
+                } else {
+                    std::string body;
+                    compression::StreamDecoder decoder(encoding, [&body](const char* data, size_t length) {
+                        body.append(data, length);
+                    });
+                    if (!content_reader([&decoder, &stats](const char* data, size_t length) {
+                            stats.bytes.add(length);
+                            decoder.write(data, length);
+                            return true;
+                        })) {
+                        throw std::runtime_error("Falha ao receber o corpo da requisição");
+                    }
+                    decoder.finish();
+                    if (request_headers_us) {
+                        uint64_t received_us = tracing::now_us();
+                        tracing::record(trace, "receive", request_headers_us, received_us);
+                        tracker.add_timing("receive", std::chrono::microseconds(received_us - request_headers_us));
+                    }
+
+                    tracker.stage("parse");
+                    auto parse_start = std::chrono::steady_clock::now();
+                    std::string text;
+                    if (is_plain_text(req)) {
+                        text = std::move(body);
+                    } else {
+                        json request_json = json::parse(body);
+                        text = request_json["text"];
+                    }
+                    auto parse_end = std::chrono::steady_clock::now();
+                    stats.parse.observe(parse_end - parse_start);
+                    tracing::record(trace, "parse", tracing::to_us(parse_start), tracing::to_us(parse_end));
+                    stats.characters.add(text.size());
+
+                    Logger::debug_f("Processando texto de %zu caracteres para números", text.length());
+
+                    auto start_time = std::chrono::high_resolution_clock::now();
+
+                    tracker.stage("count");
+                    tracing::Span count_span(trace, "count");
+                    result_json = json::parse(process_numbers_request(text, profile));
+                    count_span.end();
+
+                    auto end_time = std::chrono::high_resolution_clock::now();
+                    duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+                }
 
                 // Adicionar tempo de processamento
-                json result_json = json::parse(result);
                 result_json["processing_time_ms"] = duration.count();
 
+                tracker.stage("respond");
+                tracing::Span respond_span(trace, "respond");
                 res.set_content(result_json.dump(), "application/json");
+                respond_span.end();
                 Logger::debug_f("Contagem de números concluída em %ld ms", duration.count());
 
             } catch (const std::exception& e) {
-                Logger::error_f("Erro na contagem de números: %s", e.what());
+                LOG_RATE_LIMITED(LogLevel::ERROR, 5, "Erro na contagem de números: %s", e.what());
+                stats.errors.add();
 
                 json error_response;
                 error_response["success"] = false;
@@ -77,11 +316,19 @@ bool NumbersServer::start() {
             }
         });
 
+        // Cabeçalhos lidos; o corpo ainda não. O intervalo até o handler é a recepção do corpo
+        server.set_pre_routing_handler([](const httplib::Request&, httplib::Response&) {
+            request_headers_us = tracing::now_us();
+            return httplib::Server::HandlerResponse::Unhandled;
+        });
+
         // CORS headers
         server.set_post_routing_handler([](const httplib::Request&, httplib::Response& res) {
             res.set_header("Access-Control-Allow-Origin", "*");
             res.set_header("Access-Control-Allow-Methods", "GET, POST, OPTIONS");
-            res.set_header("Access-Control-Allow-Headers", "Content-Type");
+            res.set_header("Access-Control-Allow-Headers", "Content-Type, Content-Encoding");
+            // Codificações aceitas no corpo (o mestre escolhe a compressão por aqui)
+            res.set_header("Accept-Encoding", compression::accepted());
         });
 
         Logger::info_f("Iniciando servidor de números na porta %d", port);
@@ -118,19 +365,61 @@ bool NumbersServer::is_running() const {
     return running.load();
 }
 
-std::string NumbersServer::process_numbers_request(const std::string& text) {
+int NumbersServer::in_flight_requests() const {
+    return in_flight.load();
+}
+
+unsigned long long NumbersServer::total_requests() const {
+    return requests_total.load();
+}
+
+// Contadores da contagem e razões derivadas (ver ?profile=1)
+static json counters_json(const HardwareCounters::Reading& reading, size_t bytes) {
+    json profile;
+    profile["available"] = reading.available;
+    if (!reading.available) {
+        profile["error"] = reading.error;
+        return profile;
+    }
+
+    profile["cycles"] = reading.cycles;
+    profile["instructions"] = reading.instructions;
+    profile["branch_misses"] = reading.branch_misses;
+    profile["cache_misses"] = reading.cache_misses;
+    profile["multiplexed"] = reading.scaled;
+    profile["bytes"] = bytes;
+    if (reading.cycles > 0) {
+        profile["instructions_per_cycle"] = static_cast<double>(reading.instructions) / reading.cycles;
+        profile["bytes_per_cycle"] = static_cast<double>(bytes) / reading.cycles;
+    }
+    if (bytes > 0) {
+        profile["cache_misses_per_kb"] = reading.cache_misses * 1024.0 / bytes;
+    }
+    return profile;
+}
+
+std::string NumbersServer::process_numbers_request(const std::string& text, bool profile) {
     json result;
 
     try {
-        int number_count = count_numbers(text);
+        // Os contadores só são abertos quando pedidos
+        std::unique_ptr<HardwareCounters> counters;
+        if (profile) {
+            counters.reset(new HardwareCounters());
+            counters->start();
+        }
+        int64_t number_count = count_numbers(text);
+        if (profile) {
+            result["profile"] = counters_json(counters->stop(), text.size());
+        }
 
         result["success"] = true;
         result["count"] = number_count;
         result["service"] = "numbers";
         result["processed_characters"] = text.length();
 
-        Logger::info_f("Contagem de números concluída: %d números em %zu caracteres",
-                      number_count, text.length());
+        Logger::debug_f("Contagem de números concluída: %lld números em %zu caracteres",
+                       static_cast<long long>(number_count), text.length());
 
     } catch (const std::exception& e) {
         result["success"] = false;
@@ -143,20 +432,10 @@ std::string NumbersServer::process_numbers_request(const std::string& text) {
     return result.dump();
 }
 
-int NumbersServer::count_numbers(const std::string& text) {
-    int count = 0;
-
-    for (char c : text) {
-        if (is_number(c)) {
-            count++;
-        }
-    }
+int64_t NumbersServer::count_numbers(const std::string& text) {
+    metrics::ScopedTimer count_timer(slave_metrics().count);
+    int64_t count = count_digits_in(text.data(), text.size());
 
-    Logger::debug_f("Contados %d números no texto", count);
+    Logger::debug_f("Contados %lld números no texto", static_cast<long long>(count));
     return count;
-}
-
-bool NumbersServer::is_number(char c) {
-    // Considera dígitos ASCII (0-9)
-    return std::isdigit(static_cast<unsigned char>(c));
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <atomic>
 
@@ -9,6 +10,10 @@ private:
     int port;
     std::atomic<bool> running;
 
+    // Carga atual (reportada ao mestre nos heartbeats)
+    std::atomic<int> in_flight;
+    std::atomic<unsigned long long> requests_total;
+
 public:
     explicit NumbersServer(int server_port);
     ~NumbersServer();
@@ -17,12 +22,12 @@ public:
     bool start();
     void stop();
     bool is_running() const;
+    int in_flight_requests() const;
+    unsigned long long total_requests() const;
 
     // Processamento específico
-    int count_numbers(const std::string& text);
-
-private:
-    // Métodos auxiliares
-    std::string process_numbers_request(const std::string& text);
-    bool is_number(char c);
+    // JSON de resposta do endpoint (também chamado direto pelo binário embutido);
+    // profile: inclui os contadores de hardware da contagem no resultado
+    std::string process_numbers_request(const std::string& text, bool profile);
+    int64_t count_numbers(const std::string& text);
 };
\ No newline at end of file
@@ -0,0 +1,153 @@
+#include "pull_worker.h"
+#include "logger.h"
+#include "metrics.h"
+#include "tracing.h"
+#include "text_counter.h"
+#include <httplib.h>
+#include <nlohmann/json.hpp>
+#include <chrono>
+
+using json = nlohmann::json;
+
+// Espera do long poll (o mestre limita ao seu próprio máximo)
+static constexpr int POLL_WAIT_MS = 10000;
+
+// Tarefas executadas por tipo e duração da contagem de cada fatia
+static metrics::Counter& task_counter(const std::string& type) {
+    static metrics::Counter& letters = metrics::registry().counter(
+        "worker_tasks_total", "Fatias contadas no modo pull", "type=\"letters\"");
+    static metrics::Counter& numbers = metrics::registry().counter(
+        "worker_tasks_total", "Fatias contadas no modo pull", "type=\"numbers\"");
+    return type == "letters" ? letters : numbers;
+}
+
+static metrics::Histogram& task_histogram() {
+    static metrics::Histogram& histogram = metrics::registry().histogram(
+        "stage_duration_seconds", "Duração de cada etapa da requisição", "stage=\"worker_count\"");
+    return histogram;
+}
+
+PullWorker::PullWorker(const std::string& master_url, const std::string& name,
+                       const std::string& preferred_type, int threads)
+    : master_url(master_url), name(name), preferred_type(preferred_type),
+      thread_count(threads > 0 ? threads : 1), running(false), completed(0) {}
+
+PullWorker::~PullWorker() {
+    stop();
+}
+
+void PullWorker::start() {
+    if (running.exchange(true)) {
+        return;
+    }
+
+    Logger::info_f("Modo worker ativo: %d threads buscando tarefas em %s (preferência: %s)",
+                  thread_count, master_url.c_str(), preferred_type.c_str());
+
+    // Clientes criados antes das threads para que stop() alcance todos
+    for (int i = 0; i < thread_count; i++) {
+        auto client = std::make_unique<httplib::Client>(master_url);
+        client->set_connection_timeout(3, 0);
+        client->set_read_timeout(POLL_WAIT_MS / 1000 + 5, 0);
+        client->set_keep_alive(true);
+        clients.push_back(std::move(client));
+    }
+
+    for (int i = 0; i < thread_count; i++) {
+        threads.emplace_back(&PullWorker::run, this, i);
+    }
+}
+
+void PullWorker::stop() {
+    if (!running.exchange(false)) {
+        return;
+    }
+
+    // Interromper long polls em andamento
+    for (auto& client : clients) {
+        client->stop();
+    }
+
+    for (auto& thread : threads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+    threads.clear();
+    clients.clear();
+
+    Logger::info_f("Modo worker encerrado após %llu tarefas", completed.load());
+}
+
+unsigned long long PullWorker::tasks_done() const {
+    return completed.load();
+}
+
+void PullWorker::run(int index) {
+    httplib::Client* client = clients[index].get();
+    std::string worker_id = name + "-" + std::to_string(index);
+    std::string poll_path = "/work/poll?worker=" + worker_id + "&prefer=" + preferred_type +
+                            "&wait_ms=" + std::to_string(POLL_WAIT_MS);
+
+    while (running.load()) {
+        auto response = client->Get(poll_path);
+
+        if (!response) {
+            // Mestre indisponível: aguardar antes de tentar de novo
+            if (running.load()) {
+                std::this_thread::sleep_for(std::chrono::seconds(1));
+            }
+            continue;
+        }
+
+        if (response->status == 204) {
+            continue;
+        }
+
+        if (response->status != 200) {
+            LOG_RATE_LIMITED(LogLevel::WARNING, 0.2, "Poll de tarefas retornou status %d", response->status);
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+            continue;
+        }
+
+        json result;
+        std::string type = response->get_header_value("X-Task-Type");
+        const std::string& data = response->body;
+
+        try {
+            result["task_id"] = std::stoull(response->get_header_value("X-Task-Id"));
+        } catch (const std::exception&) {
+            Logger::warning("Tarefa sem X-Task-Id válido, ignorando");
+            continue;
+        }
+
+        tracing::Context trace = tracing::accept(response->get_header_value(tracing::REQUEST_ID_HEADER),
+                                                 response->get_header_value(tracing::SAMPLED_HEADER));
+        tracing::Span task_span(trace, "worker_count");
+        auto count_start = std::chrono::steady_clock::now();
+        if (type == "letters") {
+            result["success"] = true;
+            result["count"] = count_letters_in(data.data(), data.size());
+        } else if (type == "numbers") {
+            result["success"] = true;
+            result["count"] = count_digits_in(data.data(), data.size());
+        } else {
+            result["success"] = false;
+            result["count"] = 0;
+            result["error"] = "tipo de tarefa desconhecido: " + type;
+        }
+        if (result["success"]) {
+            task_histogram().observe(std::chrono::steady_clock::now() - count_start);
+            task_counter(type).add();
+        }
+        task_span.end();
+
+        Logger::debug_f("Tarefa %s (%s, %zu bytes) concluída",
+                       response->get_header_value("X-Task-Id").c_str(), type.c_str(), data.size());
+
+        auto ack = client->Post("/work/result", result.dump(), "application/json");
+        if (ack && ack->status == 200) {
+            completed++;
+        }
+    }
+}
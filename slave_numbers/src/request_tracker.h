@@ -0,0 +1,94 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Requisições em andamento e as mais lentas dos últimos minutos, para
+// /debug/requests. Cada requisição informa a etapa atual e os escravos
+// chamados; ao terminar, entra no ranking das lentas se superar a mais
+// rápida dele (verificação sem lock no caso comum).
+class RequestTracker {
+private:
+    struct Entry {
+        uint64_t id;
+        std::string request_id;
+        const char* route;
+        size_t bytes;
+        std::chrono::steady_clock::time_point start;
+
+        mutable std::mutex mutex;
+        const char* stage = "start";
+        std::chrono::steady_clock::time_point stage_start;
+        std::vector<std::pair<const char*, uint64_t>> stages;  // nome, duração em us
+        std::vector<std::string> targets;
+        int status = 0;
+    };
+
+public:
+    // Acompanha uma requisição do início ao fim do escopo
+    class Handle {
+    public:
+        // status é lido no fim (ex.: res.status do httplib, -1 = 200)
+        Handle(const std::string& request_id, const char* route, size_t bytes, const int& status);
+        ~Handle();
+
+        Handle(const Handle&) = delete;
+        Handle& operator=(const Handle&) = delete;
+
+        // Fecha a etapa atual e inicia outra (nomes devem ser literais)
+        void stage(const char* name);
+
+        // Etapas medidas fora da sequência principal (ex.: chamadas paralelas)
+        void add_timing(const char* name, std::chrono::steady_clock::duration elapsed);
+
+        void add_target(const std::string& target);
+
+    private:
+        std::shared_ptr<Entry> entry;
+        const int& status;
+    };
+
+    static RequestTracker& instance();
+
+    // JSON com "in_flight" e "slowest"
+    std::string render() const;
+
+private:
+    static constexpr size_t SHARDS = 16;
+    static constexpr size_t SLOWEST_CAPACITY = 32;
+    static constexpr std::chrono::minutes SLOWEST_WINDOW{5};
+
+    struct alignas(64) Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<uint64_t, std::shared_ptr<Entry>> entries;
+    };
+
+    struct Finished {
+        std::shared_ptr<Entry> entry;
+        uint64_t total_us;
+        std::chrono::steady_clock::time_point finished_at;
+    };
+
+    std::atomic<uint64_t> next_id{1};
+    std::array<Shard, SHARDS> shards;
+
+    mutable std::mutex slowest_mutex;
+    std::vector<Finished> slowest;
+
+    // Atalho sem lock: com o ranking cheio, requisições abaixo deste tempo
+    // não entram até a entrada mais antiga expirar
+    std::atomic<uint64_t> slowest_threshold_us{0};
+    std::atomic<std::chrono::steady_clock::rep> slowest_expiry{0};
+
+    std::shared_ptr<Entry> begin(const std::string& request_id, const char* route, size_t bytes);
+    void finish(const std::shared_ptr<Entry>& entry);
+    void update_threshold_locked();
+};
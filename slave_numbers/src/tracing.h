@@ -0,0 +1,65 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Rastreamento distribuído de requisições.
+//
+// O mestre gera (ou aceita do cliente) um X-Request-Id e decide a amostragem;
+// ambos seguem para os escravos nos cabeçalhos. Cada etapa registra um span
+// com timestamps monotônicos em microssegundos, gravado como evento "X" do
+// formato Chrome trace em TRACE_FILE. O arquivo abre com "[" e tem um evento
+// por linha, como o Perfetto e o chrome://tracing aceitam sem o "]" final.
+// Serviços no mesmo host compartilham o relógio monotônico, então os spans
+// do mestre e dos escravos se alinham numa mesma linha do tempo.
+namespace tracing {
+
+constexpr const char* REQUEST_ID_HEADER = "X-Request-Id";
+constexpr const char* SAMPLED_HEADER = "X-Trace-Sampled";
+
+// Identificação de uma requisição ao longo dos serviços
+struct Context {
+    std::string request_id;
+    bool sampled = false;
+};
+
+// Lê TRACE_FILE e TRACE_SAMPLE_RATE (0 a 1, padrão 0.01). Sem TRACE_FILE,
+// nenhum span é gravado, mas os IDs continuam sendo propagados
+void configure(const std::string& process_name);
+
+bool enabled();
+
+// Novo ID aleatório (16 dígitos hexadecimais)
+std::string new_request_id();
+
+// Contexto a partir dos cabeçalhos recebidos (vazios se ausentes). Sem ID,
+// gera um; sem decisão de amostragem, sorteia com a taxa configurada
+Context accept(const std::string& request_id, const std::string& sampled);
+
+// Relógio monotônico em microssegundos
+uint64_t now_us();
+uint64_t to_us(std::chrono::steady_clock::time_point point);
+
+// Grava um span completo (não faz nada se o contexto não foi amostrado)
+void record(const Context& context, const char* name, uint64_t start_us, uint64_t end_us);
+
+// Span que termina no fim do escopo ou em end()
+class Span {
+public:
+    Span(const Context& context, const char* name);
+    ~Span();
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+    void end();
+
+private:
+    const Context& context;
+    const char* name;
+    uint64_t start_us;
+    bool open;
+};
+
+} // namespace tracing
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+
+// Verificações dos testes de unidade. Uma falha mostra a expressão e a
+// linha e encerra o executável com código 1, que o CTest conta como falha
+#define CHECK(condition)                                                                     \
+    do {                                                                                     \
+        if (!(condition)) {                                                                  \
+            std::fprintf(stderr, "%s:%d: falhou: %s\n", __FILE__, __LINE__, #condition);     \
+            std::exit(1);                                                                    \
+        }                                                                                    \
+    } while (0)
+
+// A expressão precisa lançar uma exceção do tipo indicado
+#define CHECK_THROWS(expression, exception_type)                                             \
+    do {                                                                                     \
+        bool thrown = false;                                                                 \
+        try {                                                                                \
+            (void)(expression);                                                              \
+        } catch (const exception_type&) {                                                    \
+            thrown = true;                                                                   \
+        }                                                                                    \
+        if (!thrown) {                                                                       \
+            std::fprintf(stderr, "%s:%d: não lançou %s: %s\n", __FILE__, __LINE__,           \
+                         #exception_type, #expression);                                      \
+            std::exit(1);                                                                    \
+        }                                                                                    \
+    } while (0)
+
+// Cada teste é uma função; o nome aparece na saída do CTest
+#define RUN(test)                                                                            \
+    do {                                                                                     \
+        std::printf("%s\n", #test);                                                          \
+        test();                                                                              \
+    } while (0)
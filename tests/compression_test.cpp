@@ -0,0 +1,119 @@
+// Compressão do corpo: gzip de 4 GiB ou mais e zstd em streaming
+
+#include "check.h"
+#include "compression.h"
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#ifdef CPPHTTPLIB_ZLIB_SUPPORT
+#include <zlib.h>
+#endif
+
+#ifdef CPPHTTPLIB_ZLIB_SUPPORT
+// Descomprime em streaming e confere que saíram length bytes zerados
+static void check_gzip_zeros(const std::string& compressed, uint64_t length) {
+    z_stream stream{};
+    CHECK(inflateInit2(&stream, 15 + 16) == Z_OK);
+
+    std::string buffer(1 << 20, '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(compressed.data()));
+    stream.avail_in = static_cast<uInt>(compressed.size());
+    uint64_t total = 0;
+    bool zeros = true;
+    int result = Z_OK;
+    while (result == Z_OK) {
+        stream.next_out = reinterpret_cast<Bytef*>(&buffer[0]);
+        stream.avail_out = static_cast<uInt>(buffer.size());
+        result = inflate(&stream, Z_NO_FLUSH);
+        size_t produced = buffer.size() - stream.avail_out;
+        zeros = zeros && buffer.find_first_not_of('\0', 0) >= produced;
+        total += produced;
+    }
+    inflateEnd(&stream);
+
+    CHECK(result == Z_STREAM_END);
+    CHECK(zeros);
+    CHECK(total == length);
+}
+
+// Texto acima de UINT_MAX: a entrada vai em partes e nada é truncado. As
+// páginas anônimas não tocadas são a página zero, sem ocupar 4 GiB de RAM
+static void gzip_above_4gib() {
+    const uint64_t length = (1ull << 32) + 12345;
+    void* data = mmap(nullptr, length, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    CHECK(data != MAP_FAILED);
+
+    std::string compressed = compression::compress(compression::Encoding::GZIP,
+                                                   static_cast<const char*>(data), length);
+    munmap(data, length);
+
+    CHECK(!compressed.empty());
+    check_gzip_zeros(compressed, length);
+}
+
+static void gzip_small_round_trip() {
+    std::string text = "abc 123 ";
+    std::string compressed = compression::compress(compression::Encoding::GZIP, text.data(), text.size());
+    CHECK(compressed.size() > 2);
+    CHECK(static_cast<unsigned char>(compressed[0]) == 0x1f);
+    CHECK(static_cast<unsigned char>(compressed[1]) == 0x8b);
+}
+#endif
+
+#ifdef HAVE_ZSTD
+// O decodificador entrega o texto em pedaços, com a entrada picada em
+// partes de qualquer tamanho
+static void zstd_stream_round_trip() {
+    std::string text;
+    for (int i = 0; i < 200000; i++) {
+        text += "linha " + std::to_string(i) + "\n";
+    }
+    std::string compressed = compression::compress(compression::Encoding::ZSTD, text.data(), text.size());
+
+    std::string output;
+    compression::StreamDecoder decoder(compression::Encoding::ZSTD, [&output](const char* data, size_t length) {
+        output.append(data, length);
+    });
+    for (size_t offset = 0; offset < compressed.size(); offset += 777) {
+        decoder.write(compressed.data() + offset, std::min<size_t>(777, compressed.size() - offset));
+    }
+    decoder.finish();
+    CHECK(output == text);
+}
+
+// Quadro incompleto é erro no finish()
+static void zstd_truncated_frame() {
+    std::string text(100000, 'x');
+    std::string compressed = compression::compress(compression::Encoding::ZSTD, text.data(), text.size());
+
+    compression::StreamDecoder decoder(compression::Encoding::ZSTD, [](const char*, size_t) {});
+    decoder.write(compressed.data(), compressed.size() / 2);
+    CHECK_THROWS(decoder.finish(), std::runtime_error);
+}
+#endif
+
+static void identity_passthrough() {
+    std::string output;
+    compression::StreamDecoder decoder(compression::Encoding::IDENTITY, [&output](const char* data, size_t length) {
+        output.append(data, length);
+    });
+    decoder.write("abc", 3);
+    decoder.finish();
+    CHECK(output == "abc");
+    CHECK_THROWS(compression::parse("br"), std::invalid_argument);
+}
+
+int main() {
+    RUN(identity_passthrough);
+#ifdef CPPHTTPLIB_ZLIB_SUPPORT
+    RUN(gzip_small_round_trip);
+    RUN(gzip_above_4gib);
+#endif
+#ifdef HAVE_ZSTD
+    RUN(zstd_stream_round_trip);
+    RUN(zstd_truncated_frame);
+#endif
+    return 0;
+}
@@ -0,0 +1,82 @@
+// Histograma log-linear: limites dos buckets e soma das fatias
+
+#include "check.h"
+#include "metrics.h"
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using metrics::Histogram;
+
+// Cada valor cai no bucket cujo limite superior é o menor que o contém
+static void value_within_bucket_bounds() {
+    for (uint64_t value = 0; value <= 1u << 20; value++) {
+        int bucket = Histogram::bucket_for(value);
+        CHECK(bucket >= 0 && bucket < Histogram::BUCKETS);
+        CHECK(value <= Histogram::bucket_upper_us(bucket));
+        if (bucket > 0) {
+            CHECK(value > Histogram::bucket_upper_us(bucket - 1));
+        }
+    }
+}
+
+// Limites crescentes, com largura de no máximo 25% do limite inferior
+static void bucket_widths() {
+    CHECK(Histogram::bucket_for(0) == 0);
+    CHECK(Histogram::bucket_for(1) == 0);
+    CHECK(Histogram::bucket_upper_us(0) == 1);
+
+    for (int bucket = 1; bucket < Histogram::BUCKETS; bucket++) {
+        uint64_t lower = Histogram::bucket_upper_us(bucket - 1);
+        uint64_t upper = Histogram::bucket_upper_us(bucket);
+        CHECK(upper > lower);
+        if (lower >= static_cast<uint64_t>(Histogram::SUB_BUCKETS)) {
+            CHECK((upper - lower) * 4 <= lower);
+        }
+    }
+}
+
+// Valores além do último limite ficam no último bucket
+static void overflow_goes_to_last_bucket() {
+    CHECK(Histogram::bucket_for(UINT64_MAX) == Histogram::BUCKETS - 1);
+    uint64_t last = Histogram::bucket_upper_us(Histogram::BUCKETS - 1);
+    CHECK(Histogram::bucket_for(last * 2) == Histogram::BUCKETS - 1);
+}
+
+// Registros de várias threads (fatias diferentes) somam no snapshot
+static void snapshot_sums_shards() {
+    Histogram histogram;
+    const int threads = 8;
+    const int per_thread = 10000;
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&histogram]() {
+            for (int i = 0; i < per_thread; i++) {
+                histogram.observe_us(100);
+            }
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    histogram.observe(std::chrono::milliseconds(2));
+
+    Histogram::Snapshot snapshot = histogram.snapshot();
+    uint64_t total = 0;
+    for (uint64_t count : snapshot.buckets) {
+        total += count;
+    }
+    CHECK(total == threads * per_thread + 1);
+    CHECK(snapshot.buckets[Histogram::bucket_for(100)] == threads * per_thread);
+    CHECK(snapshot.buckets[Histogram::bucket_for(2000)] == 1);
+    CHECK(snapshot.sum_us == static_cast<uint64_t>(threads) * per_thread * 100 + 2000);
+}
+
+int main() {
+    RUN(value_within_bucket_bounds);
+    RUN(bucket_widths);
+    RUN(overflow_goes_to_last_bucket);
+    RUN(snapshot_sums_shards);
+    return 0;
+}
@@ -0,0 +1,109 @@
+// Escalonador WFQ: ordem de despacho pelas marcas de término virtual
+
+#include "check.h"
+#include "request_scheduler.h"
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+// Espera até a fila da classe ter count requisições
+static void wait_queued(const RequestScheduler& scheduler, PriorityClass cls, size_t count) {
+    while (scheduler.queued(cls) != count) {
+        std::this_thread::sleep_for(1ms);
+    }
+}
+
+// Com a única vaga ocupada, um lote grande entra na fila antes de uma
+// requisição interativa pequena; ao liberar, a interativa passa na frente
+static void small_interactive_overtakes_batch() {
+    RequestScheduler scheduler(1);
+    RequestScheduler::Slot held = scheduler.acquire(PriorityClass::NORMAL, 0, 1s);
+    CHECK(held);
+
+    std::mutex order_mutex;
+    std::vector<std::string> order;
+    auto request = [&](PriorityClass cls, size_t bytes, const char* name) {
+        return std::thread([&, cls, bytes, name]() {
+            RequestScheduler::Slot slot = scheduler.acquire(cls, bytes, 5s);
+            CHECK(slot);
+            std::lock_guard<std::mutex> lock(order_mutex);
+            order.push_back(name);
+        });
+    };
+
+    std::thread batch = request(PriorityClass::BATCH, 1024 * 1024, "batch");
+    wait_queued(scheduler, PriorityClass::BATCH, 1);
+    std::thread interactive = request(PriorityClass::INTERACTIVE, 1024, "interactive");
+    wait_queued(scheduler, PriorityClass::INTERACTIVE, 1);
+
+    held = RequestScheduler::Slot();
+    batch.join();
+    interactive.join();
+
+    CHECK(order.size() == 2);
+    CHECK(order[0] == "interactive");
+    CHECK(order[1] == "batch");
+    CHECK(scheduler.dispatched(PriorityClass::INTERACTIVE) == 1);
+    CHECK(scheduler.dispatched(PriorityClass::BATCH) == 1);
+    CHECK(scheduler.in_use() == 0);
+}
+
+// Com fila contínua nas duas classes e custos iguais, o despacho segue os
+// pesos (interativa 8, lote 1)
+static void dispatch_follows_weights() {
+    RequestScheduler scheduler(1);
+    RequestScheduler::Slot held = scheduler.acquire(PriorityClass::NORMAL, 0, 1s);
+
+    const size_t per_class = 9;
+    std::mutex order_mutex;
+    std::vector<PriorityClass> order;
+    std::vector<std::thread> threads;
+    for (PriorityClass cls : {PriorityClass::BATCH, PriorityClass::INTERACTIVE}) {
+        for (size_t i = 0; i < per_class; i++) {
+            threads.emplace_back([&, cls]() {
+                RequestScheduler::Slot slot = scheduler.acquire(cls, 4096, 5s);
+                CHECK(slot);
+                std::lock_guard<std::mutex> lock(order_mutex);
+                order.push_back(cls);
+            });
+            wait_queued(scheduler, cls, i + 1);
+        }
+    }
+
+    held = RequestScheduler::Slot();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    // Nas 9 primeiras vagas, 8 interativas para 1 lote
+    size_t batch_first = 0;
+    for (size_t i = 0; i < per_class; i++) {
+        batch_first += order[i] == PriorityClass::BATCH;
+    }
+    CHECK(order.size() == 2 * per_class);
+    CHECK(batch_first == 1);
+}
+
+// Quem desiste por timeout sai da fila sem ocupar vaga
+static void timeout_leaves_queue() {
+    RequestScheduler scheduler(1);
+    RequestScheduler::Slot held = scheduler.acquire(PriorityClass::NORMAL, 0, 1s);
+
+    RequestScheduler::Slot late = scheduler.acquire(PriorityClass::BATCH, 1024, 10ms);
+    CHECK(!late);
+    CHECK(scheduler.queued(PriorityClass::BATCH) == 0);
+    CHECK(scheduler.in_use() == 1);
+
+    held = RequestScheduler::Slot();
+    CHECK(scheduler.in_use() == 0);
+}
+
+int main() {
+    RUN(small_interactive_overtakes_batch);
+    RUN(dispatch_follows_weights);
+    RUN(timeout_leaves_queue);
+    return 0;
+}
@@ -0,0 +1,122 @@
+// Registro RCU: leitores seguram a snapshot; a antiga só é liberada depois
+
+#include "check.h"
+#include "slave_registry.h"
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+static std::shared_ptr<SlaveInfo> make_slave(const std::string& name) {
+    return std::make_shared<SlaveInfo>(name, "localhost", 8081, "/letras", "letters", true);
+}
+
+static bool add(SlaveRegistry& registry, std::shared_ptr<SlaveInfo> slave) {
+    return registry.update([&](SlaveRegistry::Snapshot& slaves) {
+        slaves.push_back(slave);
+        return true;
+    });
+}
+
+static bool remove(SlaveRegistry& registry, const std::string& name) {
+    return registry.update([&](SlaveRegistry::Snapshot& slaves) {
+        size_t before = slaves.size();
+        slaves.erase(std::remove_if(slaves.begin(), slaves.end(),
+                                    [&](const std::shared_ptr<SlaveInfo>& s) { return s->name == name; }),
+                     slaves.end());
+        return slaves.size() != before;
+    });
+}
+
+// A snapshot lida antes de uma remoção continua intacta enquanto o leitor
+// existir; depois, uma chamada a reclaim() a libera
+static void reader_keeps_retired_snapshot() {
+    SlaveRegistry registry;
+    std::weak_ptr<SlaveInfo> removed;
+    {
+        auto slave = make_slave("letters-1");
+        removed = slave;
+        CHECK(add(registry, slave));
+        CHECK(add(registry, make_slave("letters-2")));
+    }
+
+    {
+        SlaveRegistry::ReadGuard guard = registry.read();
+        CHECK(guard.slaves().size() == 2);
+
+        CHECK(remove(registry, "letters-1"));
+        CHECK(registry.copy().size() == 1);
+
+        for (int i = 0; i < 3; i++) {
+            registry.reclaim();
+        }
+        CHECK(!removed.expired());
+        CHECK(guard.slaves().size() == 2);
+        CHECK(guard.slaves()[0]->name == "letters-1");
+    }
+
+    registry.reclaim();
+    registry.reclaim();
+    CHECK(removed.expired());
+}
+
+// Mudança recusada por mutate não publica nada
+static void rejected_update_keeps_snapshot() {
+    SlaveRegistry registry;
+    CHECK(add(registry, make_slave("numbers-1")));
+    CHECK(!remove(registry, "inexistente"));
+    CHECK(registry.copy().size() == 1);
+}
+
+// Leitores contínuos em outras threads nunca veem uma lista incoerente, e
+// as snapshots aposentadas são liberadas mesmo sem pausa nas leituras
+static void concurrent_readers() {
+    SlaveRegistry registry;
+    std::atomic<bool> stop{false};
+    std::atomic<bool> inconsistent{false};
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; i++) {
+        readers.emplace_back([&]() {
+            while (!stop.load()) {
+                SlaveRegistry::ReadGuard guard = registry.read();
+                for (const auto& slave : guard.slaves()) {
+                    if (slave->port != 8081 || slave->name.empty()) {
+                        inconsistent = true;
+                    }
+                }
+            }
+        });
+    }
+
+    std::vector<std::weak_ptr<SlaveInfo>> history;
+    for (int i = 0; i < 200; i++) {
+        auto slave = make_slave("letters-" + std::to_string(i));
+        history.push_back(slave);
+        CHECK(add(registry, slave));
+        if (i > 0) {
+            CHECK(remove(registry, "letters-" + std::to_string(i - 1)));
+        }
+    }
+
+    stop = true;
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+    registry.reclaim();
+    registry.reclaim();
+
+    CHECK(!inconsistent.load());
+    for (size_t i = 0; i + 1 < history.size(); i++) {
+        CHECK(history[i].expired());
+    }
+    CHECK(registry.copy().size() == 1);
+}
+
+int main() {
+    RUN(reader_keeps_retired_snapshot);
+    RUN(rejected_update_keeps_snapshot);
+    RUN(concurrent_readers);
+    return 0;
+}
@@ -0,0 +1,122 @@
+// Sessões de upload: recuperação do estado em disco após um reinício
+
+#include "check.h"
+#include "upload_sessions.h"
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <unistd.h>
+
+using namespace std::chrono_literals;
+
+static constexpr uint64_t CHUNK_SIZE = 256 * 1024;
+
+// Diretório de estado novo para cada teste
+static std::string state_dir() {
+    char path[] = "/tmp/upload_sessions_test.XXXXXX";
+    CHECK(mkdtemp(path) != nullptr);
+    return path;
+}
+
+// Um mestre novo no mesmo diretório retoma somas e blocos que faltam
+static void state_survives_restart() {
+    std::string dir = state_dir();
+    std::string id;
+    {
+        UploadSessions sessions;
+        CHECK(sessions.set_state_dir(dir));
+        uint64_t chunk_size = CHUNK_SIZE;
+        uint32_t chunks = 0;
+        id = sessions.create(3 * CHUNK_SIZE + 10, chunk_size, chunks);
+        CHECK(chunks == 4);
+        CHECK(sessions.complete_chunk(id, 0, 0x11, 100, 5));
+        CHECK(sessions.complete_chunk(id, 2, 0x33, 50, 7));
+    }
+
+    UploadSessions restarted;
+    CHECK(restarted.set_state_dir(dir));
+    CHECK(restarted.active() == 1);
+
+    std::vector<uint32_t> missing;
+    UploadSessions::Summary summary = restarted.status(id, &missing);
+    CHECK(summary.chunks == 4);
+    CHECK(summary.received == 2);
+    CHECK(summary.letters == 150);
+    CHECK(summary.numbers == 12);
+    CHECK((missing == std::vector<uint32_t>{1, 3}));
+    CHECK(restarted.chunk_length(id, 3) == 10);
+
+    // O hash gravado reconhece o reenvio e recusa conteúdo diferente
+    CHECK(restarted.counted(id, 0, 0x11));
+    CHECK(!restarted.complete_chunk(id, 0, 0x11, 100, 5));
+    CHECK_THROWS(restarted.complete_chunk(id, 2, 0x99, 50, 7), std::invalid_argument);
+
+    CHECK(restarted.complete_chunk(id, 1, 0x22, 1, 1));
+    CHECK(restarted.complete_chunk(id, 3, 0x44, 1, 1));
+    CHECK(restarted.finish(id, summary));
+    CHECK(summary.letters == 152);
+    CHECK(access((dir + "/" + id + ".upload").c_str(), F_OK) != 0);
+}
+
+// Sessão persistida inativa sai da memória, não do disco, e volta quando
+// o cliente a consulta; o arquivo só some depois do TTL do estado
+static void idle_session_reloads_from_disk() {
+    std::string dir = state_dir();
+    UploadSessions sessions;
+    CHECK(sessions.set_state_dir(dir));
+    uint64_t chunk_size = CHUNK_SIZE;
+    uint32_t chunks = 0;
+    std::string id = sessions.create(2 * CHUNK_SIZE, chunk_size, chunks);
+    CHECK(sessions.complete_chunk(id, 1, 0x22, 9, 9));
+
+    CHECK(sessions.expire(0s, 24h) == 0);
+    CHECK(sessions.active() == 0);
+    CHECK(sessions.status(id).received == 1);
+    CHECK(sessions.active() == 1);
+
+    // A varredura do disco roda no máximo a cada poucos minutos: um mestre
+    // novo faz a primeira
+    UploadSessions restarted;
+    CHECK(restarted.set_state_dir(dir));
+    CHECK(restarted.expire(-1s, -1s) == 1);
+    CHECK_THROWS(restarted.status(id), std::out_of_range);
+}
+
+// Cabeçalho com tamanho de bloco fora dos limites de create() é ignorado
+static void invalid_header_is_ignored() {
+    std::string dir = state_dir();
+    std::string id;
+    {
+        UploadSessions sessions;
+        CHECK(sessions.set_state_dir(dir));
+        uint64_t chunk_size = CHUNK_SIZE;
+        uint32_t chunks = 0;
+        id = sessions.create(CHUNK_SIZE, chunk_size, chunks);
+    }
+
+    // StateHeader: magia (8), versão (4), blocos (4), tamanho (8), bloco (8)
+    std::string path = dir + "/" + id + ".upload";
+    int fd = open(path.c_str(), O_WRONLY);
+    CHECK(fd >= 0);
+    uint64_t size = 16;
+    uint64_t chunk_size = 1;
+    uint32_t chunks = 16;
+    CHECK(pwrite(fd, &chunks, sizeof(chunks), 12) == sizeof(chunks));
+    CHECK(pwrite(fd, &size, sizeof(size), 16) == sizeof(size));
+    CHECK(pwrite(fd, &chunk_size, sizeof(chunk_size), 24) == sizeof(chunk_size));
+    close(fd);
+
+    UploadSessions restarted;
+    CHECK(restarted.set_state_dir(dir));
+    CHECK(restarted.active() == 0);
+    CHECK_THROWS(restarted.status(id), std::out_of_range);
+}
+
+int main() {
+    RUN(state_survives_restart);
+    RUN(idle_session_reloads_from_disk);
+    RUN(invalid_header_is_ignored);
+    return 0;
+}
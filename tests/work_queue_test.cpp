@@ -0,0 +1,112 @@
+// Fila do modo pull: fatias, lease, devolução à fila e resultado atrasado
+
+#include "check.h"
+#include "work_queue.h"
+#include <string>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+static WorkResult counted(long long count) {
+    WorkResult result;
+    result.success = true;
+    result.count = count;
+    return result;
+}
+
+// O texto vira fatias de até shard_size bytes, entregues em ordem
+static void shards_and_sum() {
+    WorkQueue queue;
+    std::string text(10, 'a');
+    WorkQueue::Batch batch = queue.submit("letters", text.data(), text.size(), 4, tracing::Context());
+    CHECK(batch.task_ids.size() == 3);
+
+    size_t lengths[] = {4, 4, 2};
+    for (size_t length : lengths) {
+        WorkQueue::Lease lease;
+        CHECK(queue.poll("w1", "letters", 0ms, lease));
+        CHECK(lease.data.size() == length);
+        CHECK(queue.complete(lease.task_id, counted(static_cast<long long>(length))));
+    }
+
+    WorkResult total = queue.wait(batch, std::chrono::steady_clock::now() + 1s);
+    CHECK(total.success);
+    CHECK(total.count == 10);
+    CHECK(queue.stats(1s).completed == 3);
+}
+
+// Lease expirado volta à fila; o resultado do worker original, que chega
+// antes de outro pegar a tarefa, ainda vale e tira a tarefa da fila
+static void late_result_after_requeue() {
+    WorkQueue queue(20ms);
+    std::string text = "abc";
+    WorkQueue::Batch batch = queue.submit("letters", text.data(), text.size(), 16, tracing::Context());
+
+    WorkQueue::Lease lease;
+    CHECK(queue.poll("lento", "letters", 0ms, lease));
+    std::this_thread::sleep_for(40ms);
+    queue.requeue_expired();
+
+    WorkQueue::Stats stats = queue.stats(1s);
+    CHECK(stats.requeued == 1);
+    CHECK(stats.pending["letters"] == 1);
+    CHECK(stats.leased == 0);
+
+    CHECK(queue.complete(lease.task_id, counted(3)));
+    CHECK(queue.stats(1s).pending["letters"] == 0);
+
+    // Entregue uma vez só: ninguém mais recebe a tarefa
+    WorkQueue::Lease other;
+    CHECK(!queue.poll("outro", "letters", 10ms, other));
+
+    WorkResult total = queue.wait(batch, std::chrono::steady_clock::now() + 1s);
+    CHECK(total.success);
+    CHECK(total.count == 3);
+    CHECK(!queue.complete(lease.task_id, counted(3)));
+}
+
+// Depois de esgotar as tentativas a fatia falha, e o lote também
+static void attempts_exhausted() {
+    WorkQueue queue(10ms);
+    std::string text = "abc";
+    WorkQueue::Batch batch = queue.submit("letters", text.data(), text.size(), 16, tracing::Context());
+
+    for (int attempt = 0; attempt < 3; attempt++) {
+        WorkQueue::Lease lease;
+        CHECK(queue.poll("w1", "letters", 100ms, lease));
+        std::this_thread::sleep_for(20ms);
+        queue.requeue_expired();
+    }
+
+    WorkResult total = queue.wait(batch, std::chrono::steady_clock::now() + 1s);
+    CHECK(!total.success);
+    CHECK(!total.error.empty());
+}
+
+// Worker sem tarefas do seu tipo rouba da fila mais cheia
+static void work_stealing() {
+    WorkQueue queue;
+    std::string text(8, '1');
+    WorkQueue::Batch batch = queue.submit("numbers", text.data(), text.size(), 4, tracing::Context());
+
+    WorkQueue::Lease lease;
+    CHECK(queue.poll("w1", "letters", 0ms, lease));
+    CHECK(lease.type == "numbers");
+    CHECK(queue.stats(1s).stolen == 1);
+    CHECK(queue.complete(lease.task_id, counted(4)));
+
+    // Sem tipo preferido não conta como roubo
+    CHECK(queue.poll("w2", "", 0ms, lease));
+    CHECK(queue.stats(1s).stolen == 1);
+    CHECK(queue.complete(lease.task_id, counted(4)));
+
+    CHECK(queue.wait(batch, std::chrono::steady_clock::now() + 1s).count == 8);
+}
+
+int main() {
+    RUN(shards_and_sum);
+    RUN(late_result_after_requeue);
+    RUN(attempts_exhausted);
+    RUN(work_stealing);
+    return 0;
+}
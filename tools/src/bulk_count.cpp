@@ -0,0 +1,530 @@
+// Contagem em lote de arquivos locais, com os mesmos núcleos dos escravos.
+//
+// Percorre os caminhos dados (diretórios recursivamente), divide cada
+// arquivo em blocos e conta letras e dígitos em todos os núcleos. Cada
+// thread tem sua fila de blocos; quando esvazia, rouba do fim da fila de
+// outra, então um arquivo grande no fim da lista não deixa as demais
+// paradas. Os blocos são lidos com mmap (MADV_SEQUENTIAL) ou com pread em
+// buffers alinhados (--io read, opcionalmente com O_DIRECT).
+//
+// A saída tem uma linha por arquivo, na ordem em que terminam, e uma linha
+// de total: CSV (kind,path,bytes,letters,numbers,error) ou JSON lines.
+
+#include "text_counter.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <dirent.h>
+#include <fcntl.h>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using json = nlohmann::json;
+
+// Os dois núcleos passam por sub-blocos deste tamanho, para a segunda
+// passada ler do cache em vez da memória
+static constexpr size_t COUNT_BLOCK = 256 * 1024;
+
+// Alinhamento dos buffers de leitura (exigido por O_DIRECT)
+static constexpr size_t IO_ALIGNMENT = 4096;
+
+enum class IoMode { MMAP, READ };
+enum class Format { CSV, JSONL };
+
+struct Options {
+    std::vector<std::string> paths;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    size_t chunk = 8 * 1024 * 1024;
+    IoMode io = IoMode::MMAP;
+    bool direct = false;
+    Format format = Format::CSV;
+    std::string output;
+};
+
+static void usage() {
+    std::fprintf(stderr,
+        "Uso: bulk_count [opções] CAMINHO...\n"
+        "  --threads N        threads de contagem (padrão: uma por núcleo)\n"
+        "  --chunk-mb N       tamanho dos blocos em MB (padrão 8)\n"
+        "  --io mmap|read     leitura por mmap (padrão) ou pread em buffers alinhados\n"
+        "  --direct           com --io read, abre com O_DIRECT (sem page cache)\n"
+        "  --format csv|jsonl formato da saída (padrão csv)\n"
+        "  --output ARQUIVO   grava a saída no arquivo (padrão: stdout)\n");
+}
+
+static bool parse_options(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument(arg + " exige um valor");
+            }
+            return argv[++i];
+        };
+
+        if (arg == "--threads") {
+            options.threads = static_cast<unsigned>(std::stoul(value()));
+        } else if (arg == "--chunk-mb") {
+            options.chunk = std::stoul(value()) * 1024 * 1024;
+        } else if (arg == "--io") {
+            std::string mode = value();
+            if (mode == "mmap") {
+                options.io = IoMode::MMAP;
+            } else if (mode == "read") {
+                options.io = IoMode::READ;
+            } else {
+                throw std::invalid_argument("--io deve ser mmap ou read");
+            }
+        } else if (arg == "--direct") {
+            options.direct = true;
+        } else if (arg == "--format") {
+            std::string format = value();
+            if (format == "csv") {
+                options.format = Format::CSV;
+            } else if (format == "jsonl") {
+                options.format = Format::JSONL;
+            } else {
+                throw std::invalid_argument("--format deve ser csv ou jsonl");
+            }
+        } else if (arg == "--output") {
+            options.output = value();
+        } else if (arg == "--help" || arg == "-h") {
+            return false;
+        } else if (!arg.empty() && arg[0] == '-') {
+            throw std::invalid_argument("opção desconhecida: " + arg);
+        } else {
+            options.paths.push_back(arg);
+        }
+    }
+
+    if (options.paths.empty()) {
+        throw std::invalid_argument("informe ao menos um arquivo ou diretório");
+    }
+    if (options.threads == 0 || options.chunk == 0) {
+        throw std::invalid_argument("--threads e --chunk-mb devem ser positivos");
+    }
+    return true;
+}
+
+// Estado de um arquivo; o último bloco a terminar emite a linha dele
+struct FileEntry {
+    std::string path;
+    uint64_t size = 0;
+    std::atomic<uint64_t> letters{0};
+    std::atomic<uint64_t> numbers{0};
+    std::atomic<size_t> pending_chunks{0};
+
+    // Aberto pelo primeiro bloco lido e fechado pelo último, para não
+    // manter todos os arquivos abertos ao mesmo tempo
+    std::once_flag opened;
+    int fd = -1;
+
+    std::mutex error_mutex;
+    std::string error;
+
+    void fail(const std::string& message) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (error.empty()) {
+            error = message;
+        }
+    }
+};
+
+struct Chunk {
+    FileEntry* file;
+    uint64_t offset;
+    size_t length;
+};
+
+// Fila de uma thread: o dono consome do início, os outros roubam do fim
+struct WorkQueue {
+    std::mutex mutex;
+    std::deque<Chunk> chunks;
+};
+
+class BulkCounter {
+public:
+    BulkCounter(const Options& options, FILE* out);
+
+    void add_path(const std::string& path);
+    bool run();
+
+private:
+    void open_file(FileEntry& file);
+    void walk(const std::string& path);
+    void add_file(const std::string& path, uint64_t size);
+    bool next_chunk(size_t self, Chunk& chunk);
+    void worker(size_t self);
+    void count_chunk(const Chunk& chunk, char* buffer);
+    void finish_chunk(FileEntry& file);
+    void emit(const FileEntry& file);
+    void emit_total(double seconds);
+
+    const Options& options;
+    FILE* out;
+    int open_flags = O_RDONLY | O_CLOEXEC;
+
+    std::deque<FileEntry> files;    // endereços estáveis
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    size_t next_queue = 0;
+
+    std::mutex output_mutex;
+    uint64_t total_files = 0;
+    uint64_t total_bytes = 0;
+    uint64_t total_letters = 0;
+    uint64_t total_numbers = 0;
+    uint64_t failed_files = 0;
+};
+
+BulkCounter::BulkCounter(const Options& options, FILE* out) : options(options), out(out) {
+    for (unsigned i = 0; i < options.threads; i++) {
+        queues.emplace_back(new WorkQueue());
+    }
+#ifdef O_DIRECT
+    if (options.io == IoMode::READ && options.direct) {
+        open_flags |= O_DIRECT;
+    }
+#endif
+
+    if (options.format == Format::CSV) {
+        std::fprintf(out, "kind,path,bytes,letters,numbers,error\n");
+    }
+}
+
+void BulkCounter::add_path(const std::string& path) {
+    walk(path);
+}
+
+void BulkCounter::open_file(FileEntry& file) {
+    file.fd = open(file.path.c_str(), open_flags);
+    if (file.fd < 0 && open_flags != (O_RDONLY | O_CLOEXEC)) {
+        // Sistema de arquivos sem O_DIRECT: leitura normal
+        file.fd = open(file.path.c_str(), O_RDONLY | O_CLOEXEC);
+    }
+    if (file.fd < 0) {
+        file.fail(std::strerror(errno));
+    } else if (options.io == IoMode::READ) {
+        posix_fadvise(file.fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    }
+}
+
+void BulkCounter::walk(const std::string& path) {
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) {
+        files.emplace_back();
+        files.back().path = path;
+        files.back().error = std::strerror(errno);
+        emit(files.back());
+        return;
+    }
+
+    if (S_ISREG(info.st_mode)) {
+        add_file(path, static_cast<uint64_t>(info.st_size));
+        return;
+    }
+    if (!S_ISDIR(info.st_mode)) {
+        return;
+    }
+
+    DIR* dir = opendir(path.c_str());
+    if (!dir) {
+        std::fprintf(stderr, "Não foi possível abrir %s: %s\n", path.c_str(), std::strerror(errno));
+        return;
+    }
+
+    // Ordem estável entre execuções; links simbólicos para diretórios não
+    // são seguidos (evita ciclos)
+    std::vector<std::string> children;
+    while (dirent* entry = readdir(dir)) {
+        std::string name = entry->d_name;
+        if (name == "." || name == "..") {
+            continue;
+        }
+        std::string child = path + (path.back() == '/' ? "" : "/") + name;
+        struct stat child_info;
+        if (lstat(child.c_str(), &child_info) == 0 &&
+            (S_ISDIR(child_info.st_mode) || S_ISREG(child_info.st_mode) || S_ISLNK(child_info.st_mode))) {
+            if (S_ISLNK(child_info.st_mode) &&
+                (stat(child.c_str(), &child_info) != 0 || !S_ISREG(child_info.st_mode))) {
+                continue;
+            }
+            children.push_back(child);
+        }
+    }
+    closedir(dir);
+
+    std::sort(children.begin(), children.end());
+    for (const std::string& child : children) {
+        walk(child);
+    }
+}
+
+void BulkCounter::add_file(const std::string& path, uint64_t size) {
+    files.emplace_back();
+    FileEntry& file = files.back();
+    file.path = path;
+    file.size = size;
+
+    if (size == 0) {
+        emit(file);
+        return;
+    }
+
+    // Blocos distribuídos em rodízio entre as filas
+    size_t chunks = static_cast<size_t>((size + options.chunk - 1) / options.chunk);
+    file.pending_chunks = chunks;
+    for (size_t i = 0; i < chunks; i++) {
+        uint64_t offset = static_cast<uint64_t>(i) * options.chunk;
+        size_t length = static_cast<size_t>(std::min<uint64_t>(options.chunk, size - offset));
+        queues[next_queue]->chunks.push_back({&file, offset, length});
+        next_queue = (next_queue + 1) % queues.size();
+    }
+}
+
+bool BulkCounter::next_chunk(size_t self, Chunk& chunk) {
+    {
+        WorkQueue& own = *queues[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.chunks.empty()) {
+            chunk = own.chunks.front();
+            own.chunks.pop_front();
+            return true;
+        }
+    }
+
+    // Nada na própria fila: roubar do fim de outra. As filas só diminuem,
+    // então uma volta sem sucesso significa que o trabalho acabou
+    for (size_t i = 1; i < queues.size(); i++) {
+        WorkQueue& victim = *queues[(self + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.chunks.empty()) {
+            chunk = victim.chunks.back();
+            victim.chunks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+void BulkCounter::worker(size_t self) {
+    char* buffer = nullptr;
+    if (options.io == IoMode::READ) {
+        void* memory = nullptr;
+        if (posix_memalign(&memory, IO_ALIGNMENT, options.chunk + IO_ALIGNMENT) != 0) {
+            throw std::bad_alloc();
+        }
+        buffer = static_cast<char*>(memory);
+    }
+
+    Chunk chunk;
+    while (next_chunk(self, chunk)) {
+        count_chunk(chunk, buffer);
+        finish_chunk(*chunk.file);
+    }
+
+    std::free(buffer);
+}
+
+static void count_into(const char* data, size_t length, FileEntry& file) {
+    uint64_t letters = 0;
+    uint64_t numbers = 0;
+    for (size_t offset = 0; offset < length; offset += COUNT_BLOCK) {
+        size_t block = std::min(COUNT_BLOCK, length - offset);
+        letters += static_cast<uint64_t>(count_letters_in(data + offset, block));
+        numbers += static_cast<uint64_t>(count_digits_in(data + offset, block));
+    }
+    file.letters.fetch_add(letters, std::memory_order_relaxed);
+    file.numbers.fetch_add(numbers, std::memory_order_relaxed);
+}
+
+void BulkCounter::count_chunk(const Chunk& chunk, char* buffer) {
+    FileEntry& file = *chunk.file;
+    std::call_once(file.opened, &BulkCounter::open_file, this, std::ref(file));
+    int fd = file.fd;
+    if (fd < 0) {
+        return;
+    }
+
+    if (options.io == IoMode::MMAP) {
+        // mmap exige deslocamento alinhado à página
+        static const uint64_t page = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+        uint64_t aligned = chunk.offset - chunk.offset % page;
+        size_t lead = static_cast<size_t>(chunk.offset - aligned);
+        size_t length = chunk.length + lead;
+
+        void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, static_cast<off_t>(aligned));
+        if (mapped == MAP_FAILED) {
+            file.fail(std::string("mmap: ") + std::strerror(errno));
+            return;
+        }
+        madvise(mapped, length, MADV_SEQUENTIAL);
+        madvise(mapped, length, MADV_WILLNEED);
+        count_into(static_cast<const char*>(mapped) + lead, chunk.length, file);
+        munmap(mapped, length);
+        return;
+    }
+
+    // pread do bloco inteiro; com O_DIRECT o tamanho pedido precisa ser
+    // múltiplo do alinhamento (o fim do arquivo volta mais curto)
+    size_t request = (chunk.length + IO_ALIGNMENT - 1) / IO_ALIGNMENT * IO_ALIGNMENT;
+    size_t done = 0;
+    while (done < chunk.length) {
+        ssize_t n = pread(fd, buffer + done, request - done, static_cast<off_t>(chunk.offset + done));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            file.fail(n < 0 ? std::string("read: ") + std::strerror(errno) : "arquivo encolheu durante a leitura");
+            return;
+        }
+        done += static_cast<size_t>(n);
+    }
+    count_into(buffer, chunk.length, file);
+}
+
+void BulkCounter::finish_chunk(FileEntry& file) {
+    if (file.pending_chunks.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        if (file.fd >= 0) {
+            close(file.fd);
+            file.fd = -1;
+        }
+        emit(file);
+    }
+}
+
+static std::string csv_field(const std::string& value) {
+    if (value.find_first_of(",\"\n\r") == std::string::npos) {
+        return value;
+    }
+    std::string quoted = "\"";
+    for (char c : value) {
+        quoted += c;
+        if (c == '"') {
+            quoted += '"';
+        }
+    }
+    return quoted + "\"";
+}
+
+void BulkCounter::emit(const FileEntry& file) {
+    uint64_t letters = file.letters.load();
+    uint64_t numbers = file.numbers.load();
+
+    std::lock_guard<std::mutex> lock(output_mutex);
+    if (file.error.empty()) {
+        total_files++;
+        total_bytes += file.size;
+        total_letters += letters;
+        total_numbers += numbers;
+    } else {
+        failed_files++;
+    }
+
+    if (options.format == Format::CSV) {
+        std::fprintf(out, "file,%s,%llu,%llu,%llu,%s\n", csv_field(file.path).c_str(),
+                     static_cast<unsigned long long>(file.size), static_cast<unsigned long long>(letters),
+                     static_cast<unsigned long long>(numbers), csv_field(file.error).c_str());
+    } else {
+        json line;
+        line["path"] = file.path;
+        line["bytes"] = file.size;
+        line["letters"] = letters;
+        line["numbers"] = numbers;
+        if (!file.error.empty()) {
+            line["error"] = file.error;
+        }
+        std::fprintf(out, "%s\n", line.dump(-1, ' ', false, json::error_handler_t::replace).c_str());
+    }
+}
+
+void BulkCounter::emit_total(double seconds) {
+    double mb_s = seconds > 0 ? total_bytes / seconds / (1024.0 * 1024.0) : 0;
+
+    if (options.format == Format::CSV) {
+        std::fprintf(out, "total,,%llu,%llu,%llu,%s\n", static_cast<unsigned long long>(total_bytes),
+                     static_cast<unsigned long long>(total_letters), static_cast<unsigned long long>(total_numbers),
+                     failed_files ? (std::to_string(failed_files) + " arquivos com erro").c_str() : "");
+    } else {
+        json line;
+        line["total"] = true;
+        line["files"] = total_files;
+        line["failed_files"] = failed_files;
+        line["bytes"] = total_bytes;
+        line["letters"] = total_letters;
+        line["numbers"] = total_numbers;
+        line["seconds"] = seconds;
+        line["mb_s"] = mb_s;
+        std::fprintf(out, "%s\n", line.dump().c_str());
+    }
+
+    std::fprintf(stderr, "%llu arquivos (%llu com erro), %.2f MB em %.2f s: %.1f MB/s com %u threads\n",
+                 static_cast<unsigned long long>(total_files), static_cast<unsigned long long>(failed_files),
+                 total_bytes / (1024.0 * 1024.0), seconds, mb_s, options.threads);
+}
+
+bool BulkCounter::run() {
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < queues.size(); i++) {
+        workers.emplace_back(&BulkCounter::worker, this, i);
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    emit_total(seconds);
+    return failed_files == 0;
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    try {
+        if (!parse_options(argc, argv, options)) {
+            usage();
+            return 0;
+        }
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        usage();
+        return 2;
+    }
+
+    FILE* out = stdout;
+    if (!options.output.empty()) {
+        out = std::fopen(options.output.c_str(), "w");
+        if (!out) {
+            std::fprintf(stderr, "Não foi possível gravar %s: %s\n", options.output.c_str(), std::strerror(errno));
+            return 2;
+        }
+    }
+
+    bool ok;
+    {
+        BulkCounter counter(options, out);
+        for (const std::string& path : options.paths) {
+            counter.add_path(path);
+        }
+        ok = counter.run();
+    }
+
+    if (out != stdout) {
+        std::fclose(out);
+    }
+    return ok ? 0 : 1;
+}
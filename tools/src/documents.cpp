@@ -0,0 +1,169 @@
+#include "documents.h"
+#include "inputs.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <dirent.h>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <sys/stat.h>
+
+using json = nlohmann::json;
+
+// Entradas com arquivos: quantas sequências de envio sortear
+static constexpr size_t ORDER_LENGTH = 4096;
+
+size_t DocumentSet::parse_size(const std::string& text) {
+    char* end = nullptr;
+    double value = std::strtod(text.c_str(), &end);
+    if (end == text.c_str() || value < 0) {
+        throw std::invalid_argument("tamanho inválido: " + text);
+    }
+
+    std::string unit(end);
+    std::transform(unit.begin(), unit.end(), unit.begin(), ::toupper);
+    double scale = 1;
+    if (unit == "" || unit == "B") {
+        scale = 1;
+    } else if (unit == "K" || unit == "KB") {
+        scale = 1024.0;
+    } else if (unit == "M" || unit == "MB") {
+        scale = 1024.0 * 1024.0;
+    } else if (unit == "G" || unit == "GB") {
+        scale = 1024.0 * 1024.0 * 1024.0;
+    } else {
+        throw std::invalid_argument("unidade inválida: " + text);
+    }
+    return static_cast<size_t>(value * scale);
+}
+
+static std::vector<std::string> split(const std::string& text, char separator) {
+    std::vector<std::string> parts;
+    std::stringstream ss(text);
+    std::string part;
+    while (std::getline(ss, part, separator)) {
+        if (!part.empty()) {
+            parts.push_back(part);
+        }
+    }
+    return parts;
+}
+
+static std::string read_file(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::invalid_argument("não foi possível ler " + path);
+    }
+    std::ostringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+static void collect_files(const std::string& path, std::vector<std::string>& files) {
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) {
+        throw std::invalid_argument("arquivo inexistente: " + path);
+    }
+    if (!S_ISDIR(info.st_mode)) {
+        files.push_back(path);
+        return;
+    }
+
+    DIR* dir = opendir(path.c_str());
+    if (!dir) {
+        throw std::invalid_argument("não foi possível abrir " + path);
+    }
+    while (dirent* entry = readdir(dir)) {
+        std::string name = entry->d_name;
+        if (name != "." && name != "..") {
+            std::string child = path + (path.back() == '/' ? "" : "/") + name;
+            struct stat child_info;
+            if (stat(child.c_str(), &child_info) == 0 && S_ISREG(child_info.st_mode)) {
+                files.push_back(child);
+            }
+        }
+    }
+    closedir(dir);
+    std::sort(files.begin(), files.end());
+}
+
+void DocumentSet::add_text(const std::string& text) {
+    json body;
+    // Arquivos podem ter bytes que não são UTF-8; o mestre recebe o mesmo
+    // que o cliente enviaria depois de substituí-los
+    body["text"] = text;
+    bodies.push_back(body.dump(-1, ' ', false, json::error_handler_t::replace));
+    text_sizes.push_back(text.size());
+}
+
+DocumentSet::DocumentSet(const std::string& spec, size_t pool_size, uint64_t seed) {
+    auto colon = spec.find(':');
+    std::string kind = spec.substr(0, colon);
+    std::string args = colon == std::string::npos ? "" : spec.substr(colon + 1);
+    std::mt19937_64 engine(seed);
+    pool_size = std::max<size_t>(pool_size, 1);
+
+    if (kind == "fixed") {
+        size_t size = parse_size(args);
+        add_text(make_text(size, TextMix::UTF8));
+        description = "fixo " + size_label(size);
+    } else if (kind == "uniform") {
+        auto dash = args.find('-');
+        if (dash == std::string::npos) {
+            throw std::invalid_argument("uniform espera MIN-MAX: " + args);
+        }
+        size_t low = parse_size(args.substr(0, dash));
+        size_t high = parse_size(args.substr(dash + 1));
+        if (high < low) {
+            std::swap(low, high);
+        }
+        std::uniform_int_distribution<size_t> size(low, high);
+        for (size_t i = 0; i < pool_size; i++) {
+            add_text(make_text(size(engine), TextMix::UTF8));
+        }
+        description = "uniforme " + size_label(low) + "-" + size_label(high);
+    } else if (kind == "lognormal") {
+        auto parts = split(args, ',');
+        if (parts.size() != 2) {
+            throw std::invalid_argument("lognormal espera MEDIANA,SIGMA: " + args);
+        }
+        size_t median = parse_size(parts[0]);
+        double sigma = std::strtod(parts[1].c_str(), nullptr);
+        std::lognormal_distribution<double> size(std::log(static_cast<double>(std::max<size_t>(median, 1))), sigma);
+        for (size_t i = 0; i < pool_size; i++) {
+            add_text(make_text(static_cast<size_t>(std::max(1.0, size(engine))), TextMix::UTF8));
+        }
+        description = "lognormal mediana " + size_label(median) + ", sigma " + parts[1];
+    } else if (kind == "files") {
+        std::vector<std::string> files;
+        for (const std::string& path : split(args, ',')) {
+            collect_files(path, files);
+        }
+        if (files.empty()) {
+            throw std::invalid_argument("nenhum arquivo em " + args);
+        }
+        for (const std::string& file : files) {
+            add_text(read_file(file));
+        }
+        description = std::to_string(files.size()) + " arquivo(s)";
+    } else {
+        throw std::invalid_argument("distribuição desconhecida: " + spec);
+    }
+
+    // Sequência de envio: sorteio com reposição, repetida ciclicamente
+    std::uniform_int_distribution<size_t> pick(0, bodies.size() - 1);
+    order.resize(std::max(ORDER_LENGTH, bodies.size()));
+    for (size_t& index : order) {
+        index = pick(engine);
+    }
+}
+
+const std::string& DocumentSet::body(uint64_t sequence) const {
+    return bodies[order[sequence % order.size()]];
+}
+
+size_t DocumentSet::text_size(uint64_t sequence) const {
+    return text_sizes[order[sequence % order.size()]];
+}
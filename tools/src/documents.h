@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <random>
+#include <string>
+#include <vector>
+
+// Documentos enviados pelo gerador de carga. A especificação escolhe os
+// tamanhos (e, com "files:", o próprio conteúdo):
+//
+//   fixed:64KB                     todos do mesmo tamanho
+//   uniform:1KB-1MB                tamanho uniforme no intervalo
+//   lognormal:64KB,1.5             mediana e desvio (em log) da lognormal
+//   files:a.txt,b.txt,dir/         arquivos reais, escolhidos ao acaso
+//
+// Os corpos {"text": ...} são gerados antes do teste, num conjunto limitado,
+// para que montar a requisição não pese na medição.
+class DocumentSet {
+public:
+    // Lança std::invalid_argument com a especificação inválida
+    DocumentSet(const std::string& spec, size_t pool_size, uint64_t seed);
+
+    // Corpo JSON do n-ésimo envio (determinístico)
+    const std::string& body(uint64_t sequence) const;
+
+    // Tamanho do texto (não do corpo) do n-ésimo envio
+    size_t text_size(uint64_t sequence) const;
+
+    size_t pool_size() const { return bodies.size(); }
+    std::string describe() const { return description; }
+
+    // "64KB", "1.5MB", "512" -> bytes
+    static size_t parse_size(const std::string& text);
+
+private:
+    std::vector<std::string> bodies;
+    std::vector<size_t> text_sizes;
+    std::vector<size_t> order;  // sequência embaralhada de índices do conjunto
+    std::string description;
+
+    void add_text(const std::string& text);
+};
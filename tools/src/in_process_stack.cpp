@@ -0,0 +1,68 @@
+#include "in_process_stack.h"
+#include "master_server.h"
+#include "letters_server.h"
+#include "numbers_server.h"
+#include "logger.h"
+#include <httplib.h>
+#include <chrono>
+#include <thread>
+
+// Tempo máximo para os servidores começarem a responder
+static constexpr std::chrono::seconds STARTUP_TIMEOUT(10);
+
+InProcessStack::InProcessStack(int port) : base_port(port) {}
+
+// Os servidores continuam referenciados pelas threads de listen
+InProcessStack::~InProcessStack() {
+    letters.release();
+    numbers.release();
+    master.release();
+}
+
+static bool wait_healthy(int port) {
+    httplib::Client client("127.0.0.1", port);
+    client.set_connection_timeout(0, 200000);
+
+    auto deadline = std::chrono::steady_clock::now() + STARTUP_TIMEOUT;
+    while (std::chrono::steady_clock::now() < deadline) {
+        auto response = client.Get("/health");
+        if (response && response->status == 200) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    return false;
+}
+
+bool InProcessStack::start() {
+    int letters_port = base_port + 1;
+    int numbers_port = base_port + 2;
+
+    letters.reset(new LettersServer(letters_port));
+    numbers.reset(new NumbersServer(numbers_port));
+    master.reset(new MasterServer(base_port));
+    master->add_slave("slave-letters", "127.0.0.1", letters_port, "/letras", "letters");
+    master->add_slave("slave-numbers", "127.0.0.1", numbers_port, "/numeros", "numbers");
+
+    LettersServer* letters_server = letters.get();
+    NumbersServer* numbers_server = numbers.get();
+    MasterServer* master_server = master.get();
+    std::thread([letters_server]() { letters_server->start(); }).detach();
+    std::thread([numbers_server]() { numbers_server->start(); }).detach();
+
+    if (!wait_healthy(letters_port) || !wait_healthy(numbers_port)) {
+        Logger::error("Escravos do stack local não responderam");
+        return false;
+    }
+
+    std::thread([master_server]() { master_server->start(); }).detach();
+    if (!wait_healthy(base_port)) {
+        Logger::error("Mestre do stack local não respondeu");
+        return false;
+    }
+    return true;
+}
+
+std::string InProcessStack::url() const {
+    return "http://127.0.0.1:" + std::to_string(base_port);
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+class MasterServer;
+class LettersServer;
+class NumbersServer;
+
+// Mestre e os dois escravos no próprio processo, em portas de loopback,
+// para medir o sistema sem Docker nem rede. Os servidores HTTP não têm
+// parada explícita: as threads terminam junto com o processo.
+class InProcessStack {
+public:
+    explicit InProcessStack(int base_port);
+    ~InProcessStack();
+
+    // Inicia os três servidores e espera o /health do mestre responder
+    bool start();
+
+    // URL base do mestre (http://127.0.0.1:porta)
+    std::string url() const;
+
+private:
+    int base_port;
+    std::unique_ptr<LettersServer> letters;
+    std::unique_ptr<NumbersServer> numbers;
+    std::unique_ptr<MasterServer> master;
+};
@@ -0,0 +1,102 @@
+#include "latency_histogram.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+// Índices 0..2*SUB_BUCKETS-1 guardam o valor exato; cada magnitude acima
+// (bit mais alto em m >= SUB_BUCKET_BITS + 1) ocupa SUB_BUCKETS posições
+static constexpr size_t bucket_count(int sub_bits, int max_magnitude) {
+    return (2ull << sub_bits) + static_cast<size_t>(max_magnitude - sub_bits) * (1ull << sub_bits);
+}
+
+LatencyHistogram::LatencyHistogram()
+    : counts(bucket_count(SUB_BUCKET_BITS, MAX_MAGNITUDE), 0) {}
+
+size_t LatencyHistogram::index_for(uint64_t value) {
+    if (value < 2 * SUB_BUCKETS) {
+        return static_cast<size_t>(value);
+    }
+
+    int magnitude = 63 - __builtin_clzll(value);
+    if (magnitude >= MAX_MAGNITUDE) {
+        magnitude = MAX_MAGNITUDE - 1;
+        value = (2 * SUB_BUCKETS - 1) << (magnitude - SUB_BUCKET_BITS);
+    }
+    int shift = magnitude - SUB_BUCKET_BITS;
+    return static_cast<size_t>(2 * SUB_BUCKETS + (magnitude - SUB_BUCKET_BITS - 1) * SUB_BUCKETS +
+                               ((value >> shift) - SUB_BUCKETS));
+}
+
+uint64_t LatencyHistogram::highest_equivalent(size_t index) {
+    if (index < 2 * SUB_BUCKETS) {
+        return index;
+    }
+
+    size_t offset = index - 2 * SUB_BUCKETS;
+    int shift = static_cast<int>(offset / SUB_BUCKETS) + 1;
+    uint64_t sub = SUB_BUCKETS + offset % SUB_BUCKETS;
+    return ((sub + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t microseconds, uint64_t count) {
+    counts[index_for(microseconds)] += count;
+    total += count;
+    sum += static_cast<double>(microseconds) * count;
+    max_value = std::max(max_value, microseconds);
+    min_value = std::min(min_value, microseconds);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (size_t i = 0; i < counts.size(); i++) {
+        counts[i] += other.counts[i];
+    }
+    total += other.total;
+    sum += other.sum;
+    max_value = std::max(max_value, other.max_value);
+    min_value = std::min(min_value, other.min_value);
+}
+
+double LatencyHistogram::mean() const {
+    return total ? sum / total : 0.0;
+}
+
+uint64_t LatencyHistogram::percentile(double percentile) const {
+    if (total == 0) {
+        return 0;
+    }
+
+    uint64_t wanted = static_cast<uint64_t>(std::ceil(total * std::min(percentile, 100.0) / 100.0));
+    wanted = std::max<uint64_t>(wanted, 1);
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); i++) {
+        seen += counts[i];
+        if (seen >= wanted) {
+            return std::min(highest_equivalent(i), max_value);
+        }
+    }
+    return max_value;
+}
+
+std::string LatencyHistogram::format_us(uint64_t microseconds) {
+    char buffer[32];
+    if (microseconds < 1000) {
+        std::snprintf(buffer, sizeof(buffer), "%lluus", static_cast<unsigned long long>(microseconds));
+    } else if (microseconds < 1000000) {
+        std::snprintf(buffer, sizeof(buffer), "%.2fms", microseconds / 1e3);
+    } else {
+        std::snprintf(buffer, sizeof(buffer), "%.2fs", microseconds / 1e6);
+    }
+    return buffer;
+}
+
+std::string LatencyHistogram::summary() const {
+    std::string text;
+    for (double p : {50.0, 90.0, 99.0, 99.9, 99.99}) {
+        char label[16];
+        std::snprintf(label, sizeof(label), "p%g=", p);
+        text += label + format_us(percentile(p)) + " ";
+    }
+    text += "max=" + format_us(max());
+    return text;
+}
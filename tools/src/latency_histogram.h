@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Histograma de latências no estilo HDR: valores em microssegundos, exatos
+// até 255 us e, acima disso, 128 faixas lineares por potência de dois (erro
+// relativo abaixo de 0,8%) até 2^40 us. Não é thread-safe: cada thread
+// registra no seu e os histogramas são somados no fim.
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+
+    void record(uint64_t microseconds, uint64_t count = 1);
+    void merge(const LatencyHistogram& other);
+
+    uint64_t count() const { return total; }
+    uint64_t max() const { return max_value; }
+    uint64_t min() const { return total ? min_value : 0; }
+    double mean() const;
+
+    // Menor valor tal que `percentile`% dos registros são <= a ele
+    uint64_t percentile(double percentile) const;
+
+    // Percentis usuais, ex.: "p50=812us p99=2.1ms ..."
+    std::string summary() const;
+
+    static std::string format_us(uint64_t microseconds);
+
+private:
+    static constexpr int SUB_BUCKET_BITS = 7;
+    static constexpr uint64_t SUB_BUCKETS = 1ull << SUB_BUCKET_BITS;
+    static constexpr int MAX_MAGNITUDE = 40;
+
+    static size_t index_for(uint64_t value);
+    static uint64_t highest_equivalent(size_t index);
+
+    std::vector<uint64_t> counts;
+    uint64_t total = 0;
+    uint64_t max_value = 0;
+    uint64_t min_value = UINT64_MAX;
+    double sum = 0;
+};
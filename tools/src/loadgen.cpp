@@ -0,0 +1,207 @@
+// Gerador de carga em malha aberta para /process.
+//
+// As requisições seguem um horário fixo (taxa constante ou chegadas de
+// Poisson), independente de quando as anteriores terminam; a latência é
+// medida a partir do horário previsto (ver open_loop.h).
+
+#include "documents.h"
+#include "open_loop.h"
+#include "logger.h"
+#ifdef LOADGEN_IN_PROCESS
+#include "in_process_stack.h"
+#endif
+#include <nlohmann/json.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+
+struct Options {
+    std::string url = "http://localhost:8080";
+    double rate = 50;           // requisições por segundo
+    double duration = 30;       // segundos medidos
+    double warmup = 5;          // segundos descartados no início
+    int connections = 16;
+    std::string documents = "lognormal:16KB,1.0";
+    size_t pool = 64;
+    bool poisson = false;
+    bool in_process = false;
+    int in_process_port = 18080;
+    std::string client_id;
+    std::string json_path;
+    uint64_t seed = 1;
+};
+
+static void usage() {
+    std::fprintf(stderr,
+        "Uso: loadgen [opções]\n"
+        "  --url URL             mestre alvo (padrão http://localhost:8080)\n"
+        "  --rate N              requisições por segundo (padrão 50)\n"
+        "  --duration S          segundos medidos (padrão 30)\n"
+        "  --warmup S            segundos de aquecimento descartados (padrão 5)\n"
+        "  --connections N       conexões simultâneas (padrão 16)\n"
+        "  --documents SPEC      fixed:64KB | uniform:1KB-1MB | lognormal:64KB,1.5 |\n"
+        "                        files:a.txt,dir/ (padrão lognormal:16KB,1.0)\n"
+        "  --pool N              documentos sintéticos distintos (padrão 64)\n"
+        "  --poisson             chegadas de Poisson em vez de intervalo fixo\n"
+        "  --in-process [PORTA]  sobe mestre e escravos neste processo (padrão 18080)\n"
+        "  --client-id ID        enviado em X-Client-Id (classe de prioridade)\n"
+        "  --json ARQUIVO        grava o resumo em JSON\n"
+        "  --seed N              semente dos sorteios (padrão 1)\n");
+}
+
+static bool parse_options(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument(arg + " exige um valor");
+            }
+            return argv[++i];
+        };
+
+        if (arg == "--url") {
+            options.url = value();
+        } else if (arg == "--rate") {
+            options.rate = std::stod(value());
+        } else if (arg == "--duration") {
+            options.duration = std::stod(value());
+        } else if (arg == "--warmup") {
+            options.warmup = std::stod(value());
+        } else if (arg == "--connections") {
+            options.connections = std::stoi(value());
+        } else if (arg == "--documents") {
+            options.documents = value();
+        } else if (arg == "--pool") {
+            options.pool = std::stoul(value());
+        } else if (arg == "--poisson") {
+            options.poisson = true;
+        } else if (arg == "--in-process") {
+            options.in_process = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                options.in_process_port = std::stoi(argv[++i]);
+            }
+        } else if (arg == "--client-id") {
+            options.client_id = value();
+        } else if (arg == "--json") {
+            options.json_path = value();
+        } else if (arg == "--seed") {
+            options.seed = std::stoull(value());
+        } else if (arg == "--help" || arg == "-h") {
+            return false;
+        } else {
+            throw std::invalid_argument("opção desconhecida: " + arg);
+        }
+    }
+
+    if (options.rate <= 0 || options.duration <= 0 || options.warmup < 0 || options.connections <= 0) {
+        throw std::invalid_argument("taxa, duração e conexões devem ser positivas");
+    }
+    return true;
+}
+
+// Horários previstos (em segundos desde o início) de todos os envios
+static std::vector<double> build_schedule(const Options& options) {
+    size_t total = static_cast<size_t>(options.rate * (options.warmup + options.duration));
+    std::vector<double> schedule(total);
+
+    if (options.poisson) {
+        std::mt19937_64 engine(options.seed ^ 0x5eed);
+        std::exponential_distribution<double> gap(options.rate);
+        double t = 0;
+        for (double& at : schedule) {
+            t += gap(engine);
+            at = t;
+        }
+    } else {
+        for (size_t i = 0; i < total; i++) {
+            schedule[i] = i / options.rate;
+        }
+    }
+    return schedule;
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    try {
+        if (!parse_options(argc, argv, options)) {
+            usage();
+            return 0;
+        }
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        usage();
+        return 2;
+    }
+
+    Logger::set_component_name("LOADGEN");
+    Logger::set_log_level(LogLevel::WARNING);
+
+#ifdef LOADGEN_IN_PROCESS
+    std::unique_ptr<InProcessStack> stack;
+    if (options.in_process) {
+        stack.reset(new InProcessStack(options.in_process_port));
+        if (!stack->start()) {
+            std::fprintf(stderr, "Falha ao iniciar o stack local\n");
+            return 1;
+        }
+        options.url = stack->url();
+    }
+#else
+    if (options.in_process) {
+        std::fprintf(stderr, "Compilado sem LOADGEN_IN_PROCESS; use --url\n");
+        return 2;
+    }
+#endif
+
+    std::unique_ptr<DocumentSet> documents;
+    try {
+        documents.reset(new DocumentSet(options.documents, options.pool, options.seed));
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "Documentos: %s\n", e.what());
+        return 2;
+    }
+
+    std::printf("Alvo %s: %.1f req/s por %.0f s (+%.0f s de aquecimento), %d conexões, %s%s\n",
+                options.url.c_str(), options.rate, options.duration, options.warmup, options.connections,
+                documents->describe().c_str(), options.poisson ? ", chegadas de Poisson" : "");
+    std::fflush(stdout);
+
+    OpenLoopPlan plan;
+    plan.url = options.url;
+    plan.connections = options.connections;
+    plan.schedule = build_schedule(options);
+    plan.measure_after = options.warmup;
+    plan.client_id = options.client_id;
+    plan.body = [&documents](size_t sequence) -> const std::string& { return documents->body(sequence); };
+    plan.text_size = [&documents](size_t sequence) { return documents->text_size(sequence); };
+
+    OpenLoopResult result = run_open_loop(plan);
+    print_report(result, options.rate);
+
+    if (!options.json_path.empty()) {
+        json summary = result_json(result);
+        summary["target"] = options.url;
+        summary["rate"] = options.rate;
+        summary["duration_s"] = options.duration;
+        summary["warmup_s"] = options.warmup;
+        summary["connections"] = options.connections;
+        summary["documents"] = options.documents;
+        summary["poisson"] = options.poisson;
+
+        std::ofstream file(options.json_path);
+        file << summary.dump(2) << "\n";
+        if (!file) {
+            std::fprintf(stderr, "Não foi possível gravar %s\n", options.json_path.c_str());
+            return 1;
+        }
+    }
+
+    Logger::flush();
+    return result.errors > 0 && result.ok() == 0 ? 1 : 0;
+}
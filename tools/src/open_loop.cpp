@@ -0,0 +1,156 @@
+#include "open_loop.h"
+#include <httplib.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+using json = nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+// Folga para todas as conexões estarem prontas no primeiro envio
+static constexpr std::chrono::milliseconds START_DELAY(100);
+
+static const std::string JSON_TYPE = "application/json";
+
+static uint64_t elapsed_us(Clock::time_point from, Clock::time_point to) {
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(to - from).count();
+    return us > 0 ? static_cast<uint64_t>(us) : 0;
+}
+
+static Clock::time_point at(Clock::time_point start, double seconds) {
+    return start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+}
+
+double OpenLoopResult::throughput_rps() const {
+    return window_s > 0 ? ok() / window_s : 0;
+}
+
+double OpenLoopResult::throughput_mb_s() const {
+    return window_s > 0 ? bytes / window_s / (1024.0 * 1024.0) : 0;
+}
+
+OpenLoopResult run_open_loop(const OpenLoopPlan& plan) {
+    // Resultado de uma conexão, somado às demais no fim
+    struct ConnectionStats {
+        OpenLoopResult result;
+        Clock::time_point last_done;
+    };
+
+    std::atomic<size_t> next{0};
+    std::vector<ConnectionStats> stats(static_cast<size_t>(plan.connections));
+    std::vector<std::thread> workers;
+
+    Clock::time_point start = Clock::now() + START_DELAY;
+    Clock::time_point measure_from = at(start, plan.measure_after);
+
+    for (int c = 0; c < plan.connections; c++) {
+        workers.emplace_back([&, c]() {
+            ConnectionStats& mine = stats[static_cast<size_t>(c)];
+            httplib::Client client(plan.url);
+            client.set_keep_alive(true);
+            client.set_connection_timeout(5, 0);
+            client.set_read_timeout(120, 0);
+            client.set_write_timeout(120, 0);
+
+            httplib::Headers headers;
+            if (!plan.client_id.empty()) {
+                headers.emplace("X-Client-Id", plan.client_id);
+            }
+
+            for (;;) {
+                size_t sequence = next.fetch_add(1, std::memory_order_relaxed);
+                if (sequence >= plan.schedule.size()) {
+                    break;
+                }
+
+                Clock::time_point intended = at(start, plan.schedule[sequence]);
+                std::this_thread::sleep_until(intended);
+
+                const std::string& body = plan.body(sequence);
+                const std::string& content_type = plan.content_type ? plan.content_type(sequence) : JSON_TYPE;
+                httplib::Headers request_headers = headers;
+                if (plan.content_encoding && !plan.content_encoding(sequence).empty()) {
+                    request_headers.emplace("Content-Encoding", plan.content_encoding(sequence));
+                }
+
+                Clock::time_point sent = Clock::now();
+                auto response = client.Post("/process", request_headers, body, content_type);
+                Clock::time_point done = Clock::now();
+
+                if (intended < measure_from) {
+                    continue;
+                }
+
+                mine.last_done = std::max(mine.last_done, done);
+                mine.result.max_lag_us = std::max(mine.result.max_lag_us, elapsed_us(intended, sent));
+                bool ok = response && response->status == 200 &&
+                          response->body.find("\"success\":true") != std::string::npos;
+                if (!ok) {
+                    mine.result.errors++;
+                    continue;
+                }
+                mine.result.bytes += plan.text_size(sequence);
+                mine.result.corrected.record(elapsed_us(intended, done));
+                mine.result.service.record(elapsed_us(sent, done));
+            }
+        });
+    }
+
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    OpenLoopResult total;
+    Clock::time_point last_done = measure_from;
+    for (const ConnectionStats& s : stats) {
+        total.corrected.merge(s.result.corrected);
+        total.service.merge(s.result.service);
+        total.errors += s.result.errors;
+        total.bytes += s.result.bytes;
+        total.max_lag_us = std::max(total.max_lag_us, s.result.max_lag_us);
+        last_done = std::max(last_done, s.last_done);
+    }
+    total.window_s = std::chrono::duration<double>(last_done - measure_from).count();
+    return total;
+}
+
+void print_report(const OpenLoopResult& result, double target_rate) {
+    std::printf("\nRequisições: %llu ok, %llu com erro em %.1f s\n",
+                static_cast<unsigned long long>(result.ok()),
+                static_cast<unsigned long long>(result.errors), result.window_s);
+    std::printf("Vazão: %.1f req/s, %.2f MB/s de texto", result.throughput_rps(), result.throughput_mb_s());
+    if (target_rate > 0) {
+        std::printf(" (alvo %.1f req/s)", target_rate);
+    }
+    std::printf("\nLatência (corrigida, desde o horário previsto): %s\n", result.corrected.summary().c_str());
+    std::printf("Tempo de serviço (desde o envio real):          %s\n", result.service.summary().c_str());
+    std::printf("Maior atraso de envio: %s%s\n", LatencyHistogram::format_us(result.max_lag_us).c_str(),
+                result.max_lag_us > 1000000 ? " (conexões insuficientes ou servidor saturado)" : "");
+}
+
+static json percentiles_json(const LatencyHistogram& histogram) {
+    json result;
+    result["p50"] = histogram.percentile(50);
+    result["p90"] = histogram.percentile(90);
+    result["p99"] = histogram.percentile(99);
+    result["p99.9"] = histogram.percentile(99.9);
+    result["p99.99"] = histogram.percentile(99.99);
+    result["max"] = histogram.max();
+    result["mean"] = histogram.mean();
+    return result;
+}
+
+json result_json(const OpenLoopResult& result) {
+    json summary;
+    summary["requests"] = result.ok();
+    summary["errors"] = result.errors;
+    summary["window_s"] = result.window_s;
+    summary["throughput_rps"] = result.throughput_rps();
+    summary["throughput_mb_s"] = result.throughput_mb_s();
+    summary["max_send_lag_us"] = result.max_lag_us;
+    summary["latency_us"] = percentiles_json(result.corrected);
+    summary["service_time_us"] = percentiles_json(result.service);
+    return summary;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "latency_histogram.h"
+#include <nlohmann/json.hpp>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Execução em malha aberta, compartilhada por loadgen e replay.
+//
+// Cada envio tem um horário previsto; as conexões pegam o próximo horário
+// livre e a latência é medida a partir dele, não do envio real. Se todas as
+// conexões estiverem ocupadas, os envios atrasam e a fila aparece na
+// latência (correção da omissão coordenada).
+struct OpenLoopPlan {
+    std::string url;
+    int connections = 16;
+    std::vector<double> schedule;   // horários previstos, em segundos
+    double measure_after = 0;       // envios previstos antes disso não contam
+    std::string client_id;          // X-Client-Id (opcional)
+
+    // Corpo e tamanho do texto do n-ésimo envio
+    std::function<const std::string&(size_t)> body;
+    std::function<size_t(size_t)> text_size;
+
+    // Content-Type e Content-Encoding do n-ésimo envio. Opcionais: sem eles,
+    // application/json sem codificação
+    std::function<const std::string&(size_t)> content_type;
+    std::function<const std::string&(size_t)> content_encoding;
+};
+
+struct OpenLoopResult {
+    LatencyHistogram corrected;     // desde o horário previsto
+    LatencyHistogram service;       // desde o envio real
+    uint64_t errors = 0;
+    uint64_t bytes = 0;             // texto das requisições bem-sucedidas
+    uint64_t max_lag_us = 0;        // maior atraso de envio
+    double window_s = 0;
+
+    uint64_t ok() const { return corrected.count(); }
+    double throughput_rps() const;
+    double throughput_mb_s() const;
+};
+
+OpenLoopResult run_open_loop(const OpenLoopPlan& plan);
+
+// Relatório legível; target_rate = 0 omite o alvo
+void print_report(const OpenLoopResult& result, double target_rate);
+
+// Vazão e percentis, para gravar e comparar execuções
+nlohmann::json result_json(const OpenLoopResult& result);
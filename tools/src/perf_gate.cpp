@@ -0,0 +1,411 @@
+// Portão de desempenho: compara uma medição atual com a baseline gravada.
+//
+// Roda os microbenchmarks dos núcleos (benchmarks/) várias vezes e, se o
+// loadgen for informado, um teste de carga curto com o stack no próprio
+// processo: um a taxa moderada para a latência p99 e outro saturado para a
+// vazão. Cada métrica vira mediana e MAD (desvio absoluto mediano) das
+// repetições. Uma métrica só é regressão se piorar mais que o limite
+// percentual E mais que 3 desvios robustos, para o ruído da máquina não
+// reprovar o build sozinho.
+
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+using json = nlohmann::json;
+
+// MAD * 1.4826 estima o desvio padrão em dados normais
+static constexpr double MAD_TO_SIGMA = 1.4826;
+static constexpr double NOISE_SIGMAS = 3.0;
+
+struct Options {
+    std::string baseline;
+    std::string benchmarks;
+    std::string loadgen;
+    std::string out;
+    std::string work_dir = "perf_gate_runs";
+    std::string filter = "BM_Count(Letters|Digits)/bytes:(16384|1048576)/";
+    double min_time = 0.2;
+    int repetitions = 5;
+    int e2e_repetitions = 3;
+    int port = 18180;
+    double threshold = 10.0;    // %
+    bool update = false;
+    std::string compare_base;
+    std::string compare_current;
+};
+
+static void usage() {
+    std::fprintf(stderr,
+        "Uso: perf_gate --baseline ARQUIVO --benchmarks BIN [--loadgen BIN] [opções]\n"
+        "     perf_gate --compare BASE.json ATUAL.json [--threshold PCT]\n"
+        "  --baseline ARQUIVO    baseline gravada (JSON)\n"
+        "  --benchmarks BIN      executável de benchmarks/\n"
+        "  --loadgen BIN         executável do loadgen (com --in-process); sem ele,\n"
+        "                        só os núcleos são medidos\n"
+        "  --repetitions N       repetições dos microbenchmarks (padrão 5)\n"
+        "  --e2e-repetitions N   repetições do teste de carga (padrão 3)\n"
+        "  --filter REGEX        microbenchmarks medidos (padrão: contagem, 16 KB e 1 MB)\n"
+        "  --min-time S          tempo mínimo por microbenchmark (padrão 0.2)\n"
+        "  --port N              porta do stack local (padrão 18180)\n"
+        "  --threshold PCT       piora tolerada em %% (padrão 10)\n"
+        "  --work-dir DIR        saídas intermediárias (padrão perf_gate_runs)\n"
+        "  --out ARQUIVO         grava a medição atual\n"
+        "  --update              grava a medição atual como nova baseline\n");
+}
+
+static bool parse_options(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument(arg + " exige um valor");
+            }
+            return argv[++i];
+        };
+
+        if (arg == "--baseline") {
+            options.baseline = value();
+        } else if (arg == "--benchmarks") {
+            options.benchmarks = value();
+        } else if (arg == "--loadgen") {
+            options.loadgen = value();
+        } else if (arg == "--repetitions") {
+            options.repetitions = std::stoi(value());
+        } else if (arg == "--e2e-repetitions") {
+            options.e2e_repetitions = std::stoi(value());
+        } else if (arg == "--filter") {
+            options.filter = value();
+        } else if (arg == "--min-time") {
+            options.min_time = std::stod(value());
+        } else if (arg == "--port") {
+            options.port = std::stoi(value());
+        } else if (arg == "--threshold") {
+            options.threshold = std::stod(value());
+        } else if (arg == "--work-dir") {
+            options.work_dir = value();
+        } else if (arg == "--out") {
+            options.out = value();
+        } else if (arg == "--update") {
+            options.update = true;
+        } else if (arg == "--compare") {
+            options.compare_base = value();
+            options.compare_current = value();
+        } else if (arg == "--help" || arg == "-h") {
+            return false;
+        } else {
+            throw std::invalid_argument("opção desconhecida: " + arg);
+        }
+    }
+
+    if (options.compare_base.empty() && (options.baseline.empty() || options.benchmarks.empty())) {
+        throw std::invalid_argument("informe --baseline e --benchmarks (ou --compare)");
+    }
+    if (options.repetitions < 1 || options.e2e_repetitions < 1 || options.threshold < 0) {
+        throw std::invalid_argument("repetições devem ser positivas e o limite, não negativo");
+    }
+    return true;
+}
+
+// Amostras de uma métrica ao longo das repetições
+struct Metric {
+    std::vector<double> samples;
+    bool higher_is_better = true;
+    std::string unit;
+};
+
+static double median(std::vector<double> values) {
+    if (values.empty()) {
+        return 0;
+    }
+    size_t middle = values.size() / 2;
+    std::nth_element(values.begin(), values.begin() + middle, values.end());
+    double upper = values[middle];
+    if (values.size() % 2 == 1) {
+        return upper;
+    }
+    double lower = *std::max_element(values.begin(), values.begin() + middle);
+    return (lower + upper) / 2;
+}
+
+static double mad(const std::vector<double>& values) {
+    double center = median(values);
+    std::vector<double> deviations;
+    deviations.reserve(values.size());
+    for (double value : values) {
+        deviations.push_back(std::fabs(value - center));
+    }
+    return median(deviations);
+}
+
+static std::string shell_quote(const std::string& value) {
+    std::string quoted = "'";
+    for (char c : value) {
+        if (c == '\'') {
+            quoted += "'\\''";
+        } else {
+            quoted += c;
+        }
+    }
+    return quoted + "'";
+}
+
+static void run(const std::string& command, const std::string& log) {
+    std::string full = command + " >" + shell_quote(log) + " 2>&1";
+    int status = std::system(full.c_str());
+    if (status != 0) {
+        throw std::runtime_error("falhou (" + std::to_string(status) + "): " + command + "\n  saída em " + log);
+    }
+}
+
+static json load_json(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("não foi possível ler " + path);
+    }
+    return json::parse(file);
+}
+
+// Microbenchmarks com --benchmark_repetitions; cada repetição vem como uma
+// entrada "iteration" no JSON do Google Benchmark
+static void measure_kernels(const Options& options, std::map<std::string, Metric>& metrics) {
+    std::string out = options.work_dir + "/kernels.json";
+    std::string command = shell_quote(options.benchmarks) +
+        " --benchmark_filter=" + shell_quote(options.filter) +
+        " --benchmark_min_time=" + std::to_string(options.min_time) +
+        " --benchmark_repetitions=" + std::to_string(options.repetitions) +
+        " --benchmark_out_format=json --benchmark_out=" + shell_quote(out);
+
+    std::fprintf(stderr, "Microbenchmarks (%d repetições)...\n", options.repetitions);
+    run(command, options.work_dir + "/kernels.log");
+
+    json report = load_json(out);
+    for (const json& entry : report.at("benchmarks")) {
+        if (entry.value("run_type", "iteration") != "iteration") {
+            continue;
+        }
+        std::string name = "kernel/" + entry.value("run_name", entry.value("name", ""));
+        if (entry.contains("bytes_per_second")) {
+            Metric& metric = metrics[name + " MB/s"];
+            metric.samples.push_back(entry["bytes_per_second"].get<double>() / (1024.0 * 1024.0));
+            metric.higher_is_better = true;
+            metric.unit = "MB/s";
+        } else {
+            Metric& metric = metrics[name + " tempo"];
+            metric.samples.push_back(entry.value("real_time", 0.0));
+            metric.higher_is_better = false;
+            metric.unit = entry.value("time_unit", "ns");
+        }
+    }
+}
+
+// Teste de carga curto: latência a taxa moderada e vazão saturada
+static void measure_end_to_end(const Options& options, std::map<std::string, Metric>& metrics) {
+    struct Scenario {
+        const char* name;
+        const char* arguments;
+    };
+    const Scenario scenarios[] = {
+        {"latencia", "--rate 100 --duration 8 --warmup 2 --connections 16 --documents fixed:16KB"},
+        {"saturacao", "--rate 1000 --duration 3 --warmup 1 --connections 4 --documents fixed:256KB"},
+    };
+
+    for (int r = 0; r < options.e2e_repetitions; r++) {
+        for (const Scenario& scenario : scenarios) {
+            std::fprintf(stderr, "Teste de carga %s (%d/%d)...\n", scenario.name, r + 1, options.e2e_repetitions);
+
+            std::string out = options.work_dir + "/e2e_" + scenario.name + "_" + std::to_string(r) + ".json";
+            std::string command = shell_quote(options.loadgen) + " --in-process " + std::to_string(options.port) +
+                                  " " + scenario.arguments + " --json " + shell_quote(out);
+            run(command, options.work_dir + "/e2e_" + scenario.name + "_" + std::to_string(r) + ".log");
+
+            json summary = load_json(out);
+            std::string prefix = std::string("e2e/") + scenario.name;
+            if (std::string(scenario.name) == "latencia") {
+                Metric& p99 = metrics[prefix + " p99"];
+                p99.samples.push_back(summary["latency_us"].value("p99", 0.0) / 1000.0);
+                p99.higher_is_better = false;
+                p99.unit = "ms";
+            } else {
+                Metric& rps = metrics[prefix + " req/s"];
+                rps.samples.push_back(summary.value("throughput_rps", 0.0));
+                rps.higher_is_better = true;
+                rps.unit = "req/s";
+
+                Metric& mb = metrics[prefix + " MB/s"];
+                mb.samples.push_back(summary.value("throughput_mb_s", 0.0));
+                mb.higher_is_better = true;
+                mb.unit = "MB/s";
+            }
+        }
+    }
+}
+
+static std::string cpu_model() {
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        if (line.compare(0, 10, "model name") == 0) {
+            size_t colon = line.find(':');
+            return colon == std::string::npos ? line : line.substr(colon + 2);
+        }
+    }
+    return "desconhecida";
+}
+
+static json summarize(const std::map<std::string, Metric>& metrics) {
+    json summary;
+    char date[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%d", std::localtime(&now));
+    summary["date"] = date;
+    summary["cpu"] = cpu_model();
+
+    for (const auto& entry : metrics) {
+        const Metric& metric = entry.second;
+        json m;
+        m["median"] = median(metric.samples);
+        m["mad"] = mad(metric.samples);
+        m["samples"] = metric.samples;
+        m["higher_is_better"] = metric.higher_is_better;
+        m["unit"] = metric.unit;
+        summary["metrics"][entry.first] = m;
+    }
+    return summary;
+}
+
+static void save_json(const json& value, const std::string& path) {
+    std::ofstream file(path);
+    file << value.dump(2) << "\n";
+    if (!file) {
+        throw std::runtime_error("não foi possível gravar " + path);
+    }
+}
+
+// Tabela com as métricas da baseline; devolve o número de regressões. Uma
+// métrica medida que não está na baseline também reprova: sem isso, o teste
+// de carga passaria sem comparação nenhuma até alguém regravar a baseline
+static int compare(const json& baseline, const json& current, double threshold) {
+    const json empty = json::object();
+    const json& before = baseline.contains("metrics") ? baseline["metrics"] : empty;
+    const json& after = current.contains("metrics") ? current["metrics"] : empty;
+
+    std::printf("Baseline: %s, %s\n", baseline.value("date", "?").c_str(), baseline.value("cpu", "?").c_str());
+    std::printf("Atual:    %s, %s\n", current.value("date", "?").c_str(), current.value("cpu", "?").c_str());
+    std::printf("Limite: piora acima de %.1f%% e de %.0f desvios robustos\n\n", threshold, NOISE_SIGMAS);
+    std::printf("%-54s %12s %12s %9s %9s  %s\n", "métrica", "baseline", "atual", "variação", "ruído", "");
+
+    int regressions = 0;
+    for (auto it = before.begin(); it != before.end(); ++it) {
+        const json& b = it.value();
+        std::string unit = b.value("unit", "");
+        double base_median = b.value("median", 0.0);
+
+        if (!after.contains(it.key())) {
+            std::printf("%-54s %12.2f %12s %9s %9s  ausente\n", it.key().c_str(), base_median, "-", "-", "-");
+            continue;
+        }
+        const json& a = after[it.key()];
+        double current_median = a.value("median", 0.0);
+        bool higher_is_better = b.value("higher_is_better", true);
+
+        // Variação no sentido "positivo = pior"
+        double worse = higher_is_better ? base_median - current_median : current_median - base_median;
+        double worse_pct = base_median != 0 ? worse / base_median * 100.0 : 0.0;
+        double sigma = MAD_TO_SIGMA * std::hypot(b.value("mad", 0.0), a.value("mad", 0.0));
+        double noise_pct = base_median != 0 ? NOISE_SIGMAS * sigma / base_median * 100.0 : 0.0;
+
+        const char* verdict = "ok";
+        if (worse_pct > threshold && worse_pct > noise_pct) {
+            verdict = "REGRESSÃO";
+            regressions++;
+        } else if (worse_pct > threshold) {
+            verdict = "ruidoso";
+        } else if (-worse_pct > threshold && -worse_pct > noise_pct) {
+            verdict = "melhora";
+        }
+
+        double change_pct = base_median != 0 ? (current_median - base_median) / base_median * 100.0 : 0.0;
+        std::printf("%-54s %12.2f %12.2f %+8.1f%% %8.1f%%  %s %s\n", it.key().c_str(), base_median,
+                    current_median, change_pct, noise_pct, unit.c_str(), verdict);
+    }
+
+    int missing = 0;
+    for (auto it = after.begin(); it != after.end(); ++it) {
+        if (!before.contains(it.key())) {
+            std::printf("%-54s %12s %12.2f %9s %9s  SEM BASELINE\n", it.key().c_str(), "-",
+                        it.value().value("median", 0.0), "-", "-");
+            missing++;
+        }
+    }
+
+    if (missing > 0) {
+        std::printf("\n%d métrica(s) medida(s) sem baseline; regrave com --update (alvo perf_baseline)\n",
+                    missing);
+    }
+    if (regressions > 0) {
+        std::printf("\n%d regressão(ões) acima do limite\n", regressions);
+    } else if (missing == 0) {
+        std::printf("\nSem regressões\n");
+    }
+    return regressions + missing;
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    try {
+        if (!parse_options(argc, argv, options)) {
+            usage();
+            return 0;
+        }
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        usage();
+        return 2;
+    }
+
+    try {
+        if (!options.compare_base.empty()) {
+            int regressions = compare(load_json(options.compare_base), load_json(options.compare_current),
+                                      options.threshold);
+            return regressions > 0 ? 1 : 0;
+        }
+
+        mkdir(options.work_dir.c_str(), 0755);
+
+        std::map<std::string, Metric> metrics;
+        measure_kernels(options, metrics);
+        if (!options.loadgen.empty()) {
+            measure_end_to_end(options, metrics);
+        }
+        json current = summarize(metrics);
+
+        if (!options.out.empty()) {
+            save_json(current, options.out);
+        }
+
+        if (options.update) {
+            save_json(current, options.baseline);
+            std::printf("Baseline atualizada em %s (%zu métricas)\n", options.baseline.c_str(), metrics.size());
+            return 0;
+        }
+
+        std::printf("\n");
+        int regressions = compare(load_json(options.baseline), current, options.threshold);
+        return regressions > 0 ? 1 : 0;
+
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 2;
+    }
+}
@@ -0,0 +1,387 @@
+// Reprodução de tráfego capturado pelo mestre (CAPTURE_FILE).
+//
+// Reenvia as requisições nos mesmos intervalos da captura (ou acelerados
+// com --speed), em malha aberta, e mede a latência como o loadgen. Corpos
+// amostrados vão com o Content-Type e o Content-Encoding originais; os que
+// não foram amostrados são substituídos por texto sintético do mesmo tamanho
+// (texto puro se o original era text/plain, senão JSON), sem codificação,
+// já que o tamanho descomprimido não é conhecido. --compare mostra lado a lado dois resumos gravados com
+// --json (ex.: o build atual contra o anterior).
+
+#include "documents.h"
+#include "inputs.h"
+#include "open_loop.h"
+#include "logger.h"
+#include "traffic_capture.h"
+#ifdef LOADGEN_IN_PROCESS
+#include "in_process_stack.h"
+#endif
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+
+// Tamanho do envelope {"text":""} em volta do texto sintético
+static constexpr size_t BODY_OVERHEAD = 11;
+
+static const std::string JSON_TYPE = "application/json";
+static const std::string PLAIN_TYPE = "text/plain; charset=utf-8";
+
+struct Options {
+    std::string capture_path;
+    std::string url = "http://localhost:8080";
+    double speed = 1.0;
+    double skip = 0;            // segundos iniciais da captura descartados
+    int connections = 32;
+    bool in_process = false;
+    int in_process_port = 18080;
+    std::string json_path;
+    bool info = false;
+    std::string compare_base;
+    std::string compare_current;
+};
+
+static void usage() {
+    std::fprintf(stderr,
+        "Uso: replay CAPTURA [opções]\n"
+        "     replay --info CAPTURA\n"
+        "     replay --compare BASE.json ATUAL.json\n"
+        "  --url URL             mestre alvo (padrão http://localhost:8080)\n"
+        "  --speed X             fator de aceleração (padrão 1 = tempo original)\n"
+        "  --skip S              descarta os S primeiros segundos da captura\n"
+        "  --connections N       conexões simultâneas (padrão 32)\n"
+        "  --in-process [PORTA]  sobe mestre e escravos neste processo (padrão 18080)\n"
+        "  --json ARQUIVO        grava o resumo em JSON\n");
+}
+
+static bool parse_options(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument(arg + " exige um valor");
+            }
+            return argv[++i];
+        };
+
+        if (arg == "--url") {
+            options.url = value();
+        } else if (arg == "--speed") {
+            options.speed = std::stod(value());
+        } else if (arg == "--skip") {
+            options.skip = std::stod(value());
+        } else if (arg == "--connections") {
+            options.connections = std::stoi(value());
+        } else if (arg == "--in-process") {
+            options.in_process = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                options.in_process_port = std::stoi(argv[++i]);
+            }
+        } else if (arg == "--json") {
+            options.json_path = value();
+        } else if (arg == "--info") {
+            options.info = true;
+        } else if (arg == "--compare") {
+            options.compare_base = value();
+            options.compare_current = value();
+        } else if (arg == "--help" || arg == "-h") {
+            return false;
+        } else if (!arg.empty() && arg[0] != '-' && options.capture_path.empty()) {
+            options.capture_path = arg;
+        } else {
+            throw std::invalid_argument("opção desconhecida: " + arg);
+        }
+    }
+
+    if (options.compare_base.empty() && options.capture_path.empty()) {
+        throw std::invalid_argument("informe o arquivo de captura");
+    }
+    if (options.speed <= 0 || options.connections <= 0) {
+        throw std::invalid_argument("--speed e --connections devem ser positivos");
+    }
+    return true;
+}
+
+// Requisições da captura prontas para envio
+class CapturedTraffic {
+public:
+    explicit CapturedTraffic(const std::string& path) {
+        capture::Reader reader(path);
+        capture::Record record;
+        while (reader.next(record)) {
+            Entry entry;
+            entry.arrival_us = record.header.arrival_us;
+            entry.body_size = record.header.body_size;
+            entry.latency_us = record.header.latency_us;
+            entry.status = record.header.status;
+            entry.plain_text = record.content_type.compare(0, 10, "text/plain") == 0;
+            if (!record.body.empty()) {
+                entry.body = bodies.size();
+                bodies.push_back(std::move(record.body));
+                entry.content_type = intern(record.content_type.empty() ? JSON_TYPE : record.content_type);
+                entry.content_encoding = intern(record.content_encoding);
+                sampled++;
+            } else {
+                entry.content_type = intern(entry.plain_text ? PLAIN_TYPE : JSON_TYPE);
+                entry.content_encoding = intern("");
+            }
+            entries.push_back(entry);
+        }
+
+        std::sort(entries.begin(), entries.end(),
+                  [](const Entry& a, const Entry& b) { return a.arrival_us < b.arrival_us; });
+    }
+
+    size_t size() const { return entries.size(); }
+    size_t sampled_bodies() const { return sampled; }
+    uint64_t arrival_us(size_t i) const { return entries[i].arrival_us; }
+    uint64_t body_size(size_t i) const { return entries[i].body_size; }
+
+    // Latências e status registrados pelo mestre na captura
+    LatencyHistogram captured_latency() const {
+        LatencyHistogram histogram;
+        for (const Entry& entry : entries) {
+            if (entry.status == 200) {
+                histogram.record(entry.latency_us);
+            }
+        }
+        return histogram;
+    }
+
+    // Gera antes do envio os corpos sintéticos que faltam
+    void prepare() {
+        for (Entry& entry : entries) {
+            if (entry.body == NO_BODY) {
+                size_t size = synthetic_size(entry.body_size);
+                auto it = synthetic.find({size, entry.plain_text});
+                if (it == synthetic.end()) {
+                    it = synthetic.emplace(std::make_pair(size, entry.plain_text), bodies.size()).first;
+                    if (entry.plain_text) {
+                        bodies.push_back(make_text(size, TextMix::UTF8));
+                    } else {
+                        json body;
+                        body["text"] = make_text(size > BODY_OVERHEAD ? size - BODY_OVERHEAD : 0, TextMix::UTF8);
+                        bodies.push_back(body.dump());
+                    }
+                }
+                entry.body = it->second;
+            }
+        }
+    }
+
+    const std::string& body(size_t i) const { return bodies[entries[i].body]; }
+    const std::string& content_type(size_t i) const { return headers[entries[i].content_type]; }
+    const std::string& content_encoding(size_t i) const { return headers[entries[i].content_encoding]; }
+
+private:
+    static constexpr size_t NO_BODY = static_cast<size_t>(-1);
+
+    struct Entry {
+        uint64_t arrival_us = 0;
+        uint64_t body_size = 0;
+        uint32_t latency_us = 0;
+        uint16_t status = 0;
+        bool plain_text = false;
+        size_t body = NO_BODY;
+        size_t content_type = 0;
+        size_t content_encoding = 0;
+    };
+
+    // Poucos valores distintos de cabeçalho: cada um é guardado uma vez
+    size_t intern(const std::string& value) {
+        auto it = header_index.find(value);
+        if (it == header_index.end()) {
+            it = header_index.emplace(value, headers.size()).first;
+            headers.push_back(value);
+        }
+        return it->second;
+    }
+
+    // Tamanhos arredondados para cima em 64 faixas por potência de dois
+    // (erro abaixo de 1,6%), limitando quantos corpos sintéticos existem
+    static size_t synthetic_size(uint64_t size) {
+        if (size < 128) {
+            return static_cast<size_t>(size);
+        }
+        int magnitude = 63 - __builtin_clzll(size);
+        int shift = magnitude - 6;
+        uint64_t step = 1ull << shift;
+        return static_cast<size_t>((size + step - 1) / step * step);
+    }
+
+    std::vector<Entry> entries;
+    std::vector<std::string> bodies;
+    std::map<std::pair<size_t, bool>, size_t> synthetic;
+    std::vector<std::string> headers;
+    std::map<std::string, size_t> header_index;
+    size_t sampled = 0;
+};
+
+static void print_info(const std::string& path, const CapturedTraffic& traffic) {
+    if (traffic.size() == 0) {
+        std::printf("%s: captura vazia\n", path.c_str());
+        return;
+    }
+
+    double duration = traffic.arrival_us(traffic.size() - 1) / 1e6;
+    LatencyHistogram sizes;
+    uint64_t total_bytes = 0;
+    for (size_t i = 0; i < traffic.size(); i++) {
+        sizes.record(traffic.body_size(i));
+        total_bytes += traffic.body_size(i);
+    }
+
+    // Rajadas: maior número de chegadas num mesmo segundo contra a média
+    std::map<uint64_t, size_t> per_second;
+    for (size_t i = 0; i < traffic.size(); i++) {
+        per_second[traffic.arrival_us(i) / 1000000]++;
+    }
+    size_t peak = 0;
+    for (const auto& second : per_second) {
+        peak = std::max(peak, second.second);
+    }
+
+    std::printf("%s: %zu requisições em %.1f s (%.1f req/s, pico %zu req/s), %zu com corpo\n",
+                path.c_str(), traffic.size(), duration, duration > 0 ? traffic.size() / duration : 0.0,
+                peak, traffic.sampled_bodies());
+    std::printf("Corpos: %.2f MB no total; p50=%s p90=%s p99=%s máx=%s\n",
+                total_bytes / (1024.0 * 1024.0), size_label(sizes.percentile(50)).c_str(),
+                size_label(sizes.percentile(90)).c_str(), size_label(sizes.percentile(99)).c_str(),
+                size_label(sizes.max()).c_str());
+    std::printf("Latência no mestre durante a captura: %s\n", traffic.captured_latency().summary().c_str());
+}
+
+static json load_json(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("não foi possível ler " + path);
+    }
+    return json::parse(file);
+}
+
+static int compare(const std::string& base_path, const std::string& current_path) {
+    json base = load_json(base_path);
+    json current = load_json(current_path);
+
+    auto row = [](const char* name, double before, double after, const char* unit) {
+        double delta = before != 0 ? (after - before) / before * 100.0 : 0.0;
+        std::printf("%-22s %14.1f %14.1f %+9.1f%%  %s\n", name, before, after, delta, unit);
+    };
+
+    std::printf("%-22s %14s %14s %10s\n", "", "base", "atual", "variação");
+    row("vazão", base.value("throughput_rps", 0.0), current.value("throughput_rps", 0.0), "req/s");
+    row("vazão de texto", base.value("throughput_mb_s", 0.0), current.value("throughput_mb_s", 0.0), "MB/s");
+    row("erros", base.value("errors", 0.0), current.value("errors", 0.0), "");
+
+    for (const char* key : {"p50", "p90", "p99", "p99.9", "p99.99", "max"}) {
+        std::string label = std::string("latência ") + key;
+        row(label.c_str(), base["latency_us"].value(key, 0.0) / 1000.0,
+            current["latency_us"].value(key, 0.0) / 1000.0, "ms");
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    try {
+        if (!parse_options(argc, argv, options)) {
+            usage();
+            return 0;
+        }
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        usage();
+        return 2;
+    }
+
+    Logger::set_component_name("REPLAY");
+    Logger::set_log_level(LogLevel::WARNING);
+
+    try {
+        if (!options.compare_base.empty()) {
+            return compare(options.compare_base, options.compare_current);
+        }
+
+        CapturedTraffic traffic(options.capture_path);
+        if (options.info) {
+            print_info(options.capture_path, traffic);
+            return 0;
+        }
+        if (traffic.size() == 0) {
+            std::fprintf(stderr, "Captura vazia\n");
+            return 1;
+        }
+
+#ifdef LOADGEN_IN_PROCESS
+        std::unique_ptr<InProcessStack> stack;
+        if (options.in_process) {
+            stack.reset(new InProcessStack(options.in_process_port));
+            if (!stack->start()) {
+                std::fprintf(stderr, "Falha ao iniciar o stack local\n");
+                return 1;
+            }
+            options.url = stack->url();
+        }
+#else
+        if (options.in_process) {
+            std::fprintf(stderr, "Compilado sem LOADGEN_IN_PROCESS; use --url\n");
+            return 2;
+        }
+#endif
+
+        traffic.prepare();
+
+        OpenLoopPlan plan;
+        plan.url = options.url;
+        plan.connections = options.connections;
+        plan.measure_after = options.skip / options.speed;
+        plan.schedule.reserve(traffic.size());
+        for (size_t i = 0; i < traffic.size(); i++) {
+            plan.schedule.push_back(traffic.arrival_us(i) / 1e6 / options.speed);
+        }
+        plan.body = [&traffic](size_t i) -> const std::string& { return traffic.body(i); };
+        plan.text_size = [&traffic](size_t i) { return static_cast<size_t>(traffic.body_size(i)); };
+        plan.content_type = [&traffic](size_t i) -> const std::string& { return traffic.content_type(i); };
+        plan.content_encoding = [&traffic](size_t i) -> const std::string& { return traffic.content_encoding(i); };
+
+        double duration = plan.schedule.back();
+        std::printf("Reproduzindo %zu requisições (%zu com corpo original) contra %s em %.1f s (%.2fx)\n",
+                    traffic.size(), traffic.sampled_bodies(), options.url.c_str(), duration, options.speed);
+        std::fflush(stdout);
+
+        OpenLoopResult result = run_open_loop(plan);
+        print_report(result, duration > 0 ? traffic.size() / duration : 0);
+
+        LatencyHistogram captured = traffic.captured_latency();
+        std::printf("Latência no mestre durante a captura:          %s\n", captured.summary().c_str());
+
+        if (!options.json_path.empty()) {
+            json summary = result_json(result);
+            summary["target"] = options.url;
+            summary["capture"] = options.capture_path;
+            summary["speed"] = options.speed;
+            summary["connections"] = options.connections;
+
+            std::ofstream file(options.json_path);
+            file << summary.dump(2) << "\n";
+            if (!file) {
+                std::fprintf(stderr, "Não foi possível gravar %s\n", options.json_path.c_str());
+                return 1;
+            }
+        }
+
+        Logger::flush();
+        return result.errors > 0 && result.ok() == 0 ? 1 : 0;
+
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+}